@@ -0,0 +1,104 @@
+#ifndef BARRETT_H
+#define BARRETT_H
+
+#include <assert.h>
+#include <stdint.h>
+#include "mul_mod.h"
+
+// Barrett's reduction modulo any n > 1 (even too), it has the same interface as MulModContext.
+// Modulus is normalized, d = n * 2^shift has the top bit of k bits set, 2^k == R == 2 * NUM_TYPE_MAX_MASK,
+// its reciprocal v = (2^(2k) - 1) / d - 2^k is precalculated once per modulus.
+// Form of residue a is a * 2^shift, so product of forms A * (B >> shift) is reduced modulo d
+// by 2-by-1 division with reciprocal (Moller and Granlund, 2011) straight to form of product:
+// one product of two values < R, one low half product and no division.
+// OPERATION_TYPE must hold product of two values < R, so num_type uint128_t is not supported.
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class BarrettContext {
+public:
+	typedef NUM_TYPE num_type;
+	typedef OPERATION_TYPE operation_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+
+	// bits of R
+	static constexpr uint_fast8_t R_BITS = UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(NUM_TYPE_MAX_MASK);
+	static_assert(sizeof(operation_type) * 8 >= 2 * R_BITS, "OPERATION_TYPE doesn't hold product of two values < R");
+	static constexpr operation_type R_MASK = (((operation_type)1) << R_BITS) - 1;
+	// 2^(2k) - 1
+	static constexpr operation_type R2_MASK = (R_MASK << R_BITS) | R_MASK;
+
+private:
+	num_type mod;
+	// mod << shift, the top bit of k bits is set
+	num_type norm_mod;
+	// (2^(2k) - 1) / norm_mod - 2^k
+	num_type inv;
+	uint_fast8_t shift;
+
+public:
+	constexpr BarrettContext() : mod(0), norm_mod(0), inv(0), shift(0) {}
+
+	constexpr explicit BarrettContext(num_type b_mod) : mod(0), norm_mod(0), inv(0), shift(0) {
+		assign(b_mod);
+	}
+
+	// use default copy constructor and assignment operator
+
+	// b_mod > 1
+	constexpr void assign(num_type b_mod) {
+		assert(b_mod > 1);
+		mod = b_mod;
+		shift = UnsignedOps<num_type>::clz(mod) - (UnsignedOps<num_type>::BITS - R_BITS);
+		norm_mod = mod << shift;
+		inv = (num_type)(R2_MASK / norm_mod - R_MASK - 1);
+	}
+
+	constexpr num_type get_modulus() const {
+		return mod;
+	}
+
+	// u mod norm_mod, u < norm_mod * R
+	constexpr num_type reduce(operation_type u) const {
+		const num_type u1 = (num_type)(u >> R_BITS), u0 = (num_type)(u & R_MASK);
+		// quotient estimate q1 is at most 2 less than the true one
+		const operation_type q = ((operation_type)inv * u1 + ((((operation_type)u1 + 1) << R_BITS) | u0)) & R2_MASK;
+		const num_type q1 = (num_type)(q >> R_BITS), q0 = (num_type)(q & R_MASK);
+		num_type r = (u0 - q1 * norm_mod) & (num_type)R_MASK;
+		// the first adjustment is unpredictable, so it is done by mask
+		r = (r + (norm_mod & ((num_type)0 - (num_type)(r > q0)))) & (num_type)R_MASK;
+		return (r >= norm_mod ? r - norm_mod : r);
+	}
+
+	// a < R
+	constexpr num_type to_form(num_type a) const {
+		return (a < mod ? a : a % mod) << shift;
+	}
+
+	constexpr num_type from_form(num_type a) const {
+		return a >> shift;
+	}
+
+	// form of 1
+	constexpr num_type one() const {
+		return (num_type)1 << shift;
+	}
+
+	constexpr num_type mul(num_type a, num_type b) const {
+		return reduce((operation_type)a * (b >> shift));
+	}
+
+	constexpr num_type square(num_type a) const {
+		return reduce((operation_type)a * (a >> shift));
+	}
+
+	// see WindowPow
+	constexpr num_type pow(num_type a, num_type exp) const {
+		return WindowPow<BarrettContext>::pow(*this, a, exp);
+	}
+
+	// a^exp of ordinary residue, a < R
+	constexpr num_type pow_mod(num_type a, num_type exp) const {
+		return from_form(pow(to_form(a), exp));
+	}
+};
+
+#endif/*BARRETT_H*/
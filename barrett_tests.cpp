@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include "barrett.h"
+#include "mul_mod.h"
+#include "mul_group_mod.h"
+#include "uint128.h"
+
+typedef BarrettContext<uint32_t, ((uint32_t)1)<<31, uint64_t> barrett32_type;
+typedef BarrettContext<uint64_t, ((uint64_t)1)<<63, uint128_t> barrett64_type;
+
+// the same results as of MulMod for any moduli < R, even ones too
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+void check_context() {
+	typedef NUM_TYPE num_type;
+	typedef BarrettContext<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> context_type;
+	typedef typename context_type::mul_mod_type mul_mod_type;
+	const num_type mask = NUM_TYPE_MAX_MASK | (NUM_TYPE_MAX_MASK - 1);
+	std::mt19937_64 rng(1);
+	for (uint_fast16_t i=0; i<1024; ++i) {
+		// small moduli, moduli near R and powers of 2
+		num_type n = (i < 32 ? (num_type)(i + 2) : (i < 64 ? mask - (i - 32) : (num_type)rng() & mask));
+		if (i >= 64 && i < 64 + context_type::R_BITS - 1) n = (num_type)1 << (i - 63);
+		if (n < 2) n = 2;
+		const context_type context(n);
+		assert(context.get_modulus() == n);
+		assert(context.from_form(context.one()) == 1);
+		for (uint_fast16_t j=0; j<64; ++j) {
+			const num_type a = (num_type)rng() % n, b = (num_type)rng() % n, e = (num_type)rng() & mask;
+			const num_type x = context.to_form(a), y = context.to_form(b);
+			assert(context.from_form(x) == a);
+			// forms are shifted residues
+			assert(x < n * context.one() && x % context.one() == 0);
+			assert(context.from_form(context.mul(x, y)) == mul_mod_type::mul_mod(n, a, b));
+			assert(context.from_form(context.square(x)) == mul_mod_type::square_mod(n, a));
+			assert(context.from_form(context.pow(x, e)) == context.pow_mod(a, e));
+			assert(context.pow_mod(a, e) == mul_mod_type::pow_mod(n, a, e));
+			const num_type c = (num_type)rng() & mask;
+			assert(context.from_form(context.to_form(c)) == c % n);
+		}
+		// product of the largest residues
+		assert(context.from_form(context.square(context.to_form(n - 1))) == 1);
+		assert(context.pow_mod(0, 0) == 1);
+	}
+}
+
+uint_fast32_t gcd(uint_fast32_t a, uint_fast32_t b) {
+	if (a == 0) return b;
+	return gcd(b % a, a);
+}
+
+// element orders of MulGroupMod by every modulus < 2^12, even and composite ones too
+void test_mul_group_mod() {
+	typedef uint_fast32_t num_type;
+	typedef MulGroupMod<num_type, 9, ((num_type)1)<<31, uint_fast64_t> mgm_type;
+	typedef MulGroupMod<
+		num_type, 9, ((num_type)1)<<31, uint_fast64_t, Factorizer<num_type>,
+		BarrettContext<num_type, ((num_type)1)<<31, uint_fast64_t>
+	> mgm_barrett_type;
+	typedef mgm_type::canonic_factorizer_type cfzr_type;
+	typedef cfzr_type::primes_array_type primes_array_type;
+	num_type primes[1024];
+	const size_t primes_count = primes_array_type::fill_primes(primes, 1024, UINT16_MAX);
+	cfzr_type cfzr(primes_array_type(primes, primes_count));
+	mgm_type mul_group_mod(cfzr);
+	mgm_barrett_type mul_group_mod_barrett(cfzr);
+	for (num_type n=2; n<(1 << 12); ++n) {
+		mul_group_mod.assign(n);
+		mul_group_mod_barrett.assign(n);
+		// is_primitive_root needs prime modulo > 2
+		const bool is_prime = n > 2 && std::binary_search(primes, primes + primes_count, n);
+		for (num_type a=1; a<n; a+=(n < 256 ? 1 : 17)) {
+			if (gcd(n, a) != 1) continue;
+			const num_type order = mul_group_mod.element_order(a);
+			assert(mul_group_mod_barrett.element_order(a) == order);
+			if (is_prime) assert(mul_group_mod_barrett.is_primitive_root(a) == mul_group_mod.is_primitive_root(a));
+		}
+	}
+}
+
+// Fermat's little theorem at compile time
+void test_constexpr() {
+	constexpr barrett64_type context(0xffffffffffffffc5ULL);
+	static_assert(context.pow_mod(2, 0xffffffffffffffc4ULL) == 1, "2^(p-1) != 1 mod p");
+	constexpr barrett32_type context32(4294967291U);
+	static_assert(context32.pow_mod(3, 4294967290U) == 1, "3^(p-1) != 1 mod p");
+	static_assert(barrett32_type(1U << 31).pow_mod(3, 1U << 29) == 1, "3^(2^29) != 1 mod 2^31");
+}
+
+int main() {
+	check_context<uint32_t, ((uint32_t)1)<<31, uint64_t>();
+	check_context<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>();
+	check_context<uint64_t, ((uint64_t)1)<<63, uint128_t>();
+	test_mul_group_mod();
+	test_constexpr();
+	return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef BATCH_FACTORIZE_H
+#define BATCH_FACTORIZE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <algorithm>
+#include "factorize.h"
+#include "canonic_factors.h"
+#include "thread_pool.h"
+
+// Factorization of many independent numbers by WorkStealingPool.
+// Result is flat (CSR): prime powers of numbers[i] are pows[offsets[i]], ..., pows[offsets[i+1]-1].
+// Workers write prime powers of chunk of numbers to its part of pows with stride MAX_POW_COUNT,
+// packs them inside the part, then parts are moved together. There is no heap allocation per number.
+// FACTORIZER_TYPE - Factorizer or other class with the same interface, its const factorize method is shared by threads
+template<typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, typename FACTORIZER_TYPE = Factorizer<NUM_TYPE> >
+class BatchFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef FACTORIZER_TYPE factorizer_type;
+	typedef typename factorizer_type::primes_array_type primes_array_type;
+	typedef CanonicFactorsTemplate<num_type, MAX_POW_COUNT, factorizer_type> canonic_factors_type;
+	typedef typename canonic_factors_type::PrimePow prime_pow_type;
+	typedef typename canonic_factors_type::exp_type exp_type;
+	// numbers per task of pool
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 256;
+
+private:
+	factorizer_type factorizer;
+	WorkStealingPool &pool;
+	size_t chunk_size;
+
+	BatchFactorizer() = delete;
+	BatchFactorizer(const BatchFactorizer &b) = delete;
+	BatchFactorizer& operator=(const BatchFactorizer &b) = delete;
+
+public:
+	BatchFactorizer(primes_array_type b_primes_array, WorkStealingPool &b_pool, size_t b_chunk_size = DEFAULT_CHUNK_SIZE) :
+		factorizer(b_primes_array), pool(b_pool), chunk_size(b_chunk_size) {
+		assert(chunk_size > 0);
+	}
+
+	// required size of pows array for count numbers
+	static size_t pows_size(size_t count) {
+		return count * MAX_POW_COUNT;
+	}
+
+	// numbers[i] > 0
+	// offsets - count + 1 elements, pows - pows_size(count) elements
+	// returns total count of prime powers == offsets[count]
+	size_t factorize(const num_type numbers[], size_t count, size_t offsets[], prime_pow_type pows[]) {
+		const size_t chunks_count = (count + chunk_size - 1) / chunk_size;
+		// offsets[i+1] - count of prime powers of numbers[i] for a while
+		pool.run(chunks_count, [&] (size_t worker_idx, size_t chunk_idx) {
+			(void)worker_idx;
+			const size_t begin = chunk_idx * chunk_size;
+			const size_t end = std::min(begin + chunk_size, count);
+			prime_pow_type *chunk_pows = pows + pows_size(begin);
+			size_t pows_count = 0;
+			for (size_t i=begin; i<end; ++i) {
+				size_t pow_count = 0;
+				prime_pow_type *number_pows = chunk_pows + pows_count;
+				factorizer.factorize(numbers[i], [number_pows, &pow_count] (num_type prime, typename factorizer_type::exp_type exp) -> bool {
+					assert(pow_count < MAX_POW_COUNT);
+					number_pows[pow_count].prime = prime;
+					number_pows[pow_count].exp = exp;
+					++pow_count;
+					return false;
+				});
+				pows_count += pow_count;
+				offsets[i+1] = pow_count;
+			}
+		});
+
+		// chunks are packed already, move them together
+		offsets[0] = 0;
+		for (size_t chunk_idx=0; chunk_idx<chunks_count; ++chunk_idx) {
+			const size_t begin = chunk_idx * chunk_size;
+			const size_t end = std::min(begin + chunk_size, count);
+			const size_t dest = offsets[begin];
+			for (size_t i=begin; i<end; ++i) offsets[i+1] += offsets[i];
+			if (dest != pows_size(begin)) {
+				std::copy(pows + pows_size(begin), pows + pows_size(begin) + (offsets[end] - dest), pows + dest);
+			}
+		}
+		return offsets[count];
+	}
+};
+
+#endif/*BATCH_FACTORIZE_H*/
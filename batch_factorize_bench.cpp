@@ -0,0 +1,50 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <vector>
+#include "batch_factorize.h"
+#include "pollard_rho.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+typedef RhoFactorizer<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> rho_fzr_type;
+typedef BatchFactorizer<uint_fast64_t, 15, rho_fzr_type> batch_fzr_type;
+typedef batch_fzr_type::num_type num_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// returns numbers per second
+double bench_batch(size_t threads_count, const std::vector<num_type> &numbers, std::vector<size_t> &offsets, std::vector<batch_fzr_type::prime_pow_type> &pows) {
+	WorkStealingPool pool(threads_count);
+	batch_fzr_type batch_factorizer(batch_fzr_type::primes_array_type(), pool);
+	double t0 = get_time();
+	size_t total = batch_factorizer.factorize(numbers.data(), numbers.size(), offsets.data(), pows.data());
+	double t = get_time() - t0;
+	assert(total == offsets[numbers.size()]);
+	(void)total;
+	return numbers.size() / t;
+}
+
+int main() {
+	// consecutive numbers above 10^15
+	const size_t count = 1024*256;
+	std::vector<num_type> numbers(count);
+	for (size_t i=0; i<count; ++i) numbers[i] = 1000000000000000ULL + i;
+	std::vector<size_t> offsets(count + 1);
+	std::vector<batch_fzr_type::prime_pow_type> pows(batch_fzr_type::pows_size(count));
+
+	const size_t hardware_threads = WorkStealingPool::default_threads_count();
+	printf("%u numbers above 10^15, RhoFactorizer, %u hardware threads\n", (unsigned int)count, (unsigned int)hardware_threads);
+	double one_thread_speed = 0;
+	for (size_t threads_count=1; threads_count<=2*hardware_threads || threads_count<=4; threads_count*=2) {
+		double speed = bench_batch(threads_count, numbers, offsets, pows);
+		if (threads_count == 1) one_thread_speed = speed;
+		printf("%3u threads %10.0f numbers/s, speedup %5.2f\n", (unsigned int)threads_count, speed, speed / one_thread_speed);
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <vector>
+#include "batch_factorize.h"
+#include "pollard_rho.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+template <typename BATCH_FACTORIZER_TYPE>
+void check_batch(
+	BATCH_FACTORIZER_TYPE &batch_factorizer,
+	typename BATCH_FACTORIZER_TYPE::canonic_factors_type::CanonicFactorizer &cfzr,
+	const std::vector<typename BATCH_FACTORIZER_TYPE::num_type> &numbers
+) {
+	typedef typename BATCH_FACTORIZER_TYPE::canonic_factors_type cft_type;
+	std::vector<size_t> offsets(numbers.size() + 1);
+	std::vector<typename BATCH_FACTORIZER_TYPE::prime_pow_type> pows(BATCH_FACTORIZER_TYPE::pows_size(numbers.size()));
+	size_t total = batch_factorizer.factorize(numbers.data(), numbers.size(), offsets.data(), pows.data());
+	assert(offsets[0] == 0 && offsets[numbers.size()] == total);
+	for (size_t i=0; i<numbers.size(); ++i) {
+		assert(offsets[i] <= offsets[i+1]);
+		typename cft_type::CanonicFactors a(cfzr, numbers[i]);
+		typename cft_type::PrimePow my_pows[16];
+		const size_t my_pow_count = a.copy(my_pows, 16);
+		assert(offsets[i+1] - offsets[i] == my_pow_count);
+		for (size_t j=0; j<my_pow_count; ++j) {
+			assert(pows[offsets[i]+j].prime == my_pows[j].prime);
+			assert(pows[offsets[i]+j].exp == my_pows[j].exp);
+		}
+		assert(cft_type::CanonicFactors::value(pows.data() + offsets[i], my_pow_count) == numbers[i]);
+	}
+}
+
+void test_batch_factorize() {
+	typedef BatchFactorizer<uint_fast64_t, 15> batch_fzr_type;
+	uint_fast64_t primes[1024];
+	size_t primes_count = Factorizer<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	batch_fzr_type::primes_array_type primes_array(primes, primes_count);
+	batch_fzr_type::canonic_factors_type::CanonicFactorizer cfzr(primes_array);
+
+	std::vector<uint_fast64_t> numbers;
+	for (uint_fast64_t n=1; n<=1024*16; ++n) numbers.push_back(n);
+	// primorial(15) has the most prime powers
+	numbers.push_back(614889782588491410ULL);
+	numbers.push_back(65521ULL * 65537ULL);
+
+	const size_t threads_counts[] = {1, 2, 5};
+	const size_t chunk_sizes[] = {1, 7, batch_fzr_type::DEFAULT_CHUNK_SIZE, 1024*64};
+	for (size_t i=0; i<sizeof(threads_counts)/sizeof(threads_counts[0]); ++i) {
+		WorkStealingPool pool(threads_counts[i]);
+		for (size_t j=0; j<sizeof(chunk_sizes)/sizeof(chunk_sizes[0]); ++j) {
+			batch_fzr_type batch_factorizer(primes_array, pool, chunk_sizes[j]);
+			check_batch(batch_factorizer, cfzr, numbers);
+			check_batch(batch_factorizer, cfzr, std::vector<uint_fast64_t>());
+			check_batch(batch_factorizer, cfzr, std::vector<uint_fast64_t>(1, 1));
+		}
+	}
+}
+
+void test_batch_factorize_rho() {
+	typedef RhoFactorizer<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> rho_fzr_type;
+	typedef BatchFactorizer<uint_fast64_t, 15, rho_fzr_type> batch_fzr_type;
+	batch_fzr_type::primes_array_type primes_array;
+	batch_fzr_type::canonic_factors_type::CanonicFactorizer cfzr(primes_array);
+	WorkStealingPool pool(3);
+	batch_fzr_type batch_factorizer(primes_array, pool, 16);
+	std::vector<uint_fast64_t> numbers;
+	for (uint_fast64_t n=UINT64_MAX; n>=UINT64_MAX-1024; --n) numbers.push_back(n);
+	check_batch(batch_factorizer, cfzr, numbers);
+}
+
+void tests_suite() {
+	test_batch_factorize();
+	test_batch_factorize_rho();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -16,7 +16,8 @@
 // primorial(9)  < 2^32 < primorial(10)
 // primorial(15) < 2^64 < primorial(16)
 
-template<typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT>
+// FACTORIZER_TYPE - Factorizer or other class with the same interface
+template<typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, typename FACTORIZER_TYPE = Factorizer<NUM_TYPE> >
 class CanonicFactorsTemplate {
 public:
 	typedef NUM_TYPE num_type;
@@ -42,7 +43,7 @@ struct PrimePow {
 
 class CanonicFactorizer {
 private:
-	typedef Factorizer<num_type> factorizer_type;
+	typedef FACTORIZER_TYPE factorizer_type;
 public:
 	typedef typename factorizer_type::primes_array_type primes_array_type;
 
@@ -55,16 +56,7 @@ private:
 	CanonicFactorizer& operator=(const CanonicFactorizer &b) = delete;
 
 public:
-	CanonicFactorizer(primes_array_type primes_array) :
-		factorizer(
-			primes_array,
-			std::bind(
-				&CanonicFactorizer::factorize_cb,
-				this,
-				std::placeholders::_1,
-				std::placeholders::_2
-			)
-		) {}
+	CanonicFactorizer(primes_array_type primes_array) : factorizer(primes_array) {}
 	
 	CanonicFactorizer() : CanonicFactorizer(primes_array_type()) {}
 
@@ -79,7 +71,9 @@ public:
 	pow_count_type factorize(num_type n, PrimePow pows[]) {
 		pow_count = 0;
 		m_pows = pows;
-		factorizer.factorize(n);
+		factorizer.factorize(n, [this] (num_type prime, typename factorizer_type::exp_type exp) -> bool {
+			return factorize_cb(prime, exp);
+		});
 		pows = NULL;
 		return pow_count;
 	}
@@ -132,6 +126,13 @@ public:
 		assign(n);
 	}
 	
+	// prime powers in ascending order of primes, e.g. from RangeFactorizer
+	CanonicFactors(CanonicFactorizer &b_factorizer, const PrimePow b_pows[], pow_count_type b_pow_count) :
+		factorizer(b_factorizer), pow_count(b_pow_count) {
+		assert(pow_count <= MAX_POW_COUNT);
+		std::copy(b_pows, b_pows+b_pow_count, pows);
+	}
+	
 	void assign(num_type n) {
 		if (n == 1) {		// just for optimisation
 			pow_count = 0;
@@ -166,11 +167,13 @@ public:
 	void fdump(FILE *stream) const {
 		fprintf(stream, "%u[", (unsigned int)pow_count);
 		if (pow_count > 0) {
+			char prime_chars[UnsignedOps<num_type>::MAX_DIGITS + 1];
 			for (pow_count_type i=0; i<pow_count; ++i) {
+				UnsignedOps<num_type>::to_chars(pows[i].prime, prime_chars);
 				fprintf(
 					stream,
-					"%llu^%u%s",
-					(unsigned long long)pows[i].prime,
+					"%s^%u%s",
+					prime_chars,
 					(unsigned int)pows[i].exp,
 					(i != pow_count-1 ? " " : "")
 				);
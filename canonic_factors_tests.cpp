@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include "canonic_factors.h"
+#include "uint128.h"
 
 void test_constructor_and_value() {
 	typedef uint_fast64_t num_type;
@@ -148,12 +149,41 @@ void test_carmichael_02() {
 	}
 }
 
+// the same values as of 64-bit num_type, products beyond 2^64
+void test_uint128() {
+	typedef CanonicFactorsTemplate<uint_fast64_t, 15> cft64_type;
+	typedef CanonicFactorsTemplate<uint128_t, 15> cft128_type;
+	cft64_type::CanonicFactorizer cfzr64;
+	cft128_type::CanonicFactorizer cfzr128;
+	typedef cft64_type::CanonicFactors cf64_type;
+	typedef cft128_type::CanonicFactors cf128_type;
+	cf64_type a64(cfzr64);
+	cf128_type a128(cfzr128);
+	for (uint_fast64_t i=1; i<=1024*2+1; ++i) {
+		a64.assign(i);
+		a128.assign(i);
+		assert(a128.value() == i);
+		assert(cf128_type::eulers_phi(a128).value() == cf64_type::eulers_phi(a64).value());
+		assert(cf128_type::carmichael(a128).value() == cf64_type::carmichael(a64).value());
+	}
+	
+	// (2^32 - 5)^2 * 1000003^2 * 65537 > 2^120
+	const uint128_t p32 = 4294967291ULL;
+	cf128_type a(cfzr128, p32 * 1000003ULL), b(cfzr128, p32 * 1000003ULL * 65537ULL);
+	cf128_type c = a * b;
+	assert(c.value() == p32 * p32 * 1000003ULL * 1000003ULL * 65537ULL);
+	assert(cf128_type::eulers_phi(c).value() == p32 * (p32 - 1) * 1000003ULL * 1000002ULL * 65536ULL);
+	// lcm(p32 - 1, 1000002, 65536) * p32 * 1000003, p32 - 1 == 2 * 5 * 19 * 22605091, 1000002 == 2 * 3 * 166667
+	assert(cf128_type::carmichael(c).value() == (uint128_t)65536 * 5 * 19 * 22605091 * 3 * 166667 * p32 * 1000003ULL);
+}
+
 void tests_suite() {
 	test_constructor_and_value();
 	test_mul();
 	test_eulers_phi();
 	test_carmichael();
 	test_carmichael_02();
+	test_uint128();
 }
 
 int main() {
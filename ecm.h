@@ -0,0 +1,315 @@
+#ifndef ECM_H
+#define ECM_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+#include "mul_mod.h"
+#include "miller_rabin.h"
+#include "pollard_rho.h"
+#include "pollard_pm1.h"
+#include "thread_pool.h"
+
+// Lenstra's elliptic curve method on Montgomery curves B*y^2 = x^3 + A*x^2 + x.
+// Points are projective (X : Z) without y, curve is given by (A + 2) / 4 as fraction,
+// Suyama's parametrization by sigma gives both of them without modular inversion.
+// Stage 1 multiplies point by every prime power <= B1 by Montgomery's ladder,
+// primes are taken from PrimesArray (primes above its last one from PrimesSieve).
+// Stage 2 covers primes q in (B1, B2] by baby steps j*Q and giant steps m*D*Q, q == m*D +- j:
+// q*Q == 0 modulo p iff X(m*D*Q)*Z(j*Q) - X(j*Q)*Z(m*D*Q) == 0 modulo p,
+// these differences are multiplied together and gcd is taken once.
+// Prime powers and pairs (m, j) of primes in (B1, B2] are computed once by constructor (see StagesPlan).
+// Composites are tried by Pollard's p - 1 and Williams' p + 1 before curves.
+// Composites of at most rho_bits bits are split by Pollard's rho which is faster for them.
+// Curves are run by WorkStealingPool if it is given: one curve per worker at a time.
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class EcmFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef RhoFactorizer<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> rho_factorizer_type;
+	typedef typename rho_factorizer_type::trial_factorizer_type trial_factorizer_type;
+	typedef typename trial_factorizer_type::primes_array_type primes_array_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename trial_factorizer_type::factorize_cb_type factorize_cb_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	typedef MillerRabin<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> miller_rabin_type;
+	typedef PollardPM1<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> pm1_type;
+	static constexpr num_type DEFAULT_TRIAL_BOUND = 1024;
+	// bounds for factors up to about 20 decimal digits
+	static constexpr uint64_t DEFAULT_B1 = 11000;
+	static constexpr uint64_t DEFAULT_B2 = 100 * DEFAULT_B1;
+	// composites up to so many bits are split by Pollard's rho
+	static constexpr uint_fast8_t DEFAULT_RHO_BITS = 64;
+	// gcd of stage 1 is computed once per so many prime powers
+	static constexpr size_t GCD_BATCH = 64;
+	// sigma of the first curve, every sigma > 5 gives valid curve
+	static constexpr uint64_t FIRST_SIGMA = 6;
+	// find_divisor falls back to Pollard's rho after so many curves found n itself
+	static constexpr size_t MAX_FAILED_CURVES = 8;
+
+	// projective x-coordinate of point
+	struct Point {
+		num_type x;
+		num_type z;
+	};
+
+	// (A + 2) / 4 == a24_num / a24_den
+	struct Curve {
+		num_type a24_num;
+		num_type a24_den;
+	};
+
+private:
+	// every cofactor prime > 2, so there are fewer of them than bits in num_type
+	static constexpr uint_fast16_t MAX_FACTORS_COUNT = sizeof(num_type) * 8;
+
+	trial_factorizer_type trial_factorizer;
+	factorize_cb_type cb;
+	WorkStealingPool *pool;
+	num_type trial_bound;
+	uint_fast8_t rho_bits;
+	StagesPlan plan;
+	pm1_type pm1;
+
+public:
+	// pool - NULL for running curves in calling thread, it must not run factorize itself
+	EcmFactorizer(primes_array_type b_primes_array, factorize_cb_type b_cb, WorkStealingPool *b_pool = NULL,
+		uint64_t b_b1 = DEFAULT_B1, uint64_t b_b2 = DEFAULT_B2, num_type b_trial_bound = DEFAULT_TRIAL_BOUND,
+		uint_fast8_t b_rho_bits = DEFAULT_RHO_BITS) :
+		trial_factorizer(b_primes_array), cb(b_cb), pool(b_pool), trial_bound(b_trial_bound), rho_bits(b_rho_bits),
+		plan(b_primes_array, b_b1, b_b2), pm1(b_primes_array) {
+		assert(trial_bound >= 2);
+	}
+
+	// only factorize method with callback argument may be used
+	EcmFactorizer(primes_array_type b_primes_array, WorkStealingPool *b_pool = NULL,
+		uint64_t b_b1 = DEFAULT_B1, uint64_t b_b2 = DEFAULT_B2, num_type b_trial_bound = DEFAULT_TRIAL_BOUND,
+		uint_fast8_t b_rho_bits = DEFAULT_RHO_BITS) :
+		trial_factorizer(b_primes_array), pool(b_pool), trial_bound(b_trial_bound), rho_bits(b_rho_bits),
+		plan(b_primes_array, b_b1, b_b2), pm1(b_primes_array) {
+		assert(trial_bound >= 2);
+	}
+
+	// use default copy constructor and assignment operator
+
+	primes_array_type get_primes_array() const {
+		return trial_factorizer.get_primes_array();
+	}
+
+	static bool is_prime(num_type n) {
+		return miller_rabin_type::is_prime(n);
+	}
+
+	const pm1_type& get_pm1() const {
+		return pm1;
+	}
+
+private:
+	static num_type add_mod(num_type n, num_type a, num_type b) {
+		return (a >= n - b ? a - (n - b) : a + b);
+	}
+
+	static num_type sub_mod(num_type n, num_type a, num_type b) {
+		return (a >= b ? a - b : a + (n - b));
+	}
+
+public:
+	// 2 * p
+	static Point dbl(num_type n, const Curve &curve, const Point &p) {
+		const num_type s = mul_mod_type::square_mod(n, add_mod(n, p.x, p.z));
+		const num_type d = mul_mod_type::square_mod(n, sub_mod(n, p.x, p.z));
+		// 4 * x * z
+		const num_type t = sub_mod(n, s, d);
+		const num_type dd = mul_mod_type::mul_mod(n, d, curve.a24_den);
+		return Point{mul_mod_type::mul_mod(n, s, dd), mul_mod_type::mul_mod(n, t, add_mod(n, dd, mul_mod_type::mul_mod(n, curve.a24_num, t)))};
+	}
+
+	// p + q, diff == p - q
+	static Point add(num_type n, const Point &p, const Point &q, const Point &diff) {
+		const num_type u = mul_mod_type::mul_mod(n, sub_mod(n, p.x, p.z), add_mod(n, q.x, q.z));
+		const num_type v = mul_mod_type::mul_mod(n, add_mod(n, p.x, p.z), sub_mod(n, q.x, q.z));
+		return Point{
+			mul_mod_type::mul_mod(n, diff.z, mul_mod_type::square_mod(n, add_mod(n, u, v))),
+			mul_mod_type::mul_mod(n, diff.x, mul_mod_type::square_mod(n, sub_mod(n, u, v)))
+		};
+	}
+
+	// k * p by Montgomery's ladder, k > 0
+	static Point ladder(num_type n, const Curve &curve, const Point &p, uint64_t k) {
+		assert(k > 0);
+		Point r0 = p, r1 = dbl(n, curve, p);
+		// r1 - r0 == p
+		for (int_fast8_t i=62-__builtin_clzll(k); i>=0; --i) {
+			if ((k >> i) & 1) {
+				r0 = add(n, r1, r0, p);
+				r1 = dbl(n, curve, r1);
+			} else {
+				r1 = add(n, r1, r0, p);
+				r0 = dbl(n, curve, r0);
+			}
+		}
+		return r0;
+	}
+
+	// Suyama's parametrization: u = sigma^2 - 5, v = 4 * sigma,
+	// starting point (u^3 : v^3), (A + 2) / 4 == (v - u)^3 * (3 * u + v) / (16 * u^3 * v)
+	// n > 16
+	static Curve suyama_curve(num_type n, uint64_t sigma, Point &p) {
+		assert(n > 16);
+		const num_type s = (num_type)(sigma % n);
+		const num_type u = sub_mod(n, mul_mod_type::square_mod(n, s), 5);
+		const num_type v = mul_mod_type::mul_mod(n, s, 4);
+		p.x = mul_mod_type::mul_mod(n, mul_mod_type::square_mod(n, u), u);
+		p.z = mul_mod_type::mul_mod(n, mul_mod_type::square_mod(n, v), v);
+		const num_type vu = sub_mod(n, v, u);
+		const num_type u3v = add_mod(n, add_mod(n, add_mod(n, u, u), u), v);
+		Curve curve;
+		curve.a24_num = mul_mod_type::mul_mod(n, mul_mod_type::mul_mod(n, mul_mod_type::square_mod(n, vu), vu), u3v);
+		curve.a24_den = mul_mod_type::mul_mod(n, mul_mod_type::mul_mod(n, p.x, v), 16);
+		return curve;
+	}
+
+	// one curve of given sigma, n - odd composite, n > 16
+	// returns divisor of n, 1 or n if curve failed
+	num_type run_curve(num_type n, uint64_t sigma) const {
+		Point p;
+		const Curve curve = suyama_curve(n, sigma, p);
+
+		// stage 1
+		for (size_t i=0; i<plan.stage1_pows.size(); i+=GCD_BATCH) {
+			const size_t end = std::min(i + GCD_BATCH, plan.stage1_pows.size());
+			const Point saved = p;
+			for (size_t k=i; k<end; ++k) p = ladder(n, curve, p, plan.stage1_pows[k]);
+			num_type g = rho_factorizer_type::gcd(p.z, n);
+			if (g == 1) continue;
+			if (g == n) {
+				// batch overshot, repeat it prime power by prime power
+				p = saved;
+				g = 1;
+				for (size_t k=i; k<end && g == 1; ++k) {
+					p = ladder(n, curve, p, plan.stage1_pows[k]);
+					g = rho_factorizer_type::gcd(p.z, n);
+				}
+			}
+			return g;
+		}
+
+		// stage 2, baby steps j * q for odd j: (j + 2) * q == j * q + 2 * q
+		const Point q = p, q2 = dbl(n, curve, q);
+		Point babies[StagesPlan::BABY_COUNT];
+		uint_fast16_t babies_count = 0;
+		Point prev = q, cur = add(n, q2, q, q);
+		babies[babies_count++] = q;
+		for (uint64_t j=3; j<StagesPlan::D/2; j+=2) {
+			if (StagesPlan::is_baby(j)) babies[babies_count++] = cur;
+			const Point next = add(n, cur, q2, prev);
+			prev = cur;
+			cur = next;
+		}
+		assert(babies_count == StagesPlan::BABY_COUNT);
+
+		// giant steps m * D * q
+		const Point dq = ladder(n, curve, q, StagesPlan::D);
+		Point g = ladder(n, curve, dq, plan.m_begin), g_next = ladder(n, curve, dq, plan.m_begin + 1);
+		num_type acc = 1;
+		const size_t steps_count = plan.steps_count();
+		for (size_t i=0; i<steps_count; ++i) {
+			for (uint_fast16_t w=0; w<StagesPlan::BABY_WORDS; ++w) {
+				for (uint64_t bits=plan.stage2_pairs[i * StagesPlan::BABY_WORDS + w]; bits!=0; bits&=bits-1) {
+					const Point &b = babies[w * 64 + __builtin_ctzll(bits)];
+					acc = mul_mod_type::mul_mod(n, acc, sub_mod(n, mul_mod_type::mul_mod(n, g.x, b.z), mul_mod_type::mul_mod(n, b.x, g.z)));
+				}
+			}
+			const Point next = add(n, g_next, dq, g);
+			g = g_next;
+			g_next = next;
+		}
+		return rho_factorizer_type::gcd(acc, n);
+	}
+
+	// n - odd composite, n > 16
+	// runs curves of sigma = FIRST_SIGMA, FIRST_SIGMA + 1, ... until one of them finds divisor
+	// max_curves > 0 - returns n if so many curves (rounded up to count of threads) failed
+	num_type find_divisor(num_type n, uint64_t max_curves = 0) const {
+		// p^k, p <= B1 is never split by curves: p is in stage 1, so points modulo p and p^k vanish together
+		const num_type r = UnsignedOps<num_type>::isqrt(n);
+		if (r * r == n) return r;
+		const size_t curves_count = (pool != NULL ? pool->get_threads_count() : 1);
+		std::vector<num_type> divisors(curves_count);
+		size_t failed_count = 0;
+		for (uint64_t sigma=FIRST_SIGMA; max_curves == 0 || sigma < FIRST_SIGMA + max_curves; sigma+=curves_count) {
+			if (curves_count == 1) {
+				divisors[0] = run_curve(n, sigma);
+			} else {
+				pool->run(curves_count, [this, n, sigma, &divisors] (size_t worker_idx, size_t task_idx) {
+					(void)worker_idx;
+					divisors[task_idx] = run_curve(n, sigma + task_idx);
+				});
+			}
+			for (size_t i=0; i<curves_count; ++i) {
+				if (divisors[i] != 1 && divisors[i] != n) return divisors[i];
+				failed_count += (divisors[i] == n);
+			}
+			// all factors vanish together: they are small or n is prime power
+			if (failed_count >= MAX_FAILED_CURVES) return rho_factorizer_type::find_divisor(n);
+		}
+		return n;
+	}
+
+	// if cb returns true, factorize interrupts
+	// CB - callable as bool(num_type prime, exp_type exp)
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		assert(n > 0);
+		if (trial_factorizer.trial_division(n, trial_bound, cb)) return;
+		if (n == 1) return;
+		// all prime factors of n are > trial_bound
+		if (n / trial_bound < trial_bound || is_prime(n)) {
+			cb(n, 1);
+			return;
+		}
+
+		num_type factors[MAX_FACTORS_COUNT];
+		uint_fast16_t factors_count = 0;
+		num_type composites[MAX_FACTORS_COUNT];
+		uint_fast16_t composites_count = 0;
+		composites[composites_count++] = n;
+		while (composites_count > 0) {
+			num_type m = composites[--composites_count];
+			if (is_prime(m)) {
+				assert(factors_count < MAX_FACTORS_COUNT);
+				factors[factors_count++] = m;
+				continue;
+			}
+			const uint_fast8_t bits = UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(m);
+			num_type d = (bits <= rho_bits ? rho_factorizer_type::find_divisor(m) : pm1.find_divisor(m));
+			if (d == m) d = find_divisor(m);
+			assert(composites_count + 2 <= MAX_FACTORS_COUNT);
+			composites[composites_count++] = d;
+			composites[composites_count++] = m / d;
+		}
+
+		std::sort(factors, factors + factors_count);
+		for (uint_fast16_t i=0; i<factors_count;) {
+			num_type p = factors[i];
+			exp_type exp = 0;
+			do {
+				++exp;
+				++i;
+			} while (i < factors_count && factors[i] == p);
+			if (cb(p, exp)) return;
+		}
+	}
+
+	// std::function adapter
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+};
+
+#endif/*ECM_H*/
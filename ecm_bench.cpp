@@ -0,0 +1,66 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "ecm.h"
+#include "pollard_rho.h"
+
+typedef EcmFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> ecm_type;
+typedef RhoFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> rho_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!ecm_type::is_prime(n)) ++n;
+	return n;
+}
+
+// seconds per number
+template <typename FZR_TYPE>
+double bench(const FZR_TYPE &factorizer, const std::vector<uint128_t> &numbers) {
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		uint_fast8_t count = 0;
+		factorizer.factorize(numbers[i], [&count] (uint128_t prime, ecm_type::exp_type exp) -> bool {
+			(void)prime;
+			count += exp;
+			return false;
+		});
+		assert(count == 2);
+	}
+	return (get_time() - t0) / numbers.size();
+}
+
+int main() {
+	ecm_type::primes_array_type primes;
+	WorkStealingPool pool;
+	ecm_type ecm_factorizer(primes);
+	ecm_type ecm_parallel_factorizer(primes, &pool);
+	rho_type rho_factorizer(primes);
+	std::mt19937_64 rng(1);
+
+	printf("n of 120 bits == p * q, seconds per number\n");
+	printf("%-8s %10s %10s %10s(%zu threads)\n", "p bits", "rho", "ECM", "ECM", pool.get_threads_count());
+	const uint_fast8_t bits[] = {32, 40, 48, 56, 64};
+	for (size_t b=0; b<sizeof(bits)/sizeof(bits[0]); ++b) {
+		std::vector<uint128_t> numbers(8);
+		for (size_t i=0; i<numbers.size(); ++i) {
+			const uint128_t p = next_prime((rng() >> (65 - bits[b])) | ((uint128_t)1 << (bits[b] - 1)));
+			const uint128_t q = next_prime((((uint128_t)rng() << 64) | rng()) >> (bits[b] + 8));
+			numbers[i] = p * q;
+		}
+		// rho takes about 2^(bits / 2) steps
+		char rho_time[32] = "-";
+		if (bits[b] <= 44) snprintf(rho_time, sizeof(rho_time), "%10.4f", bench(rho_factorizer, numbers));
+		printf("%-8u %10s %10.4f %10.4f\n", (unsigned int)bits[b], rho_time,
+			bench(ecm_factorizer, numbers), bench(ecm_parallel_factorizer, numbers));
+	}
+	return 0;
+}
@@ -0,0 +1,168 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <random>
+#include "ecm.h"
+#include "canonic_factors.h"
+
+typedef EcmFactorizer<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> ecm_fzr_type;
+typedef EcmFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> ecm128_fzr_type;
+
+template <typename NUM_TYPE>
+struct MyPow {
+	NUM_TYPE prime;
+	uint_fast8_t exp;
+};
+
+template <typename NUM_TYPE>
+struct MyFactors {
+	uint_fast8_t pow_count;
+	MyPow<NUM_TYPE> pows[16];
+
+	MyFactors() : pow_count(0) {}
+
+	bool operator()(NUM_TYPE prime, uint_fast8_t exp) {
+		assert(pow_count < 16);
+		pows[pow_count].prime = prime;
+		pows[pow_count].exp = exp;
+		++pow_count;
+		return false;
+	}
+};
+
+// the first prime >= n
+template <typename FZR_TYPE>
+typename FZR_TYPE::num_type next_prime(typename FZR_TYPE::num_type n) {
+	while (!FZR_TYPE::is_prime(n)) ++n;
+	return n;
+}
+
+// checks factors of n: ascending primes with product n
+template <typename FZR_TYPE>
+void check_factors(typename FZR_TYPE::num_type n, const MyFactors<typename FZR_TYPE::num_type> &factors) {
+	typename FZR_TYPE::num_type m = 1;
+	for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+		assert(j == 0 || factors.pows[j-1].prime < factors.pows[j].prime);
+		assert(FZR_TYPE::is_prime(factors.pows[j].prime));
+		for (uint_fast8_t k=0; k<factors.pows[j].exp; ++k) m *= factors.pows[j].prime;
+	}
+	assert(m == n);
+}
+
+void test_curve() {
+	typedef ecm_fzr_type::Point point_type;
+	const uint_fast64_t p = 1000003;
+	point_type p0;
+	const ecm_fzr_type::Curve curve = ecm_fzr_type::suyama_curve(p, 7, p0);
+	// ladder agrees with doubling and differential addition
+	const point_type p2 = ecm_fzr_type::dbl(p, curve, p0);
+	const point_type p3 = ecm_fzr_type::add(p, p2, p0, p0);
+	const point_type p5 = ecm_fzr_type::add(p, p3, p2, p0);
+	const point_type l5 = ecm_fzr_type::ladder(p, curve, p0, 5);
+	typedef ecm_fzr_type::mul_mod_type mul_mod_type;
+	assert(mul_mod_type::mul_mod(p, p5.x, l5.z) == mul_mod_type::mul_mod(p, l5.x, p5.z));
+	// group order of curve modulo prime is in Hasse's interval and divisible by 12
+	uint_fast64_t order = 0;
+	for (uint_fast64_t k=p+1-2*1000; k<=p+1+2*1000; ++k) {
+		if (k % 12 == 0 && ecm_fzr_type::ladder(p, curve, p0, k).z == 0) {
+			order = k;
+			break;
+		}
+	}
+	assert(order != 0);
+}
+
+void test_run_curve() {
+	ecm_fzr_type::primes_array_type primes;
+	ecm_fzr_type ecm_factorizer(primes);
+	std::mt19937_64 rng(1);
+	// factors of about 30 bits are found by a few curves
+	for (uint_fast8_t i=0; i<8; ++i) {
+		const uint_fast64_t p = next_prime<ecm_fzr_type>((rng() >> 34) | ((uint_fast64_t)1 << 29));
+		const uint_fast64_t q = next_prime<ecm_fzr_type>((rng() >> 32) | ((uint_fast64_t)1 << 31));
+		const uint_fast64_t d = ecm_factorizer.find_divisor(p * q);
+		assert(d == p || d == q);
+	}
+	// every prime power is in stage 1: batch overshot is repeated prime power by prime power
+	const uint_fast64_t d = ecm_factorizer.find_divisor(1031 * 1033);
+	assert(d == 1031 || d == 1033);
+}
+
+void test_factorize() {
+	uint_fast64_t primes[2048];
+	const size_t primes_count = PrimesArray<uint_fast64_t>::fill_primes(primes, 2048, UINT64_MAX);
+	ecm_fzr_type::primes_array_type primes_array(primes, primes_count);
+	// rho_bits == 0: every composite is split by ECM
+	MyFactors<uint_fast64_t> factors;
+	ecm_fzr_type ecm_factorizer(primes_array, NULL, ecm_fzr_type::DEFAULT_B1, ecm_fzr_type::DEFAULT_B2, 5, 0);
+	std::mt19937_64 rng(2);
+	for (uint_fast16_t i=0; i<256; ++i) {
+		const uint_fast64_t n = rng() >> (rng() % 64);
+		if (n == 0) continue;
+		factors.pow_count = 0;
+		ecm_factorizer.factorize(n, factors);
+		check_factors<ecm_fzr_type>(n, factors);
+	}
+
+	// 2^64 - 1 = 3 * 5 * 17 * 257 * 641 * 65537 * 6700417
+	factors.pow_count = 0;
+	ecm_factorizer.factorize(UINT64_MAX, factors);
+	const uint_fast64_t my_primes[] = {3, 5, 17, 257, 641, 65537, 6700417};
+	assert(factors.pow_count == 7);
+	for (uint_fast8_t j=0; j<7; ++j) assert(factors.pows[j].prime == my_primes[j] && factors.pows[j].exp == 1);
+
+	// std::function callback
+	ecm_fzr_type ecm_cb_factorizer(primes_array, [&factors] (uint_fast64_t prime, ecm_fzr_type::exp_type exp) -> bool {
+		return factors(prime, exp);
+	});
+	factors.pow_count = 0;
+	ecm_cb_factorizer.factorize(4294967291ULL * 4294967279ULL);
+	assert(factors.pow_count == 2);
+	assert(factors.pows[0].prime == 4294967279ULL && factors.pows[1].prime == 4294967291ULL);
+}
+
+void test_factorize_128() {
+	ecm128_fzr_type::primes_array_type primes;
+	WorkStealingPool pool(4);
+	ecm128_fzr_type ecm_factorizer(primes);
+	ecm128_fzr_type ecm_parallel_factorizer(primes, &pool);
+	std::mt19937_64 rng(3);
+	// p of 44 bits times q of 80 bits is too much for rho
+	for (uint_fast8_t i=0; i<4; ++i) {
+		const uint128_t p = next_prime<ecm128_fzr_type>((rng() >> 20) | ((uint128_t)1 << 43));
+		const uint128_t q = next_prime<ecm128_fzr_type>((((uint128_t)rng() << 64) | rng()) >> 48);
+		MyFactors<uint128_t> factors, parallel_factors;
+		ecm_factorizer.factorize(p * q * 3, factors);
+		ecm_parallel_factorizer.factorize(p * q * 3, parallel_factors);
+		assert(factors.pow_count == 3 && parallel_factors.pow_count == 3);
+		assert(factors.pows[0].prime == 3);
+		assert(factors.pows[1].prime == std::min(p, q) && factors.pows[2].prime == std::max(p, q));
+		for (uint_fast8_t j=0; j<3; ++j) {
+			assert(parallel_factors.pows[j].prime == factors.pows[j].prime && parallel_factors.pows[j].exp == 1);
+		}
+	}
+
+	// p^2 * q
+	const uint128_t p = next_prime<ecm128_fzr_type>((uint128_t)1 << 40), q = next_prime<ecm128_fzr_type>((uint128_t)1 << 45);
+	MyFactors<uint128_t> factors;
+	ecm_parallel_factorizer.factorize(p * p * q, factors);
+	assert(factors.pow_count == 2);
+	assert(factors.pows[0].prime == p && factors.pows[0].exp == 2);
+	assert(factors.pows[1].prime == q && factors.pows[1].exp == 1);
+
+	// with canonic factors and checkers
+	typedef CanonicFactorsTemplate<uint128_t, 15, ecm128_fzr_type> cft_type;
+	cft_type::CanonicFactorizer cfzr;
+	cft_type::CanonicFactors a(cfzr, ~(uint128_t)0);
+	assert(a.value() == ~(uint128_t)0);
+	DivisorsCounter<uint128_t, ecm128_fzr_type> divisors_counter(primes);
+	assert(divisors_counter.divisors_count(p * p * q) == 6);
+}
+
+int main() {
+	test_curve();
+	test_run_curve();
+	test_factorize();
+	test_factorize_128();
+	return 0;
+}
@@ -6,24 +6,74 @@
 #include <stdint.h>
 #include <math.h>
 #include <functional>
+#include <algorithm>
+#include "primes_sieve.h"
+#include "uint128.h"
 
 template <typename NUM_TYPE> class Factorizer;
 
+// division free divisibility test by odd p, w - bits count of num_type:
+//     p * inverse == 1 (mod 2^w), limit = (2^w - 1) / p
+//     p divides n <=> n * inverse mod 2^w <= limit, then n / p == n * inverse mod 2^w
+template <typename NUM_TYPE>
+struct PrimeInverse {
+public:
+	typedef NUM_TYPE num_type;
+	
+	num_type inverse;
+	num_type limit;
+	
+	PrimeInverse() : inverse(0), limit(0) {}
+	
+	// p - odd
+	PrimeInverse(num_type p) : inverse(p), limit((num_type)~(num_type)0 / p) {
+		assert(p & 1);
+		// Newton's iteration, p * p == 1 (mod 8) and every step doubles correct bits count
+		while (mul_low(p, inverse) != 1) inverse = mul_low(inverse, (num_type)(2 - mul_low(p, inverse)));
+	}
+	// use default copy constructor and assignment operator
+	
+	// a * b mod 2^w, unsigned arithmetic even for types narrower than int
+	static num_type mul_low(num_type a, num_type b) {
+		return (num_type)(a * (b + 0u));
+	}
+	
+	// if p divides n then n is replaced by n / p
+	bool divide(num_type &n) const {
+		num_type q = mul_low(n, inverse);
+		if (q > limit) return false;
+		n = q;
+		return true;
+	}
+};
+
 template <typename NUM_TYPE>
 struct PrimesArray {
 public:
 	typedef NUM_TYPE num_type;
+	typedef PrimeInverse<num_type> prime_inverse_type;
 
 	num_type *primes;
 	size_t count;
+	// optional companion table: inverses[i] is for primes[i], inverses[0] is not used
+	const prime_inverse_type *inverses;
 	
-	PrimesArray() : primes(NULL), count(0) {}
-	PrimesArray(num_type *b_primes, size_t b_count) : primes(b_primes), count(b_count) {}
+	PrimesArray() : primes(NULL), count(0), inverses(NULL) {}
+	PrimesArray(num_type *b_primes, size_t b_count) : primes(b_primes), count(b_count), inverses(NULL) {}
+	PrimesArray(num_type *b_primes, size_t b_count, const prime_inverse_type *b_inverses) :
+		primes(b_primes), count(b_count), inverses(b_inverses) {}
 	// use default copy constructor and assignment operator
 	
 	static size_t fill_primes(num_type primes[], size_t primes_size, num_type max_num) {
 		return Factorizer<num_type>::fill_primes(primes, primes_size, max_num);
 	}
+	
+	// primes[0] == 2 has no inverse
+	static void fill_inverses(const num_type primes[], size_t count, prime_inverse_type inverses[]) {
+		for (size_t i=0; i<count; ++i) {
+			inverses[i] = (primes[i] & 1 ? prime_inverse_type(primes[i]) : prime_inverse_type());
+		}
+	}
 };
 
 template <typename NUM_TYPE>
@@ -31,9 +81,12 @@ class Factorizer {
 public:
 	typedef NUM_TYPE num_type;
 	typedef PrimesArray<num_type> primes_array_type;
+	typedef typename primes_array_type::prime_inverse_type prime_inverse_type;
 	static_assert(sizeof(num_type) <= 32, "Too big num_type for exp_type");
 	typedef uint_fast8_t exp_type;
 	typedef std::function<bool(num_type prime, exp_type exp)> factorize_cb_type;
+	// tail_division sieves primes for ranges of at least so many numbers
+	static constexpr uint64_t SIEVE_DIVISION_MIN_RANGE = 1 << 15;
 	
 private:
 	primes_array_type primes_array;
@@ -43,6 +96,9 @@ public:
 	Factorizer(primes_array_type b_primes_array, factorize_cb_type b_cb) :
 		primes_array(b_primes_array), cb(b_cb) {}
 	
+	// only factorize methods with callback argument may be used
+	Factorizer(primes_array_type b_primes_array) : primes_array(b_primes_array) {}
+	
 	// use default copy constructor and assignment operator
 	
 	primes_array_type get_primes_array() const {
@@ -50,44 +106,21 @@ public:
 	}
 	
 private:
-	static_assert(sizeof(num_type) <= 8, "Too big num_type for round_sqrt");
-	static inline num_type round_sqrt(num_type n) {
-		return round(sqrt((double)n));
+	// exact floor(sqrt(n)) for num_type up to uint128_t
+	static inline num_type isqrt(num_type n) {
+		return UnsignedOps<num_type>::isqrt(n);
 	}
 	
 public:
-	#define NUM_MAX UINT64_MAX
-	#define SQRT_MAX ((num_type)UINT32_MAX)
-	static void test_round_sqrt() {
-		const num_type max_sqrt = SQRT_MAX + (num_type)1;
-		const num_type max_delta = 1024;
-		for (num_type i=max_sqrt; i>=max_sqrt-1024; --i) {
-			//printf("%llu\n", i);
-			for (num_type j=0; j<=max_delta; ++j) {
-				num_type s1, s2;
-				if (i == max_sqrt) {
-					if (j == 0) s1 = NUM_MAX;
-					else s1 = NUM_MAX - j + 1;
-					s2 = NUM_MAX;
-				} else {
-					num_type s = i * i;
-					s1 = s - j;
-					s2 = s + j;
-				}
-				//printf("%llu %llu\n", s1, s2);
-				num_type r1 = round_sqrt(s1), r2 = round_sqrt(s2);
-				assert(r1 == i && r2 == i);
-			}
-			//printf("\n");
-		}
-	}
-	#undef NUM_MAX
-	#undef SQRT_MAX
-	
-	// if cb returns true, factorize interrupts
-	void factorize(num_type n) const {
+	// trial division by primes p <= bound while p <= sqrt(n)
+	// found primes are passed to cb, n is replaced by unfactored cofactor:
+	//     1, prime or number without prime factors <= bound
+	// returns true if cb interrupted factorization
+	// CB - callable as bool(num_type prime, exp_type exp), it is called directly and may be inlined
+	template <typename CB>
+	bool trial_division(num_type &n, num_type bound, CB &&cb) const {
 		assert(n > 0);
-		if (n == 1) return;
+		if (n == 1) return false;
 		
 		if (!(n & 1)) {
 			exp_type exp = 0;
@@ -95,61 +128,149 @@ public:
 				n >>= 1;
 				++exp;
 			} while (!(n & 1));
-			if (cb(2, exp)) return;
+			if (cb(2, exp)) return true;
 		}
 		
-		num_type n_sqrt = round_sqrt(n);
-		num_type p = 3;
-		size_t idx = 2;
+		num_type n_sqrt = isqrt(n);
+		num_type p_max = std::min(n_sqrt, bound);
+		// primes[0] == 2, primes[1] == 3, ...
+		const num_type *primes = primes_array.primes;
+		const prime_inverse_type *inverses = primes_array.inverses;
+		const size_t count = primes_array.count;
+		size_t idx = 1;
+		if (inverses != NULL) {
+			for (; idx < count; ++idx) {
+				const num_type p = primes[idx];
+				if (p > p_max) return false;
+				if (inverses[idx].divide(n)) {
+					exp_type exp = 1;
+					while (inverses[idx].divide(n)) ++exp;
+					if (cb(p, exp)) return true;
+					n_sqrt = isqrt(n);
+					p_max = std::min(n_sqrt, bound);
+				}
+			}
+		} else {
+			for (; idx < count; ++idx) {
+				const num_type p = primes[idx];
+				if (p > p_max) return false;
+				if (!(n % p)) {
+					exp_type exp = 0;
+					do {
+						n /= p;
+						++exp;
+					} while (!(n % p));
+					if (cb(p, exp)) return true;
+					n_sqrt = isqrt(n);
+					p_max = std::min(n_sqrt, bound);
+				}
+			}
+		}
 		
-		while (p <= n_sqrt) {
+		// primes array is over
+		return tail_division(n, (idx > 1 ? primes[idx-1] : 1), bound, cb);
+	}
+	
+	// trial division above the last prime of primes array, the same arguments as of wheel_division:
+	// long ranges are tried by primes of PrimesIterator, short ones by mod 30 wheel without sieving
+	template <typename CB>
+	static bool tail_division(num_type &n, num_type last, num_type bound, CB &&cb) {
+		const num_type p_max = std::min(isqrt(n), bound);
+		if (p_max > last && p_max - last >= (num_type)SIEVE_DIVISION_MIN_RANGE) return sieve_division(n, last, bound, cb);
+		return wheel_division(n, last, bound, cb);
+	}
+	
+	// trial division by primes greater than last while they are <= bound and <= sqrt(n),
+	// n - odd without prime factors <= last
+	// returns true if cb interrupted factorization
+	template <typename CB>
+	static bool sieve_division(num_type &n, num_type last, num_type bound, CB &&cb) {
+		num_type n_sqrt = isqrt(n);
+		num_type p_max = std::min(n_sqrt, bound);
+		// segment is not longer than the range
+		const num_type range_bytes = (p_max > last ? (p_max - last) / PrimesSieve<num_type>::WHEEL + 1 : 1);
+		PrimesIterator<num_type> primes(
+			std::max((uint64_t)last + 1, (uint64_t)3),
+			(size_t)std::min(range_bytes, (num_type)PrimesIterator<num_type>::DEFAULT_SEGMENT_SIZE)
+		);
+		for (;;) {
+			const num_type p = primes.next();
+			if (p > p_max) return false;
 			if (!(n % p)) {
 				exp_type exp = 0;
 				do {
 					n /= p;
 					++exp;
 				} while (!(n % p));
-				if (cb(p, exp)) return;
-				n_sqrt = round_sqrt(n);
+				if (cb(p, exp)) return true;
+				n_sqrt = isqrt(n);
+				p_max = std::min(n_sqrt, bound);
 			}
-			if (idx < primes_array.count) {
-				p = primes_array.primes[idx++];
+		}
+	}
+	
+	// trial division by numbers coprime to 30 (and by 3, 5) greater than last
+	// while they are <= bound and <= sqrt(n), n - odd without prime factors <= last
+	// returns true if cb interrupted factorization
+	template <typename CB>
+	static bool wheel_division(num_type &n, num_type last, num_type bound, CB &&cb) {
+		typedef PrimesSieve<num_type> wheel_type;
+		num_type n_sqrt = isqrt(n);
+		num_type p_max = std::min(n_sqrt, bound);
+		num_type p = last;
+		uint_fast8_t wheel_idx = wheel_type::WHEEL_COUNT;
+		for (;;) {
+			if (p < 7) {
+				p = (p < 3 ? 3 : p + 2);
 			} else {
-				p += 2;
+				if (wheel_idx == wheel_type::WHEEL_COUNT) wheel_idx = wheel_type::wheel_bits[p % wheel_type::WHEEL];
+				p += wheel_type::wheel_steps[wheel_idx];
+				wheel_idx = (wheel_idx + 1) & (wheel_type::WHEEL_COUNT - 1);
+			}
+			if (p > p_max) return false;
+			if (!(n % p)) {
+				exp_type exp = 0;
+				do {
+					n /= p;
+					++exp;
+				} while (!(n % p));
+				if (cb(p, exp)) return true;
+				n_sqrt = isqrt(n);
+				p_max = std::min(n_sqrt, bound);
 			}
 		}
+	}
+	
+	// if cb returns true, factorize interrupts
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		if (trial_division(n, (num_type)~(num_type)0, cb)) return;
 		if (n != 1) cb(n, 1);
 	}
 	
+	// std::function adapters
+	
+	bool trial_division(num_type &n, num_type bound) const {
+		return trial_division(n, bound, cb);
+	}
+	
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+	
+	// segmented sieve of Eratosthenes, see PrimesSieve
 	static size_t fill_primes(num_type primes[], size_t primes_size, num_type max_num) {
-		if (primes_size == 0 || max_num < 2) return 0;
-		primes[0] = 2;
-		size_t primes_count = 1;
-		num_type n = 3;
-		num_type n_sqrt = 1;
-		while (primes_count < primes_size && n <= max_num) {
-			bool is_prime = true;
-			for (size_t i=0; primes[i]<=n_sqrt; ++i) {
-				if (!(n % primes[i])) {
-					is_prime = false;
-					break;
-				}
-			}
-			assert(primes_count < primes_size);
-			if (is_prime) primes[primes_count++] = n;
-			n += 2;
-			n_sqrt = round_sqrt(n);
-		}
-		return primes_count;
+		return PrimesSieve<num_type>::fill_primes(primes, primes_size, max_num);
 	}
 };
 
-template< typename NUM_TYPE>
+// FACTORIZER_TYPE - Factorizer or other class with the same interface
+template< typename NUM_TYPE, typename FACTORIZER_TYPE = Factorizer<NUM_TYPE> >
 class PrimeChecker {
 public:
 	typedef NUM_TYPE num_type;
 private:
-	typedef Factorizer<num_type> factorizer_type;
+	typedef FACTORIZER_TYPE factorizer_type;
 public:
 	typedef typename factorizer_type::primes_array_type primes_array_type;
 	
@@ -163,16 +284,7 @@ private:
 	PrimeChecker& operator=(const PrimeChecker &b) = delete;
 	
 public:
-	PrimeChecker(primes_array_type b_primes_array) :
-		factorizer(
-			b_primes_array,
-			std::bind(
-				&PrimeChecker::factorize_cb,
-				this,
-				std::placeholders::_1,
-				std::placeholders::_2
-			)
-		) {}
+	PrimeChecker(primes_array_type b_primes_array) : factorizer(b_primes_array) {}
 	
 private:
 	bool factorize_cb(typename factorizer_type::num_type prime, typename factorizer_type::exp_type exp) {
@@ -185,17 +297,20 @@ public:
 	bool is_prime(num_type n) {
 		assert(n > 1);
 		m_n = n;
-		factorizer.factorize(n);
+		factorizer.factorize(n, [this] (num_type prime, typename factorizer_type::exp_type exp) -> bool {
+			return factorize_cb(prime, exp);
+		});
 		return result;
 	}
 };
 
-template< typename NUM_TYPE>
+// FACTORIZER_TYPE - Factorizer or other class with the same interface
+template< typename NUM_TYPE, typename FACTORIZER_TYPE = Factorizer<NUM_TYPE> >
 class DivisorsCounter {
 public:
 	typedef NUM_TYPE num_type;
 private:
-	typedef Factorizer<num_type> factorizer_type;
+	typedef FACTORIZER_TYPE factorizer_type;
 public:
 	typedef typename factorizer_type::primes_array_type primes_array_type;
 	
@@ -208,16 +323,7 @@ private:
 	DivisorsCounter& operator=(const DivisorsCounter &b) = delete;
 	
 public:
-	DivisorsCounter(primes_array_type b_primes_array) :
-		factorizer(
-			b_primes_array,
-			std::bind(
-				&DivisorsCounter::factorize_cb,
-				this,
-				std::placeholders::_1,
-				std::placeholders::_2
-			)
-		) {}
+	DivisorsCounter(primes_array_type b_primes_array) : factorizer(b_primes_array) {}
 	
 private:
 	bool factorize_cb(typename factorizer_type::num_type prime, typename factorizer_type::exp_type exp) {
@@ -231,17 +337,20 @@ public:
 		assert(n > 0);
 		if (n == 1) return 1;
 		count = 1;
-		factorizer.factorize(n);
+		factorizer.factorize(n, [this] (num_type prime, typename factorizer_type::exp_type exp) -> bool {
+			return factorize_cb(prime, exp);
+		});
 		return count;
 	}
 };
 
-template <typename NUM_TYPE>
+// FACTORIZER_TYPE - Factorizer or other class with the same interface
+template <typename NUM_TYPE, typename FACTORIZER_TYPE = Factorizer<NUM_TYPE> >
 class SumOfTwoSquaresChecker {
 public:
 	typedef NUM_TYPE num_type;
 private:
-	typedef Factorizer<num_type> factorizer_type;
+	typedef FACTORIZER_TYPE factorizer_type;
 public:
 	typedef typename factorizer_type::primes_array_type primes_array_type;
 	
@@ -254,16 +363,7 @@ private:
 	SumOfTwoSquaresChecker& operator=(const SumOfTwoSquaresChecker &b) = delete;
 	
 public:
-	SumOfTwoSquaresChecker(primes_array_type b_primes_array) :
-		factorizer(
-			b_primes_array,
-			std::bind(
-				&SumOfTwoSquaresChecker::factorize_cb,
-				this,
-				std::placeholders::_1,
-				std::placeholders::_2
-			)
-		) {}
+	SumOfTwoSquaresChecker(primes_array_type b_primes_array) : factorizer(b_primes_array) {}
 	
 private:
 	// Theorem:
@@ -283,9 +383,58 @@ public:
 	bool is_sum_of_two_squares(num_type n) {
 		if (n <= 1) return true;
 		result = true;
-		factorizer.factorize(n);
+		factorizer.factorize(n, [this] (num_type prime, typename factorizer_type::exp_type exp) -> bool {
+			return factorize_cb(prime, exp);
+		});
+		return result;
+	}
+};
+
+// Factorization of small n by trial division, it may be done at compile time:
+//     static constexpr SmallFactors<uint_fast32_t, 9> factors(360360);
+// prime powers are in ascending order of primes, MAX_POW_COUNT - enough for n
+template <typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT>
+struct SmallFactors {
+	typedef NUM_TYPE num_type;
+	typedef uint_fast8_t exp_type;
+	typedef uint_fast8_t pow_count_type;
+
+	num_type primes[MAX_POW_COUNT];
+	exp_type exps[MAX_POW_COUNT];
+	pow_count_type pow_count;
+
+	// n > 0
+	constexpr SmallFactors(num_type n) : primes(), exps(), pow_count(0) {
+		assert(n > 0);
+		for (num_type d=2; d<=n/d; d+=(d == 2 ? 1 : 2)) {
+			if (n % d) continue;
+			assert(pow_count < MAX_POW_COUNT);
+			primes[pow_count] = d;
+			do {
+				n /= d;
+				++exps[pow_count];
+			} while (n % d == 0);
+			++pow_count;
+		}
+		if (n > 1) {
+			assert(pow_count < MAX_POW_COUNT);
+			primes[pow_count] = n;
+			exps[pow_count] = 1;
+			++pow_count;
+		}
+	}
+
+	constexpr num_type value() const {
+		num_type result = 1;
+		for (pow_count_type i=0; i<pow_count; ++i) {
+			for (exp_type j=0; j<exps[i]; ++j) result *= primes[i];
+		}
 		return result;
 	}
+
+	constexpr bool is_prime() const {
+		return pow_count == 1 && exps[0] == 1;
+	}
 };
 
 #endif/*FACTORIZE_H*/
@@ -0,0 +1,137 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "factorize.h"
+#include "simd_trial_division.h"
+
+typedef Factorizer<uint_fast64_t> fzr_type;
+typedef fzr_type::num_type num_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// primes just above from: trial division runs through all primes up to sqrt(from)
+std::vector<num_type> get_bench_numbers(size_t count, num_type from) {
+	std::vector<num_type> numbers;
+	PrimesSieve<num_type> sieve;
+	sieve.for_each_prime(from, UINT64_MAX, [&] (num_type p) -> bool {
+		numbers.push_back(p);
+		return numbers.size() == count;
+	});
+	return numbers;
+}
+
+template <typename FACTORIZER_TYPE>
+void bench_factorizer(const char *name, const FACTORIZER_TYPE &factorizer, const std::vector<num_type> &numbers, double divisions) {
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		factorizer.factorize(numbers[i], [&sum] (num_type prime, typename FACTORIZER_TYPE::exp_type exp) -> bool {
+			sum += prime * exp;
+			return false;
+		});
+	}
+	double t = get_time() - t0;
+	assert(sum == std::accumulate(numbers.begin(), numbers.end(), (num_type)0));
+	printf("%-24s %8.3f ms, %7.1f M divisions/s\n", name, t * 1e3, divisions / t * 1e-6);
+}
+
+// DIVISION - wheel_division or sieve_division of Factorizer
+template <typename DIVISION>
+void bench_tail_division(const char *name, DIVISION division, const std::vector<num_type> &numbers, double divisions) {
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		num_type n = numbers[i];
+		division(n, [&sum] (num_type prime, fzr_type::exp_type exp) -> bool {
+			sum += prime * exp;
+			return false;
+		});
+		if (n != 1) sum += n;
+	}
+	double t = get_time() - t0;
+	assert(sum == std::accumulate(numbers.begin(), numbers.end(), (num_type)0));
+	printf("%-24s %8.3f ms, %7.1f M candidates/s\n", name, t * 1e3, divisions / t * 1e-6);
+}
+
+// former fallback of Factorizer: all odd numbers
+void bench_odd_numbers(const std::vector<num_type> &numbers, double divisions) {
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		num_type n = numbers[i];
+		num_type n_sqrt = round(sqrt((double)n));
+		for (num_type p=3; p<=n_sqrt; p+=2) {
+			if (!(n % p)) {
+				do {n /= p;} while (!(n % p));
+				n_sqrt = round(sqrt((double)n));
+			}
+		}
+		sum += n;
+	}
+	double t = get_time() - t0;
+	assert(sum == std::accumulate(numbers.begin(), numbers.end(), (num_type)0));
+	printf("%-24s %8.3f ms, %7.1f M candidates/s\n", "odd numbers", t * 1e3, divisions / t * 1e-6);
+}
+
+int main() {
+	// pi(2^20) = 82025
+	const size_t primes_size = 82025;
+	std::vector<num_type> primes(primes_size);
+	std::vector<fzr_type::prime_inverse_type> inverses(primes_size);
+	size_t primes_count = fzr_type::fill_primes(primes.data(), primes_size, (num_type)1 << 20);
+	assert(primes_count == primes_size);
+	fzr_type::primes_array_type::fill_inverses(primes.data(), primes_count, inverses.data());
+
+	std::vector<num_type> numbers = get_bench_numbers(1000, (num_type)1 << 40);
+	const double table_divisions = (double)numbers.size() * (primes_count - 1);
+	// 8 of 30 numbers are tested by mod 30 wheel, 15 of 30 without it
+	const double wheel_divisions = (double)numbers.size() * ((1 << 20) * 8 / 30);
+	const double odd_divisions = (double)numbers.size() * ((1 << 20) / 2);
+
+	printf("n > 2^40, 64-bit lanes\n");
+	bench_factorizer("primes table, division", fzr_type(fzr_type::primes_array_type(primes.data(), primes_count)), numbers, table_divisions);
+	bench_factorizer("primes table, inverses", fzr_type(fzr_type::primes_array_type(primes.data(), primes_count, inverses.data())), numbers, table_divisions);
+	typedef SimdFactorizer<num_type> simd_fzr_type;
+	simd_fzr_type::simd_table_type simd_table(primes.data(), primes_count);
+	const SimdTrialDivision::isa_type all_isa[] = {SimdTrialDivision::ISA_SCALAR, SimdTrialDivision::ISA_AVX2, SimdTrialDivision::ISA_AVX512};
+	for (size_t i=0; i<sizeof(all_isa)/sizeof(all_isa[0]); ++i) {
+		char name[64];
+		snprintf(name, sizeof(name), "inverses table, %s", SimdTrialDivision::isa_name(all_isa[i]));
+		if (!SimdTrialDivision::is_supported(all_isa[i])) {
+			printf("%-24s is not supported\n", name);
+			continue;
+		}
+		simd_table.set_isa(all_isa[i]);
+		bench_factorizer(name, simd_fzr_type(simd_fzr_type::primes_array_type(&simd_table, fzr_type::primes_array_type(primes.data(), primes_count))), numbers, table_divisions);
+	}
+	// numbers < 2^32 are tested by 32-bit lanes
+	std::vector<num_type> numbers32 = get_bench_numbers(1000, (num_type)1 << 31);
+	const size_t primes_count32 = std::upper_bound(primes.begin(), primes.end(), (num_type)1 << 16) - primes.begin();
+	const double table_divisions32 = (double)numbers32.size() * (primes_count32 - 1);
+	printf("\nn < 2^32, 32-bit lanes\n");
+	bench_factorizer("primes table, inverses", fzr_type(fzr_type::primes_array_type(primes.data(), primes_count, inverses.data())), numbers32, table_divisions32);
+	for (size_t i=0; i<sizeof(all_isa)/sizeof(all_isa[0]); ++i) {
+		if (!SimdTrialDivision::is_supported(all_isa[i])) continue;
+		char name[64];
+		snprintf(name, sizeof(name), "inverses table, %s", SimdTrialDivision::isa_name(all_isa[i]));
+		simd_table.set_isa(all_isa[i]);
+		bench_factorizer(name, simd_fzr_type(simd_fzr_type::primes_array_type(&simd_table, fzr_type::primes_array_type(primes.data(), primes_count))), numbers32, table_divisions32);
+	}
+	printf("\nwithout primes table\n");
+	bench_factorizer("primes iterator", fzr_type(fzr_type::primes_array_type()), numbers, wheel_divisions);
+	bench_tail_division("mod 30 wheel", [] (num_type &n, std::function<bool(num_type, fzr_type::exp_type)> cb) {
+		fzr_type::wheel_division(n, 1, UINT64_MAX, cb);
+	}, numbers, wheel_divisions);
+	bench_odd_numbers(numbers, odd_divisions);
+	return 0;
+}
@@ -4,11 +4,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include "factorize.h"
-
-void test_round_sqrt() {
-	typedef Factorizer<uint_fast64_t> fzr_type;
-	fzr_type::test_round_sqrt();
-}
+#include "uint128.h"
 
 struct MyPow {
 	uint_fast64_t prime;
@@ -180,6 +176,207 @@ void test_factorize_with_primes_array() {
 	}
 }
 
+void test_prime_inverse() {
+	typedef PrimeInverse<uint_fast64_t> pi64_type;
+	typedef PrimeInverse<uint16_t> pi16_type;
+	for (uint_fast64_t p=1; p<1024*4; p+=2) {
+		pi64_type pi64(p);
+		assert(p * pi64.inverse == 1);
+		pi16_type pi16(p);
+		assert((uint16_t)(p * pi16.inverse) == 1);
+		for (uint_fast64_t n=0; n<1024*4; ++n) {
+			uint_fast64_t n64 = n;
+			assert(pi64.divide(n64) == (n % p == 0));
+			assert(n64 == (n % p == 0 ? n / p : n));
+			uint16_t n16 = n;
+			assert(pi16.divide(n16) == (n % p == 0));
+			assert(n16 == (n % p == 0 ? n / p : n));
+		}
+	}
+}
+
+void test_factorize_with_inverses() {
+	typedef Factorizer<uint_fast64_t> fzr_type;
+	
+	fzr_type::num_type primes[1024];
+	fzr_type::prime_inverse_type inverses[1024];
+	size_t primes_count = fzr_type::fill_primes(primes, 1024, UINT64_MAX);
+	fzr_type::primes_array_type::fill_inverses(primes, primes_count, inverses);
+	
+	MyFactors factors;
+	auto cb = [&factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+		factors.pows[factors.pow_count].prime = prime;
+		factors.pows[factors.pow_count].exp = exp;
+		++factors.pow_count;
+		return false;
+	};
+	
+	// table ends at 3, 5, 7, 11 and 8161: wheel continues after it
+	const size_t counts[] = {0, 1, 2, 3, 4, 5, 1024};
+	for (size_t c=0; c<sizeof(counts)/sizeof(counts[0]); ++c) {
+		fzr_type factorizer(fzr_type::primes_array_type(primes, counts[c], inverses));
+		for (fzr_type::num_type i=1; i<=1024*64+1; ++i) {
+			factors.pow_count = 0;
+			factorizer.factorize(i, cb);
+			MyFactors my_factors = my_factorize(i);
+			assert(factors.pow_count == my_factors.pow_count);
+			for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+				assert(factors.pows[j].prime == my_factors.pows[j].prime);
+				assert(factors.pows[j].exp == my_factors.pows[j].exp);
+			}
+		}
+	}
+	
+	// cofactor above the table
+	fzr_type factorizer(fzr_type::primes_array_type(primes, primes_count, inverses));
+	factors.pow_count = 0;
+	factorizer.factorize(8161ULL * 8161ULL * 65521ULL * 65537ULL, cb);
+	assert(factors.pow_count == 3);
+	assert(factors.pows[0].prime == 8161 && factors.pows[0].exp == 2);
+	assert(factors.pows[1].prime == 65521 && factors.pows[1].exp == 1);
+	assert(factors.pows[2].prime == 65537 && factors.pows[2].exp == 1);
+}
+
+void test_tail_division() {
+	typedef Factorizer<uint_fast64_t> fzr_type;
+	
+	MyFactors factors;
+	auto cb = [&factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+		factors.pows[factors.pow_count].prime = prime;
+		factors.pows[factors.pow_count].exp = exp;
+		++factors.pow_count;
+		return false;
+	};
+	
+	// odd numbers without prime factors <= last, prime factors are far above SIEVE_DIVISION_MIN_RANGE
+	const fzr_type::num_type numbers[] = {
+		1000003ULL * 1000033ULL, 1000003ULL * 1000003ULL * 1000037ULL, 4194301ULL * 4194319ULL * 7,
+		999999937ULL, 4294967291ULL * 3 * 3, 1000003ULL * 999999937ULL, 65537ULL * 16777213ULL
+	};
+	const fzr_type::num_type lasts[] = {1, 3, 5, 7, 29, 31};
+	for (size_t i=0; i<sizeof(numbers)/sizeof(numbers[0]); ++i) {
+		MyFactors my_factors = my_factorize(numbers[i]);
+		for (size_t j=0; j<sizeof(lasts)/sizeof(lasts[0]); ++j) {
+			// the first prime factor is > last
+			if (my_factors.pows[0].prime <= lasts[j]) continue;
+			for (uint_fast8_t method=0; method<3; ++method) {
+				fzr_type::num_type n = numbers[i];
+				factors.pow_count = 0;
+				bool is_interrupted = (
+					method == 0 ? fzr_type::wheel_division(n, lasts[j], UINT64_MAX, cb) :
+					method == 1 ? fzr_type::sieve_division(n, lasts[j], UINT64_MAX, cb) :
+					fzr_type::tail_division(n, lasts[j], UINT64_MAX, cb)
+				);
+				assert(!is_interrupted);
+				if (n != 1) cb(n, 1);
+				assert(factors.pow_count == my_factors.pow_count);
+				for (uint_fast8_t k=0; k<factors.pow_count; ++k) {
+					assert(factors.pows[k].prime == my_factors.pows[k].prime);
+					assert(factors.pows[k].exp == my_factors.pows[k].exp);
+				}
+			}
+		}
+	}
+	
+	// bounded division leaves cofactor without prime factors <= bound
+	fzr_type::num_type n = 1000003ULL * 1000033ULL;
+	factors.pow_count = 0;
+	assert(!fzr_type::sieve_division(n, 1, 1000020, cb));
+	assert(factors.pow_count == 1 && factors.pows[0].prime == 1000003 && n == 1000033);
+	
+	// interruption
+	n = 1000003ULL * 1000033ULL;
+	assert(fzr_type::sieve_division(n, 1, UINT64_MAX, [] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+		(void)prime;
+		(void)exp;
+		return true;
+	}));
+}
+
+// Factorizer<uint128_t> finds the same factors as 64-bit one and factors beyond 64 bits
+void test_factorize_128() {
+	typedef Factorizer<uint128_t> fzr_type;
+	
+	fzr_type::num_type primes[1024];
+	fzr_type::prime_inverse_type inverses[1024];
+	size_t primes_count = fzr_type::fill_primes(primes, 1024, UINT64_MAX);
+	assert(primes_count == 1024 && primes[1023] == 8161);
+	fzr_type::primes_array_type::fill_inverses(primes, primes_count, inverses);
+	for (size_t i=1; i<primes_count; ++i) assert(primes[i] * inverses[i].inverse == 1);
+	
+	MyFactors factors;
+	auto cb = [&factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+		factors.pows[factors.pow_count].prime = (uint_fast64_t)prime;
+		factors.pows[factors.pow_count].exp = exp;
+		++factors.pow_count;
+		return false;
+	};
+	
+	const size_t counts[] = {0, 1024};
+	for (size_t c=0; c<sizeof(counts)/sizeof(counts[0]); ++c) {
+		fzr_type factorizer(fzr_type::primes_array_type(primes, counts[c], (counts[c] > 0 ? inverses : NULL)));
+		for (fzr_type::num_type i=1; i<=1024*16+1; ++i) {
+			factors.pow_count = 0;
+			factorizer.factorize(i, cb);
+			MyFactors my_factors = my_factorize((uint_fast64_t)i);
+			assert(factors.pow_count == my_factors.pow_count);
+			for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+				assert(factors.pows[j].prime == my_factors.pows[j].prime);
+				assert(factors.pows[j].exp == my_factors.pows[j].exp);
+			}
+		}
+		
+		// 2^30 * 3^5 * 1000003^2 * (2^40 + 15) > 2^117, cofactor is found by sieve division
+		const fzr_type::num_type n = ((fzr_type::num_type)1 << 30) * 243 * 1000003ULL * 1000003ULL * 1099511627791ULL;
+		factors.pow_count = 0;
+		factorizer.factorize(n, cb);
+		assert(factors.pow_count == 4);
+		assert(factors.pows[0].prime == 2 && factors.pows[0].exp == 30);
+		assert(factors.pows[1].prime == 3 && factors.pows[1].exp == 5);
+		assert(factors.pows[2].prime == 1000003 && factors.pows[2].exp == 2);
+		assert(factors.pows[3].prime == 1099511627791ULL && factors.pows[3].exp == 1);
+		
+		// 2^127 and 3^40 * (2^61 - 1) > 2^124
+		factors.pow_count = 0;
+		factorizer.factorize((fzr_type::num_type)1 << 127, cb);
+		assert(factors.pow_count == 1 && factors.pows[0].prime == 2 && factors.pows[0].exp == 127);
+		fzr_type::num_type m = 1;
+		for (int i=0; i<40; ++i) m *= 3;
+		factors.pow_count = 0;
+		factorizer.factorize(m * (((fzr_type::num_type)1 << 61) - 1), [&factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+			factors.pows[factors.pow_count].prime = (uint_fast64_t)prime;
+			factors.pows[factors.pow_count].exp = exp;
+			++factors.pow_count;
+			// don't try to divide prime 2^61 - 1
+			return true;
+		});
+		assert(factors.pow_count == 1 && factors.pows[0].prime == 3 && factors.pows[0].exp == 40);
+	}
+}
+
+void test_small_factors() {
+	typedef SmallFactors<uint_fast32_t, 10> factors_type;
+	// evaluated at compile time
+	static constexpr factors_type factors_360360(360360);
+	static_assert(factors_360360.pow_count == 6 && factors_360360.primes[0] == 2 && factors_360360.exps[0] == 3, "360360 == 2^3 * 3^2 * 5 * 7 * 11 * 13");
+	static_assert(factors_360360.primes[5] == 13 && factors_360360.value() == 360360, "360360 == 2^3 * 3^2 * 5 * 7 * 11 * 13");
+	static_assert(factors_type(65521).is_prime() && !factors_type(65536).is_prime() && factors_type(1).pow_count == 0, "small primes");
+	static_assert(factors_type(4294967291U).is_prime(), "the largest 32-bit prime");
+	static_assert(factors_type(4294967295U).pow_count == 5, "2^32 - 1 == 3 * 5 * 17 * 257 * 65537");
+
+	// the same as my_factorize
+	for (uint_fast32_t n=1; n<=1024*64; ++n) {
+		const factors_type factors(n);
+		MyFactors my_factors = my_factorize(n);
+		assert(factors.pow_count == my_factors.pow_count);
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(factors.primes[j] == my_factors.pows[j].prime);
+			assert(factors.exps[j] == my_factors.pows[j].exp);
+		}
+		assert(factors.value() == n);
+	}
+}
+
 void test_prime_checker() {
 	typedef PrimeChecker<uint_fast64_t> prime_checker_type;
 	// pi(2^16) = 6542
@@ -243,11 +440,15 @@ void test_divisors_count() {
 }
 
 void tests_suite() {
-	test_round_sqrt();
 	test_factorize();
 	test_sum_of_two_squares();
 	test_fill_primes();
 	test_factorize_with_primes_array();
+	test_prime_inverse();
+	test_factorize_with_inverses();
+	test_tail_division();
+	test_factorize_128();
+	test_small_factors();
 	test_prime_checker();
 	test_divisors_count();
 }
@@ -0,0 +1,86 @@
+#ifndef FIXED_BASE_POW_H
+#define FIXED_BASE_POW_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include "mul_mod.h"
+
+// Powers of one base g by one modulus, Lim and Lee's comb:
+// exp of at most exp_bits bits is split into TEETH teeth of a = ceil(exp_bits / TEETH) bits,
+// table[i] == g^(sum of 2^(j * a) by set bits j of i) is precalculated once (2^TEETH entries),
+// then g^exp costs a squares and a products instead of exp_bits squares and products of sliding window.
+// MOD_CONTEXT_TYPE - MulModContext or other class with the same interface
+template <typename MOD_CONTEXT_TYPE, uint_fast8_t TEETH = 8>
+class FixedBasePow {
+public:
+	typedef MOD_CONTEXT_TYPE mod_context_type;
+	typedef typename mod_context_type::num_type num_type;
+	static_assert(TEETH > 0 && TEETH <= 12, "TEETH is out of range");
+	static constexpr size_t TABLE_SIZE = (size_t)1 << TEETH;
+	static constexpr uint_fast8_t NUM_BITS = UnsignedOps<num_type>::BITS;
+
+private:
+	mod_context_type context;
+	num_type base;
+	uint_fast8_t exp_bits;
+	// bits of one tooth
+	uint_fast8_t tooth_bits;
+	// in form of context
+	num_type table[TABLE_SIZE];
+
+public:
+	// b_base - ordinary residue
+	// b_exp_bits - max bits of exps, bits of group order is enough
+	// constexpr, so table of base and modulus known at compile time is built at compile time
+	constexpr FixedBasePow(const mod_context_type &b_context, num_type b_base, uint_fast8_t b_exp_bits = NUM_BITS) :
+		context(b_context), base(b_base), exp_bits(b_exp_bits), tooth_bits(0), table()
+	{
+		assert(exp_bits > 0 && exp_bits <= NUM_BITS);
+		tooth_bits = (uint_fast8_t)((exp_bits + TEETH - 1) / TEETH);
+		table[0] = context.one();
+		// g^(2^(j * a))
+		num_type g = context.to_form(base);
+		for (uint_fast8_t j=0; j<TEETH; ++j) {
+			table[(size_t)1 << j] = g;
+			for (uint_fast8_t k=0; k<tooth_bits; ++k) g = context.square(g);
+		}
+		for (size_t i=3; i<TABLE_SIZE; ++i) {
+			const size_t low = i & (0 - i);
+			if (i != low) table[i] = context.mul(table[i - low], table[low]);
+		}
+	}
+
+	// use default copy constructor and assignment operator
+
+	constexpr num_type get_base() const {
+		return base;
+	}
+
+	constexpr uint_fast8_t get_exp_bits() const {
+		return exp_bits;
+	}
+
+	// base^exp in form of context, exp < 2^exp_bits
+	constexpr num_type pow(num_type exp) const {
+		assert(exp_bits == NUM_BITS || (exp >> exp_bits) == 0);
+		num_type result = context.one();
+		for (int_fast16_t k=tooth_bits-1; k>=0; --k) {
+			size_t idx = 0;
+			for (uint_fast8_t j=0; j<TEETH; ++j) {
+				const uint_fast16_t bit = j * tooth_bits + k;
+				if (bit < NUM_BITS) idx |= (size_t)((exp >> bit) & 1) << j;
+			}
+			if (k != tooth_bits - 1) result = context.square(result);
+			if (idx != 0) result = context.mul(result, table[idx]);
+		}
+		return result;
+	}
+
+	// base^exp as ordinary residue
+	constexpr num_type pow_mod(num_type exp) const {
+		return context.from_form(pow(exp));
+	}
+};
+
+#endif/*FIXED_BASE_POW_H*/
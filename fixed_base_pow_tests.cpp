@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <random>
+#include "fixed_base_pow.h"
+#include "mul_mod.h"
+#include "montgomery.h"
+#include "barrett.h"
+#include "uint128.h"
+
+typedef MulMod<uint64_t, ((uint64_t)1)<<63, uint128_t> mul_mod64_type;
+
+// the same powers as of MulMod by random moduli and bases, exps of every bits count
+template <typename CONTEXT_TYPE, uint_fast8_t TEETH>
+void check_powers(bool is_odd) {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+	typedef FixedBasePow<context_type, TEETH> fbp_type;
+	typedef typename context_type::mul_mod_type mul_mod_type;
+	std::mt19937_64 rng(1);
+	for (uint_fast16_t i=0; i<256; ++i) {
+		num_type n = (num_type)rng() >> (rng() % (fbp_type::NUM_BITS - 2));
+		n = (is_odd ? n | 1 : n & ~(num_type)1);
+		if (n < 3) n = 3 + !is_odd;
+		const num_type g = (num_type)rng() % n;
+		const context_type context(n);
+		const uint_fast8_t exp_bits = (uint_fast8_t)(1 + i % fbp_type::NUM_BITS);
+		const fbp_type fbp(context, g, exp_bits);
+		assert(fbp.get_base() == g && fbp.get_exp_bits() == exp_bits);
+		assert(fbp.pow_mod(0) == 1);
+		for (uint_fast16_t j=0; j<64; ++j) {
+			const num_type exp = (num_type)rng() >> (fbp_type::NUM_BITS - exp_bits);
+			assert(fbp.pow_mod(exp) == mul_mod_type::pow_mod(n, g, exp));
+			assert(context.from_form(fbp.pow(exp)) == context.pow_mod(g, exp));
+		}
+		// all bits set
+		const num_type max_exp = (num_type)(~(num_type)0) >> (fbp_type::NUM_BITS - exp_bits);
+		assert(fbp.pow_mod(max_exp) == mul_mod_type::pow_mod(n, g, max_exp));
+	}
+}
+
+// sliding window of WindowPow against square-and-multiply, exps of every bits count
+void test_window_pow() {
+	std::mt19937_64 rng(2);
+	for (uint_fast16_t i=0; i<4096; ++i) {
+		const uint64_t n = (rng() >> (rng() % 62)) | 2;
+		const uint64_t a = rng() % n, exp = rng() >> (i % 64);
+		uint64_t expected = 1 % n;
+		for (int_fast16_t k=63; k>=0; --k) {
+			expected = (uint64_t)((uint128_t)expected * expected % n);
+			if ((exp >> k) & 1) expected = (uint64_t)((uint128_t)expected * a % n);
+		}
+		assert(mul_mod64_type::pow_mod(n, a, exp) == expected);
+		// not reduced base
+		assert(mul_mod64_type::pow_mod(n, a + n, exp) == expected || a + n < a);
+	}
+	for (uint64_t n=2; n<64; ++n) {
+		for (uint64_t a=0; a<2*n; ++a) {
+			assert(mul_mod64_type::pow_mod(n, a, 0) == 1);
+			assert(mul_mod64_type::pow_mod(n, a, 1) == a % n);
+		}
+	}
+}
+
+// Fermat's little theorem at compile time
+void test_constexpr() {
+	typedef FixedMulModContext<uint32_t, 4294967291U, ((uint32_t)1)<<31, uint64_t> context_type;
+	static constexpr FixedBasePow<context_type, 4> fbp(context_type(), 3, 32);
+	static_assert(fbp.pow_mod(4294967290U) == 1, "3^(p-1) == 1");
+	static_assert(fbp.pow_mod(2147483645U) == 1, "3 is residue, (3 / p) == -(p / 3) == 1");
+	static_assert(mul_mod64_type::pow_mod(0xffffffffffffffc5ULL, 5, 0xffffffffffffffc4ULL) == 1, "5^(p-1) == 1");
+}
+
+int main() {
+	test_window_pow();
+	check_powers<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>, 8>(true);
+	check_powers<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>, 5>(false);
+	check_powers<MontgomeryContext<uint64_t, ((uint64_t)1)<<63, uint128_t>, 8>(true);
+	check_powers<BarrettContext<uint64_t, ((uint64_t)1)<<63, uint128_t>, 8>(false);
+	check_powers<MontgomeryContext<uint32_t, ((uint32_t)1)<<31, uint64_t>, 1>(true);
+	check_powers<BarrettContext<uint32_t, ((uint32_t)1)<<31, uint64_t>, 3>(false);
+	test_constexpr();
+	return 0;
+}
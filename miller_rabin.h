@@ -0,0 +1,212 @@
+#ifndef MILLER_RABIN_H
+#define MILLER_RABIN_H
+
+#include <assert.h>
+#include <stdint.h>
+#include "factorize.h"
+#include "mul_mod.h"
+
+// Miller-Rabin primality test, deterministic for n < 3.3 * 10^24 (> 2^81),
+// numbers above that (num_type uint128_t) pass 13 strong probable prime tests and strong Lucas test
+// (Baillie-PSW, no counterexample is known), so factorizers don't take spsp to the 13 bases for primes
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class MillerRabin {
+public:
+	typedef NUM_TYPE num_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	static_assert(sizeof(num_type) <= 16, "Too big num_type for witnesses");
+
+private:
+	// trial division prefilter
+	static constexpr uint_fast8_t SMALL_PRIMES_COUNT = 15;
+	static constexpr uint_fast16_t SMALL_PRIMES_BOUND = 53;
+
+	static uint_fast8_t small_prime(uint_fast8_t idx) {
+		static const uint8_t small_primes[SMALL_PRIMES_COUNT] = {
+			2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47
+		};
+		return small_primes[idx];
+	}
+
+	static num_type add_mod(num_type n, num_type a, num_type b) {
+		return (a >= n - b ? a - (n - b) : a + b);
+	}
+
+	static num_type sub_mod(num_type n, num_type a, num_type b) {
+		return (a >= b ? a - b : a + (n - b));
+	}
+
+	// a / 2 modulo odd n
+	static num_type half_mod(num_type n, num_type a) {
+		return (a >> 1) + (a & 1 ? (n >> 1) + 1 : 0);
+	}
+
+	// a modulo n of signed a
+	static num_type to_residue(num_type n, int_fast64_t a) {
+		const num_type r = (num_type)(a < 0 ? -a : a) % n;
+		return (a >= 0 || r == 0 ? r : n - r);
+	}
+
+public:
+	// n - odd, n > 2
+	// n-1 == d * 2^s, d - odd
+	static bool is_strong_probable_prime(num_type n, num_type base, num_type d, uint_fast8_t s) {
+		base %= n;
+		if (base == 0) return true;
+		num_type x = mul_mod_type::pow_mod(n, base, d);
+		if (x == 1 || x == n - 1) return true;
+		for (uint_fast8_t r=1; r<s; ++r) {
+			x = mul_mod_type::square_mod(n, x);
+			if (x == n - 1) return true;
+		}
+		return false;
+	}
+
+	// n - odd, n > 2
+	static bool is_strong_probable_prime(num_type n, num_type base) {
+		assert(n > 2 && (n & 1));
+		num_type d = n - 1;
+		uint_fast8_t s = 0;
+		do {
+			d >>= 1;
+			++s;
+		} while (!(d & 1));
+		return is_strong_probable_prime(n, base, d, s);
+	}
+
+	// Jacobi symbol (a/n), n - odd
+	static int_fast8_t jacobi(num_type a, num_type n) {
+		assert(n & 1);
+		a %= n;
+		int_fast8_t result = 1;
+		while (a != 0) {
+			while (!(a & 1)) {
+				a >>= 1;
+				if ((n & 7) == 3 || (n & 7) == 5) result = -result;
+			}
+			const num_type t = a;
+			a = n;
+			n = t;
+			if ((a & 3) == 3 && (n & 3) == 3) result = -result;
+			a %= n;
+		}
+		return (n == 1 ? result : 0);
+	}
+
+	// strong Lucas probable prime test with Selfridge's parameters P == 1, Q == (1 - D) / 4,
+	// D - the first of 5, -7, 9, -11, ... with (D/n) == -1
+	// n - odd, n > 2
+	static bool is_strong_lucas_probable_prime(num_type n) {
+		assert(n > 2 && (n & 1));
+		// no D for squares
+		const num_type root = UnsignedOps<num_type>::isqrt(n);
+		if (root * root == n) return false;
+		int_fast64_t d_sel = 5;
+		while (true) {
+			const int_fast8_t j = jacobi(to_residue(n, d_sel), n);
+			if (j == -1) break;
+			const num_type d_abs = (num_type)(d_sel < 0 ? -d_sel : d_sel);
+			if (j == 0 && d_abs != n) return false;
+			d_sel = (d_sel > 0 ? -(d_sel + 2) : -d_sel + 2);
+		}
+		const num_type d = to_residue(n, d_sel), q = to_residue(n, (1 - d_sel) / 4);
+		// n + 1 == k * 2^s, k - odd
+		num_type k = n + 1;
+		uint_fast8_t s = 0;
+		do {
+			k >>= 1;
+			++s;
+		} while (!(k & 1));
+		// U_1, V_1, Q^1
+		num_type u = 1, v = 1, qk = q;
+		for (int_fast16_t i=UnsignedOps<num_type>::BITS-UnsignedOps<num_type>::clz(k)-2; i>=0; --i) {
+			// U_2m == U_m * V_m, V_2m == V_m^2 - 2 * Q^m
+			u = mul_mod_type::mul_mod(n, u, v);
+			v = sub_mod(n, mul_mod_type::square_mod(n, v), add_mod(n, qk, qk));
+			qk = mul_mod_type::square_mod(n, qk);
+			if ((k >> i) & 1) {
+				// U_m+1 == (U_m + V_m) / 2, V_m+1 == (D * U_m + V_m) / 2
+				const num_type u1 = half_mod(n, add_mod(n, u, v));
+				v = half_mod(n, add_mod(n, mul_mod_type::mul_mod(n, d, u), v));
+				u = u1;
+				qk = mul_mod_type::mul_mod(n, qk, q);
+			}
+		}
+		if (u == 0 || v == 0) return true;
+		for (uint_fast8_t r=1; r<s; ++r) {
+			v = sub_mod(n, mul_mod_type::square_mod(n, v), add_mod(n, qk, qk));
+			if (v == 0) return true;
+			qk = mul_mod_type::square_mod(n, qk);
+		}
+		return false;
+	}
+
+	// n < 3317044064679887385961981, 13 bases are enough
+	static bool is_below_bases_bound(num_type n) {
+		const uint64_t n_high = UnsignedOps<num_type>::high64(n);
+		return n_high < 179817 || (n_high == 179817 && (uint64_t)n < 5885577656943027709ULL);
+	}
+
+	// count of bases of deterministic test of n: 3 for n < 2^32, 7 for n < 2^64, 13 above
+	static uint_fast8_t bases_count(num_type n) {
+		if (UnsignedOps<num_type>::high64(n) != 0) return 13;
+		return (((uint64_t)n >> 32) == 0 ? 3 : 7);
+	}
+
+	// Miller-Rabin test without prefilter, n - odd, n > 2
+	static bool miller_rabin(num_type n) {
+		assert(n > 2 && (n & 1));
+		num_type d = n - 1;
+		uint_fast8_t s = 0;
+		do {
+			d >>= 1;
+			++s;
+		} while (!(d & 1));
+		// Jaeschke: n < 4759123141
+		static const uint32_t bases_32[] = {2, 7, 61};
+		// Sinclair: n < 2^64
+		static const uint32_t bases_64[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+		// Sorenson, Webster: the first 13 primes, n < 3317044064679887385961981
+		static const uint32_t bases_128[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41};
+		const uint_fast8_t count = bases_count(n);
+		const uint32_t *bases = (count == 13 ? bases_128 : count == 3 ? bases_32 : bases_64);
+		for (uint_fast8_t i=0; i<count; ++i) {
+			if (!is_strong_probable_prime(n, bases[i], d, s)) return false;
+		}
+		return (is_below_bases_bound(n) || is_strong_lucas_probable_prime(n));
+	}
+
+	static bool is_prime(num_type n) {
+		for (uint_fast8_t i=0; i<SMALL_PRIMES_COUNT; ++i) {
+			num_type p = small_prime(i);
+			if (n == p) return true;
+			if (n % p == 0) return false;
+		}
+		if (n < SMALL_PRIMES_BOUND * SMALL_PRIMES_BOUND) return n > 1;
+		return miller_rabin(n);
+	}
+};
+
+// PrimeChecker replacement, primes array is not used
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class MillerRabinPrimeChecker {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimesArray<num_type> primes_array_type;
+private:
+	typedef MillerRabin<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> miller_rabin_type;
+
+public:
+	MillerRabinPrimeChecker() {}
+	MillerRabinPrimeChecker(primes_array_type b_primes_array) {
+		(void)b_primes_array;
+	}
+
+	bool is_prime(num_type n) const {
+		assert(n > 1);
+		return miller_rabin_type::is_prime(n);
+	}
+};
+
+#endif/*MILLER_RABIN_H*/
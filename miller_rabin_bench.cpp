@@ -0,0 +1,56 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <vector>
+#include "miller_rabin.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+template <typename CHECKER_TYPE>
+double bench_checker(CHECKER_TYPE &checker, typename CHECKER_TYPE::num_type from, size_t count, size_t &primes_count) {
+	typedef typename CHECKER_TYPE::num_type num_type;
+	primes_count = 0;
+	double t0 = get_time();
+	for (num_type n=from; n<from+count; ++n) {
+		if (checker.is_prime(n)) ++primes_count;
+	}
+	return get_time() - t0;
+}
+
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+void bench(const char *name, NUM_TYPE from, size_t count) {
+	typedef NUM_TYPE num_type;
+	typedef PrimesArray<num_type> primes_array_type;
+	// pi(2^20) = 82025, enough for trial division of n < 2^40
+	std::vector<num_type> primes(82025);
+	size_t primes_count = primes_array_type::fill_primes(primes.data(), primes.size(), 1 << 20);
+	primes_array_type primes_array(primes.data(), primes_count);
+
+	PrimeChecker<num_type> prime_checker(primes_array);
+	MillerRabinPrimeChecker<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mr_prime_checker(primes_array);
+	size_t count_td, count_mr;
+	double t_td = bench_checker(prime_checker, from, count, count_td);
+	double t_mr = bench_checker(mr_prime_checker, from, count, count_mr);
+	assert(count_td == count_mr);
+	printf(
+		"%s [%" PRIu64 ", +%zu): %zu primes, trial division %9.3f ms, Miller-Rabin %8.3f ms, speedup %.1fx\n",
+		name, (uint64_t)from, count, count_mr, t_td * 1e3, t_mr * 1e3, t_td / t_mr
+	);
+}
+
+int main() {
+	bench<uint32_t, ((uint32_t)1)<<31, uint64_t>("32-bit", 1000000, 1000000);
+	bench<uint32_t, ((uint32_t)1)<<31, uint64_t>("32-bit", UINT32_MAX - 1000000, 1000000);
+	bench<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t>("64-bit", UINT32_MAX - 1000000, 1000000);
+	bench<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t>("64-bit", 1000000000000ULL, 100000);
+	bench<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t>("64-bit", 1000000000000000ULL, 1000);
+	return 0;
+}
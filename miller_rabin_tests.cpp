@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <vector>
+#include "miller_rabin.h"
+#include "primes_sieve.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+typedef MillerRabin<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> mr64_type;
+typedef MillerRabin<uint32_t, ((uint32_t)1)<<31, uint64_t> mr32_type;
+typedef MillerRabin<uint128_t, ((uint128_t)1)<<127, uint128_t> mr128_type;
+
+// compare with sieve on [from, to]
+template <typename MR_TYPE>
+void check_interval(typename MR_TYPE::num_type from, typename MR_TYPE::num_type to) {
+	typedef typename MR_TYPE::num_type num_type;
+	PrimesSieve<num_type> sieve;
+	num_type n = from;
+	sieve.for_each_prime(from, to, [&] (num_type p) -> bool {
+		for (; n < p; ++n) assert(!MR_TYPE::is_prime(n));
+		assert(MR_TYPE::is_prime(n));
+		++n;
+		return false;
+	});
+	for (; n <= to && n >= from; ++n) assert(!MR_TYPE::is_prime(n));
+}
+
+void test_is_prime() {
+	check_interval<mr32_type>(0, 1024*1024);
+	check_interval<mr32_type>(UINT32_MAX - 1024*64, UINT32_MAX);
+	check_interval<mr64_type>(0, 1024*1024);
+	check_interval<mr64_type>((uint_fast64_t)UINT32_MAX - 1024*64, (uint_fast64_t)UINT32_MAX + 1024*64);
+	check_interval<mr64_type>(1000000000000ULL, 1000000000000ULL + 1024*64);
+	assert(mr64_type::is_prime(18446744073709551557ULL));		// largest 64-bit prime
+	assert(!mr64_type::is_prime(18446744073709551559ULL));
+	assert(!mr64_type::is_prime(UINT64_MAX));
+}
+
+void test_strong_pseudoprimes() {
+	// strong pseudoprimes to base 2
+	const uint_fast64_t spsp2[] = {2047, 3277, 4033, 4681, 8321, 15841, 29341, 42799, 49141, 52633};
+	for (size_t i=0; i<sizeof(spsp2)/sizeof(spsp2[0]); ++i) {
+		assert(mr64_type::is_strong_probable_prime(spsp2[i], 2));
+		assert(!mr64_type::miller_rabin(spsp2[i]));
+		assert(!mr32_type::miller_rabin(spsp2[i]));
+	}
+	// least strong pseudoprimes to several first prime bases
+	const uint_fast64_t spsp[] = {
+		3215031751ULL, 2152302898747ULL, 3474749660383ULL, 341550071728321ULL,
+		3825123056546413051ULL
+	};
+	for (size_t i=0; i<sizeof(spsp)/sizeof(spsp[0]); ++i) {
+		assert(!mr64_type::is_prime(spsp[i]));
+	}
+	// strong pseudoprime to bases 2, 7, 61 but > 2^32
+	assert(!mr64_type::is_prime(4759123141ULL));
+}
+
+void test_is_prime_128() {
+	check_interval<mr128_type>(0, 1024*64);
+	for (uint_fast64_t n=1000000000000ULL; n<1000000000000ULL + 1024*4; ++n) {
+		assert(mr128_type::is_prime(n) == mr64_type::is_prime(n));
+	}
+	// 2^k - 1 is prime for these k <= 127 only
+	const uint_fast8_t mersenne_exps[] = {2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127};
+	size_t idx = 0;
+	for (uint_fast8_t k=2; k<=127; ++k) {
+		const bool is_mersenne_prime = (idx < sizeof(mersenne_exps) && mersenne_exps[idx] == k);
+		if (is_mersenne_prime) ++idx;
+		assert(mr128_type::is_prime(((uint128_t)1 << k) - 1) == is_mersenne_prime);
+	}
+	// the least primes > 2^90 and > 2^100
+	const uint_fast8_t exps[] = {90, 100};
+	const uint_fast16_t deltas[] = {133, 277};
+	for (size_t i=0; i<sizeof(exps)/sizeof(exps[0]); ++i) {
+		const uint128_t p = ((uint128_t)1 << exps[i]) + deltas[i];
+		assert(mr128_type::is_prime(p));
+		for (uint128_t n=(uint128_t)1 << exps[i]; n<p; ++n) assert(!mr128_type::is_prime(n));
+	}
+	// products of 64-bit primes
+	const uint128_t p64 = 18446744073709551557ULL, q64 = 18446744073709551533ULL;
+	assert(!mr128_type::is_prime(p64 * p64));
+	assert(!mr128_type::is_prime(p64 * q64));
+	assert(!mr128_type::is_prime(p64 * 4294967291ULL));
+}
+
+// strong Lucas pseudoprimes < 10^5 (Selfridge's parameters) and the least spsp to the 13 bases
+void test_strong_lucas() {
+	const uint_fast32_t slpsp[] = {5459, 5777, 10877, 16109, 18971, 22499, 24569, 25199, 40309, 58519, 75077, 97439};
+	size_t idx = 0;
+	for (uint_fast32_t n=3; n<100000; n+=2) {
+		const bool is_slpsp = (idx < sizeof(slpsp) / sizeof(slpsp[0]) && slpsp[idx] == n);
+		if (is_slpsp) ++idx;
+		assert(mr64_type::is_strong_lucas_probable_prime(n) == (mr64_type::is_prime(n) || is_slpsp));
+		assert(mr128_type::is_strong_lucas_probable_prime(n) == mr64_type::is_strong_lucas_probable_prime(n));
+	}
+	assert(idx == sizeof(slpsp) / sizeof(slpsp[0]));
+	assert(mr64_type::jacobi(5, 9) == 1 && mr64_type::jacobi(2, 7) == 1 && mr64_type::jacobi(3, 7) == -1 && mr64_type::jacobi(6, 15) == 0);
+
+	// 3317044064679887385961981 passes Miller-Rabin by 2, 3, ..., 41
+	const uint128_t psi13 = ((uint128_t)179817 << 64) | 5885577656943027709ULL;
+	assert(!mr128_type::is_below_bases_bound(psi13) && mr128_type::is_below_bases_bound(psi13 - 2));
+	for (uint32_t base : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41}) assert(mr128_type::is_strong_probable_prime(psi13, base));
+	assert(!mr128_type::is_prime(psi13));
+	// primes above the bound: 2^89 - 1, 2^107 - 1, 2^127 - 1
+	for (uint_fast8_t k : {89, 107, 127}) assert(mr128_type::is_strong_lucas_probable_prime(((uint128_t)1 << k) - 1));
+}
+
+// bases by num_type: only n >= 2^64 takes 13 ones
+void test_bases_count() {
+	assert(UnsignedOps<uint32_t>::high64(UINT32_MAX) == 0);
+	assert(UnsignedOps<uint_fast64_t>::high64(UINT64_MAX) == 0);
+	assert(UnsignedOps<uint128_t>::high64((uint128_t)1 << 64) == 1);
+	assert(mr32_type::bases_count(UINT32_MAX) == 3);
+	assert(mr64_type::bases_count(UINT32_MAX) == 3);
+	assert(mr64_type::bases_count((uint_fast64_t)UINT32_MAX + 2) == 7);
+	assert(mr64_type::bases_count(UINT64_MAX) == 7);
+	assert(mr128_type::bases_count(UINT32_MAX) == 3);
+	assert(mr128_type::bases_count(UINT64_MAX) == 7);
+	assert(mr128_type::bases_count((uint128_t)UINT64_MAX + 2) == 13);
+	// the top of 32-bit range by 3 bases
+	check_interval<mr32_type>(UINT32_MAX - 1024*1024, UINT32_MAX);
+}
+
+template <typename CHECKER_TYPE>
+void check_prime_checker(CHECKER_TYPE &checker) {
+	typedef typename CHECKER_TYPE::num_type num_type;
+	PrimesSieve<num_type> sieve;
+	num_type n = 2;
+	sieve.for_each_prime(2, 65536, [&] (num_type p) -> bool {
+		for (; n < p; ++n) assert(!checker.is_prime(n));
+		assert(checker.is_prime(n));
+		++n;
+		return false;
+	});
+}
+
+void test_prime_checkers() {
+	typedef uint_fast64_t num_type;
+	typedef PrimesArray<num_type> primes_array_type;
+	num_type primes[6542];
+	size_t primes_count = primes_array_type::fill_primes(primes, 6542, 65536);
+	primes_array_type primes_array(primes, primes_count);
+
+	PrimeChecker<num_type> prime_checker(primes_array);
+	MillerRabinPrimeChecker<num_type, ((num_type)1)<<63, uint128_t> mr_prime_checker(primes_array);
+	check_prime_checker(prime_checker);
+	check_prime_checker(mr_prime_checker);
+}
+
+void tests_suite() {
+	test_is_prime();
+	test_strong_pseudoprimes();
+	test_is_prime_128();
+	test_bases_count();
+	test_strong_lucas();
+	test_prime_checkers();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
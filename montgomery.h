@@ -0,0 +1,102 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include <assert.h>
+#include <stdint.h>
+#include "mul_mod.h"
+
+// Montgomery's multiplication modulo odd n, it has the same interface as MulModContext.
+// Form of residue a is a * R mod n, R == 2 * NUM_TYPE_MAX_MASK,
+// product of forms is reduced by REDC: t * R^-1 mod n by two multiplications and shift instead of %.
+// OPERATION_TYPE must hold product of two values < R, so num_type uint128_t is not supported.
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class MontgomeryContext {
+public:
+	typedef NUM_TYPE num_type;
+	typedef OPERATION_TYPE operation_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+
+	// bits of R
+	static constexpr uint_fast8_t R_BITS = UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(NUM_TYPE_MAX_MASK);
+	static_assert(sizeof(operation_type) * 8 >= 2 * R_BITS, "OPERATION_TYPE doesn't hold product of two values < R");
+	static constexpr operation_type R_MASK = (((operation_type)1) << R_BITS) - 1;
+
+private:
+	num_type mod;
+	// mod^-1 mod R
+	num_type mod_inv;
+	// R mod n, form of 1
+	num_type r1;
+	// R^2 mod n
+	num_type r2;
+
+public:
+	constexpr MontgomeryContext() : mod(0), mod_inv(0), r1(0), r2(0) {}
+
+	constexpr explicit MontgomeryContext(num_type b_mod) : mod(0), mod_inv(0), r1(0), r2(0) {
+		assign(b_mod);
+	}
+
+	// use default copy constructor and assignment operator
+
+	// b_mod - odd, > 1, < R
+	constexpr void assign(num_type b_mod) {
+		assert(b_mod > 1 && (b_mod & 1));
+		assert((operation_type)b_mod <= R_MASK);
+		mod = b_mod;
+		// Newton's iteration, mod * mod == 1 (mod 8) and every step doubles correct bits count
+		operation_type inv = mod;
+		for (uint_fast8_t bits=3; bits<R_BITS; bits*=2) inv = (inv * (2 - ((mod * inv) & R_MASK))) & R_MASK;
+		mod_inv = (num_type)inv;
+		r1 = (num_type)((R_MASK % mod + 1) % mod);
+		r2 = (num_type)((operation_type)r1 * r1 % mod);
+	}
+
+	constexpr num_type get_modulus() const {
+		return mod;
+	}
+
+	// t * R^-1 mod n, t < n * R
+	constexpr num_type reduce(operation_type t) const {
+		// m * n == t (mod R), so t - m * n is divisible by R
+		const num_type m = (num_type)(((t & R_MASK) * mod_inv) & R_MASK);
+		const num_type t_high = (num_type)(t >> R_BITS);
+		const num_type mn_high = (num_type)(((operation_type)m * mod) >> R_BITS);
+		return (t_high >= mn_high ? t_high - mn_high : t_high + (mod - mn_high));
+	}
+
+	// a < R, so a * (R^2 mod n) < n * R
+	constexpr num_type to_form(num_type a) const {
+		assert((operation_type)a <= R_MASK);
+		return reduce((operation_type)a * r2);
+	}
+
+	constexpr num_type from_form(num_type a) const {
+		return reduce(a);
+	}
+
+	// form of 1
+	constexpr num_type one() const {
+		return r1;
+	}
+
+	constexpr num_type mul(num_type a, num_type b) const {
+		return reduce((operation_type)a * b);
+	}
+
+	constexpr num_type square(num_type a) const {
+		return reduce((operation_type)a * a);
+	}
+
+	// see WindowPow
+	constexpr num_type pow(num_type a, num_type exp) const {
+		return WindowPow<MontgomeryContext>::pow(*this, a, exp);
+	}
+
+	// a^exp of ordinary residue, a < R
+	constexpr num_type pow_mod(num_type a, num_type exp) const {
+		return from_form(pow(to_form(a), exp));
+	}
+};
+
+#endif/*MONTGOMERY_H*/
@@ -0,0 +1,90 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <random>
+#include "montgomery.h"
+#include "mul_mod.h"
+#include "uint128.h"
+
+typedef MontgomeryContext<uint32_t, ((uint32_t)1)<<31, uint64_t> mont32_type;
+typedef MontgomeryContext<uint64_t, ((uint64_t)1)<<63, uint128_t> mont64_type;
+
+// the same results as of MulMod and MulModContext for odd moduli < R
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+void check_context() {
+	typedef NUM_TYPE num_type;
+	typedef MontgomeryContext<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> context_type;
+	typedef MulModContext<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> plain_type;
+	typedef typename context_type::mul_mod_type mul_mod_type;
+	const num_type mask = NUM_TYPE_MAX_MASK | (NUM_TYPE_MAX_MASK - 1);
+	std::mt19937_64 rng(1);
+	for (uint_fast16_t i=0; i<1024; ++i) {
+		// small moduli and moduli near R
+		num_type n = (i < 16 ? (num_type)(2 * i + 3) : (i < 32 ? mask - 2 * (i - 16) : (num_type)rng() & mask)) | 1;
+		if (n == 1) n = 3;
+		const context_type context(n);
+		const plain_type plain(n);
+		assert(context.get_modulus() == n);
+		assert(context.from_form(context.one()) == 1);
+		for (uint_fast16_t j=0; j<64; ++j) {
+			const num_type a = (num_type)rng() % n, b = (num_type)rng() % n, e = (num_type)rng() & mask;
+			const num_type x = context.to_form(a), y = context.to_form(b);
+			assert(x < n && y < n);
+			assert(context.from_form(x) == a);
+			assert(context.from_form(context.mul(x, y)) == mul_mod_type::mul_mod(n, a, b));
+			assert(context.from_form(context.square(x)) == plain.square(a));
+			assert(context.pow_mod(a, e) == mul_mod_type::pow_mod(n, a, e));
+			assert(context.pow_mod(a, e) == plain.pow_mod(a, e));
+			assert(context.from_form(context.pow(x, e)) == context.pow_mod(a, e));
+		}
+		// powers of one base by several exps
+		num_type exps[9] = {}, pows[9] = {}, plain_pows[9] = {};
+		const uint_fast8_t count = (uint_fast8_t)(i % 10);
+		for (uint_fast8_t j=0; j<count; ++j) exps[j] = (j == 0 ? 0 : (num_type)rng() & mask) >> (rng() % 8);
+		const num_type a = (num_type)rng() % n;
+		MultiPow<context_type>::pow(context, context.to_form(a), exps, count, pows);
+		MultiPow<plain_type>::pow(plain, a, exps, count, plain_pows);
+		for (uint_fast8_t j=0; j<count; ++j) {
+			assert(context.from_form(pows[j]) == context.pow_mod(a, exps[j]));
+			assert(plain_pows[j] == context.pow_mod(a, exps[j]));
+		}
+		assert(context.pow_mod(0, 0) == 1 && context.pow_mod(n - 1, 2) == 1);
+	}
+}
+
+// the largest modulus R - 1 and residues up to R - 1 by wider num_type
+void test_max_modulus() {
+	typedef MontgomeryContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t> mont_fast32_type;
+	typedef MulMod<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> mul_mod64_type;
+	const uint_fast32_t n = UINT32_MAX;
+	const mont_fast32_type context(n);
+	const mont32_type context32(UINT32_MAX);
+	assert(context.from_form(context.one()) == 1 && context32.from_form(context32.one()) == 1);
+	std::mt19937_64 rng(2);
+	for (uint_fast16_t i=0; i<1024; ++i) {
+		const uint_fast32_t a = (i == 0 ? n : (uint_fast32_t)(rng() & n)), b = (uint_fast32_t)(rng() & n), e = (uint_fast32_t)(rng() & n);
+		assert(context.from_form(context.to_form(a)) == a % n);
+		assert(context.from_form(context.mul(context.to_form(a), context.to_form(b))) == mul_mod64_type::mul_mod(n, a % n, b % n));
+		assert(context.pow_mod(a, e) == mul_mod64_type::pow_mod(n, a % n, e));
+		assert(context32.pow_mod((uint32_t)a, (uint32_t)e) == context.pow_mod(a, e));
+	}
+}
+
+// Fermat's little theorem at compile time
+void test_constexpr() {
+	constexpr mont64_type context(0xffffffffffffffc5ULL);
+	static_assert(context.pow_mod(2, 0xffffffffffffffc4ULL) == 1, "2^(p-1) != 1 mod p");
+	static_assert(context.from_form(context.to_form(12345)) == 12345, "from_form(to_form(a)) != a");
+	constexpr mont32_type context32(4294967291U);
+	static_assert(context32.pow_mod(3, 4294967290U) == 1, "3^(p-1) != 1 mod p");
+	static_assert(MulModContext<uint32_t, ((uint32_t)1)<<31, uint64_t>(4294967291U).pow_mod(3, 4294967290U) == 1, "3^(p-1) != 1 mod p");
+}
+
+int main() {
+	check_context<uint32_t, ((uint32_t)1)<<31, uint64_t>();
+	check_context<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>();
+	check_context<uint64_t, ((uint64_t)1)<<63, uint128_t>();
+	test_max_modulus();
+	test_constexpr();
+	return 0;
+}
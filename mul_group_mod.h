@@ -6,13 +6,20 @@
 #include "canonic_factors.h"
 #include "mul_mod.h"
 
-template <typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+// FACTORIZER_TYPE - Factorizer or other class with the same interface,
+//     modulo is factorized too, so RhoFactorizer is needed for big prime moduli
+// MOD_CONTEXT_TYPE - MulModContext or other class with the same interface (MontgomeryContext for odd moduli, BarrettContext for any ones)
+template <
+	typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE,
+	typename FACTORIZER_TYPE = Factorizer<NUM_TYPE>,
+	typename MOD_CONTEXT_TYPE = MulModContext<NUM_TYPE, NUM_TYPE_MAX_MASK, OPERATION_TYPE>
+>
 class MulGroupMod {
 public:
 	typedef NUM_TYPE num_type;
 private:
-	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
-	typedef CanonicFactorsTemplate<num_type, MAX_POW_COUNT> cft_type;
+	typedef MOD_CONTEXT_TYPE mod_context_type;
+	typedef CanonicFactorsTemplate<num_type, MAX_POW_COUNT, FACTORIZER_TYPE> cft_type;
 	typedef typename cft_type::pow_count_type pow_count_type;
 	typedef typename cft_type::PrimePow prime_pow_type;
 	typedef typename cft_type::CanonicFactors canonic_factors_type;
@@ -21,14 +28,22 @@ public:
 	
 private:
 	canonic_factors_type group_exponent;
+	// exps[i] == radical / q_i by prime factors q_i of group_exponent,
+	// radical is their product
+	num_type exps[MAX_POW_COUNT];
+	num_type radical;
+	// group_exponent / radical
+	num_type common_exp;
 	num_type modulo;
+	mod_context_type context;
+	pow_count_type exps_count;
 	
 	MulGroupMod() = delete;
 	MulGroupMod(const MulGroupMod &b) = delete;
 	MulGroupMod& operator=(const MulGroupMod &b) = delete;
 	
 public:
-	MulGroupMod(canonic_factorizer_type &canonic_factorizer) : group_exponent(canonic_factorizer), modulo(0) {}
+	MulGroupMod(canonic_factorizer_type &canonic_factorizer) : group_exponent(canonic_factorizer), radical(1), common_exp(1), modulo(0), exps_count(0) {}
 	
 	MulGroupMod(canonic_factorizer_type &canonic_factorizer, num_type b_modulo) : MulGroupMod(canonic_factorizer) {
 		assign(b_modulo);
@@ -37,14 +52,23 @@ public:
 	void assign(num_type b_modulo) {
 		assert(b_modulo > 1);
 		modulo = b_modulo;
+		context.assign(modulo);
 		group_exponent.assign(modulo);
 		group_exponent = canonic_factors_type::carmichael(group_exponent);
+		prime_pow_type exp_pows[MAX_POW_COUNT];
+		exps_count = group_exponent.copy(exp_pows, MAX_POW_COUNT);
+		radical = 1;
+		for (pow_count_type i=0; i<exps_count; ++i) radical *= exp_pows[i].prime;
+		assert(group_exponent.value() % radical == 0);
+		common_exp = group_exponent.value() / radical;
+		for (pow_count_type i=0; i<exps_count; ++i) exps[i] = radical / exp_pows[i].prime;
 	}
 	
 	// gcd(modulo, element) == 1
 	num_type element_order(num_type element) const {
 		assert(modulo > 1);
-		assert(mul_mod_type::pow_mod(modulo, element, group_exponent.value()) == 1);
+		const num_type x = context.to_form(element);
+		assert(context.pow(x, group_exponent.value()) == context.one());
 		prime_pow_type exp_pows[MAX_POW_COUNT];
 		pow_count_type exp_pow_count = group_exponent.copy(exp_pows, MAX_POW_COUNT);
 		pow_count_type i;
@@ -53,29 +77,29 @@ public:
 				if (exp_pows[i].exp == 0) continue;
 				--exp_pows[i].exp;
 				num_type exp_value = canonic_factors_type::value(exp_pows, exp_pow_count);
-				if (mul_mod_type::pow_mod(modulo, element, exp_value) == 1) break;
+				if (context.pow(x, exp_value) == context.one()) break;
 				++exp_pows[i].exp;
 			}
 		} while (i<exp_pow_count);
 		num_type exp_value = canonic_factors_type::value(exp_pows, exp_pow_count);
-		assert(mul_mod_type::pow_mod(modulo, element, exp_value) == 1);
+		assert(context.pow(x, exp_value) == context.one());
 		return exp_value;
 	}
 	
 	// gcd(modulo, root) == 1, module is prime
+	// root^(group_exponent / q_i) == (root^common_exp)^exps[i] for all q_i by one chain of squares, see MultiPow
 	bool is_primitive_root(num_type root) const {
 		assert(modulo > 1);
-		assert(mul_mod_type::pow_mod(modulo, root, group_exponent.value()) == 1);
 		if (modulo <= 3) return true;
-		prime_pow_type exp_pows[MAX_POW_COUNT];
-		pow_count_type exp_pow_count = group_exponent.copy(exp_pows, MAX_POW_COUNT);
-		num_type group_exponent_value = group_exponent.value();
-		for (pow_count_type i=0; i<exp_pow_count; ++i) {
-			assert(group_exponent_value > exp_pows[i].prime);
-			assert(group_exponent_value % exp_pows[i].prime == 0);
-			num_type exp = group_exponent_value / exp_pows[i].prime;
-			num_type pow = mul_mod_type::pow_mod(modulo, root, exp);
-			if (pow == 1) return false;
+		const num_type x = context.pow(context.to_form(root), common_exp);
+#ifndef NDEBUG
+		// root^group_exponent
+		assert(context.pow(x, radical) == context.one());
+#endif
+		num_type pows[MAX_POW_COUNT];
+		MultiPow<mod_context_type>::pow(context, x, exps, exps_count, pows);
+		for (pow_count_type i=0; i<exps_count; ++i) {
+			if (pows[i] == context.one()) return false;
 		}
 		return true;
 	}
@@ -2,6 +2,20 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "mul_group_mod.h"
+#include "montgomery.h"
+#include "barrett.h"
+#include "pollard_rho.h"
+#include "uint128.h"
+
+typedef MulGroupMod<uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t> mgm32_type;
+typedef MulGroupMod<
+	uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t, Factorizer<uint_fast32_t>,
+	MontgomeryContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> mgm32_montgomery_type;
+typedef MulGroupMod<
+	uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t, Factorizer<uint_fast32_t>,
+	BarrettContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> mgm32_barrett_type;
 
 uint_fast64_t gcd(uint_fast64_t a, uint_fast64_t b) {
 	if (a == 0) return b;
@@ -125,15 +139,17 @@ void fill_max_roots() {
 	}
 }
 
-void test_max_primitive_root() {
+// first_idx - index of the first prime modulo, MontgomeryContext needs odd one
+template <typename MGM_TYPE>
+void test_max_primitive_root(size_t first_idx = 0) {
 	fill_myprimes();
 	fill_max_roots();
 	
 	typedef uint_fast32_t num_type;
-	typedef MulGroupMod<num_type, 9, ((num_type)1)<<31, uint_fast64_t> mgm_type;
+	typedef MGM_TYPE mgm_type;
 	
-	typedef mgm_type::canonic_factorizer_type cfzr_type;
-	typedef cfzr_type::primes_array_type primes_array_type;
+	typedef typename mgm_type::canonic_factorizer_type cfzr_type;
+	typedef typename cfzr_type::primes_array_type primes_array_type;
 	// pi(2^16) = 6542
 	num_type primes[6542];
 	size_t primes_count = primes_array_type::fill_primes(
@@ -144,7 +160,7 @@ void test_max_primitive_root() {
 	assert(primes_count == sizeof(primes) / sizeof(primes[0]));
 	cfzr_type cfzr(primes_array_type(primes, primes_count));
 	
-	for (size_t idx=0; idx<sizeof(primes) / sizeof(primes[0]); ++idx) {
+	for (size_t idx=first_idx; idx<sizeof(primes) / sizeof(primes[0]); ++idx) {
 		num_type modulo = primes[idx];
 		mgm_type mul_group_mod(cfzr, modulo);
 		num_type max_root = 0;
@@ -162,9 +178,43 @@ void test_max_primitive_root() {
 	}
 }
 
+// Mersenne primes 2^89 - 1 and 2^127 - 1
+void test_uint128() {
+	typedef uint128_t num_type;
+	typedef RhoFactorizer<num_type, ((num_type)1)<<127, num_type> rho_fzr_type;
+	typedef MulGroupMod<num_type, 16, ((num_type)1)<<127, num_type, rho_fzr_type> mgm_type;
+	typedef MulMod<num_type, ((num_type)1)<<127, num_type> mul_mod_type;
+	mgm_type::canonic_factorizer_type cfzr;
+	
+	const uint_fast8_t exps[] = {89, 127};
+	// least primitive roots, the largest prime factors of p - 1
+	const num_type least_roots[] = {3, 43};
+	const num_type max_factors[] = {2931542417ULL, 77158673929ULL};
+	for (size_t i=0; i<sizeof(exps)/sizeof(exps[0]); ++i) {
+		const num_type p = ((num_type)1 << exps[i]) - 1;
+		mgm_type mul_group_mod(cfzr, p);
+		num_type root = 2;
+		while (!mul_group_mod.is_primitive_root(root)) {
+			assert(mul_group_mod.element_order(root) < p - 1);
+			++root;
+		}
+		assert(root == least_roots[i]);
+		assert(mul_group_mod.element_order(root) == p - 1);
+		assert(mul_group_mod.element_order(1) == 1);
+		assert(mul_group_mod.element_order(p - 1) == 2);
+		// 2 is of order exp modulo 2^exp - 1
+		assert(mul_group_mod.element_order(2) == exps[i]);
+		const num_type q = max_factors[i];
+		assert(mul_group_mod.element_order(mul_mod_type::pow_mod(p, root, (p - 1) / q)) == q);
+	}
+}
+
 void tests_suite() {
 	//test_order();
-	test_max_primitive_root();
+	test_max_primitive_root<mgm32_type>();
+	test_max_primitive_root<mgm32_montgomery_type>(1);
+	test_max_primitive_root<mgm32_barrett_type>();
+	test_uint128();
 }
 
 int main() {
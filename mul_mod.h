@@ -2,40 +2,286 @@
 #define MUL_MOD_H
 
 #include <assert.h>
+#include <type_traits>
+#include "uint128.h"
 
+// product of two values modulo p: OPERATION_TYPE holds product of two num_type values,
+// uint128_t num_type with not wider OPERATION_TYPE uses Uint128MulMod
+template <typename NUM_TYPE, typename OPERATION_TYPE, bool IS_UINT128 = (
+	std::is_same<NUM_TYPE, uint128_t>::value && sizeof(OPERATION_TYPE) <= sizeof(NUM_TYPE)
+)>
+struct MulModOperation {
+	static constexpr NUM_TYPE mul_mod(NUM_TYPE p, NUM_TYPE a, NUM_TYPE b) {
+		return ((OPERATION_TYPE)a * (OPERATION_TYPE)b) % (OPERATION_TYPE)p;
+	}
+};
+
+template <typename NUM_TYPE, typename OPERATION_TYPE>
+struct MulModOperation<NUM_TYPE, OPERATION_TYPE, true> {
+	static constexpr NUM_TYPE mul_mod(NUM_TYPE p, NUM_TYPE a, NUM_TYPE b) {
+		return Uint128MulMod::mul_mod(p, a, b);
+	}
+};
+
+// k-ary window exponentiation by context of modulus (MulModContext or other class with the same interface):
+// the top bit of exp is found by clz, exp is split into windows of w bits from its low bit,
+// every window is w squares and one product by a^v from table of a^0, ..., a^(2^w - 1).
+// Windows are fixed, not sliding: sliding ones branch on every bit unpredictably.
+// w grows with bits of exp, short exps go by plain square-and-multiply.
+template <typename CONTEXT_TYPE>
+struct WindowPow {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+	static constexpr uint_fast8_t MAX_WINDOW_BITS = 4;
+	
+	// minimum of bits squares + bits / w products + 2^w - 2 products for table
+	static constexpr uint_fast8_t window_bits(uint_fast8_t exp_bits) {
+		return (exp_bits > 96 ? 4 : exp_bits > 8 ? 3 : 1);
+	}
+	
+	// a - form of context, returns form, on 0^0 returns form of 1
+	static constexpr num_type pow(const context_type &context, num_type a, num_type exp) {
+		if (exp == 0) return context.one();
+		// reduced a
+		if (exp == 1) return context.mul(a, context.one());
+		const uint_fast8_t exp_bits = UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(exp);
+		const uint_fast8_t w = window_bits(exp_bits);
+		num_type result = a;
+		if (w == 1) {
+			for (int_fast16_t i=exp_bits-2; i>=0; --i) {
+				result = context.square(result);
+				if ((exp >> i) & 1) result = context.mul(result, a);
+			}
+			return result;
+		}
+		// table[v] == a^v
+		num_type table[1 << MAX_WINDOW_BITS] = {};
+		table[0] = context.one();
+		table[1] = a;
+		for (uint_fast8_t v=2; v<(1 << w); ++v) table[v] = context.mul(table[v-1], a);
+		const num_type window_mask = ((num_type)1 << w) - 1;
+		// the top window is not full
+		int_fast16_t shift = (int_fast16_t)((exp_bits - 1) / w * w);
+		result = table[(exp >> shift) & window_mask];
+		for (shift-=w; shift>=0; shift-=w) {
+			for (uint_fast8_t k=0; k<w; ++k) result = context.square(result);
+			const num_type v = (exp >> shift) & window_mask;
+			if (v != 0) result = context.mul(result, table[v]);
+		}
+		return result;
+	}
+};
+
+// Powers of one base by several exps together: squares a^(2^j) are found once from the low bit,
+// every a^exps[i] multiplies the ones of its set bits, so k exps of b bits cost
+// b squares and popcounts of exps products instead of k * b squares of k separate pows.
+template <typename CONTEXT_TYPE>
+struct MultiPow {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+
+	// a - form of context, results[i] == a^exps[i] in form for i < count
+	static constexpr void pow(const context_type &context, num_type a, const num_type exps[], uint_fast8_t count, num_type results[]) {
+		num_type all_bits = 0;
+		for (uint_fast8_t i=0; i<count; ++i) {
+			results[i] = context.one();
+			all_bits |= exps[i];
+		}
+		for (uint_fast8_t j=0; all_bits != 0; ++j) {
+			if (all_bits & 1) {
+				for (uint_fast8_t i=0; i<count; ++i) {
+					if ((exps[i] >> j) & 1) results[i] = context.mul(results[i], a);
+				}
+			}
+			all_bits >>= 1;
+			if (all_bits != 0) a = context.square(a);
+		}
+	}
+};
+
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class MulModContext;
+
+// all methods are constexpr, so they may build tables at compile time
+// NUM_TYPE_MAX_MASK is not read since pow_mod finds the top bit of exp by clz (see WindowPow),
+// it is kept for API compatibility
 template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
 class MulMod {
 public:
 	typedef NUM_TYPE num_type;
 	typedef OPERATION_TYPE operation_type;
+private:
+	typedef MulModOperation<num_type, operation_type> operation;
 	
-	static num_type mul_mod(num_type p, num_type a, num_type b) {
-		operation_type p_op = p, a_op = a, b_op = b;
-		return (a_op * b_op) % p_op;
+public:
+	static constexpr num_type mul_mod(num_type p, num_type a, num_type b) {
+		return operation::mul_mod(p, a, b);
 	}
 	
-	static num_type square_mod(num_type p, num_type a) {
-		operation_type p_op = p, a_op = a;
-		return (a_op * a_op) % p_op;
+	static constexpr num_type square_mod(num_type p, num_type a) {
+		return operation::mul_mod(p, a, a);
 	}
 	
-	// on 0^0 returns 1
-	static num_type pow_mod(num_type mod, num_type base, num_type exp) {
+	// on 0^0 returns 1, see WindowPow
+	static constexpr num_type pow_mod(num_type mod, num_type base, num_type exp) {
 		assert(mod > 1);
 		//assert(base > 0 || exp > 0);
-		operation_type base_op = base, mod_op = mod, result = 1;
-		num_type mask = NUM_TYPE_MAX_MASK;
-		while (mask != 0 && !(exp & mask)) mask >>= 1;
-		while (mask > 0) {
-			result = (result * result) % mod_op;
-			if (exp & mask) {
-				result = (result * base_op) % mod_op;
-			}
-			mask >>= 1;
-		}
-		return result;
+		return WindowPow<MulModContext<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE>>::pow(
+			MulModContext<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE>(mod), base, exp
+		);
 	}
 };
 
-#endif/*MUL_MOD_H*/
+// Context of fixed modulus for classes which do many multiplications by one modulus:
+// residues are kept in form of context, they are converted by to_form and from_form,
+// mul, square and pow work with forms, pow_mod with ordinary residues.
+// This one keeps residues as they are and multiplies them by MulMod,
+// MontgomeryContext (see montgomery.h) and BarrettContext (see barrett.h) have the same interface.
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class MulModContext {
+public:
+	typedef NUM_TYPE num_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+
+private:
+	num_type mod;
+
+public:
+	constexpr MulModContext() : mod(0) {}
+
+	constexpr explicit MulModContext(num_type b_mod) : mod(b_mod) {
+		assert(mod > 1);
+	}
+
+	// use default copy constructor and assignment operator
+
+	constexpr void assign(num_type b_mod) {
+		assert(b_mod > 1);
+		mod = b_mod;
+	}
+
+	constexpr num_type get_modulus() const {
+		return mod;
+	}
+
+	constexpr num_type to_form(num_type a) const {
+		return a;
+	}
+
+	constexpr num_type from_form(num_type a) const {
+		return a;
+	}
+
+	// form of 1
+	constexpr num_type one() const {
+		return 1;
+	}
 
+	constexpr num_type mul(num_type a, num_type b) const {
+		return mul_mod_type::mul_mod(mod, a, b);
+	}
+
+	constexpr num_type square(num_type a) const {
+		return mul_mod_type::square_mod(mod, a);
+	}
+
+	constexpr num_type pow(num_type a, num_type exp) const {
+		return WindowPow<MulModContext>::pow(*this, a, exp);
+	}
+
+	// a^exp of ordinary residue
+	constexpr num_type pow_mod(num_type a, num_type exp) const {
+		return WindowPow<MulModContext>::pow(*this, a, exp);
+	}
+};
+
+template <typename NUM_TYPE, NUM_TYPE MOD, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class FixedMulModContext;
+
+// MulMod by modulus MOD known at compile time: % by constant is replaced by multiplication and shifts
+// (if OPERATION_TYPE is not wider than 64 bits)
+template <typename NUM_TYPE, NUM_TYPE MOD, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class FixedMulMod {
+public:
+	typedef NUM_TYPE num_type;
+	typedef OPERATION_TYPE operation_type;
+	static_assert(MOD > 1, "MOD must be > 1");
+	static constexpr num_type MODULUS = MOD;
+private:
+	typedef MulModOperation<num_type, operation_type> operation;
+	
+public:
+	static constexpr num_type mul_mod(num_type a, num_type b) {
+		return operation::mul_mod(MOD, a, b);
+	}
+	
+	static constexpr num_type square_mod(num_type a) {
+		return operation::mul_mod(MOD, a, a);
+	}
+	
+	// on 0^0 returns 1, see WindowPow
+	static constexpr num_type pow_mod(num_type base, num_type exp) {
+		return WindowPow<FixedMulModContext<num_type, MOD, NUM_TYPE_MAX_MASK, OPERATION_TYPE>>::pow(
+			FixedMulModContext<num_type, MOD, NUM_TYPE_MAX_MASK, OPERATION_TYPE>(), base, exp
+		);
+	}
+};
+
+// Context of modulus MOD known at compile time, see MulModContext and FixedMulMod
+template <typename NUM_TYPE, NUM_TYPE MOD, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class FixedMulModContext {
+public:
+	typedef NUM_TYPE num_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	typedef FixedMulMod<num_type, MOD, NUM_TYPE_MAX_MASK, OPERATION_TYPE> fixed_mul_mod_type;
+
+	constexpr FixedMulModContext() {}
+
+	constexpr explicit FixedMulModContext(num_type b_mod) {
+		assign(b_mod);
+	}
+
+	// use default copy constructor and assignment operator
+
+	// b_mod == MOD
+	constexpr void assign(num_type b_mod) const {
+		assert(b_mod == MOD);
+		(void)b_mod;
+	}
+
+	constexpr num_type get_modulus() const {
+		return MOD;
+	}
+
+	constexpr num_type to_form(num_type a) const {
+		return a;
+	}
+
+	constexpr num_type from_form(num_type a) const {
+		return a;
+	}
+
+	// form of 1
+	constexpr num_type one() const {
+		return 1;
+	}
+
+	constexpr num_type mul(num_type a, num_type b) const {
+		return fixed_mul_mod_type::mul_mod(a, b);
+	}
+
+	constexpr num_type square(num_type a) const {
+		return fixed_mul_mod_type::square_mod(a);
+	}
+
+	constexpr num_type pow(num_type a, num_type exp) const {
+		return WindowPow<FixedMulModContext>::pow(*this, a, exp);
+	}
+
+	// a^exp of ordinary residue
+	constexpr num_type pow_mod(num_type a, num_type exp) const {
+		return WindowPow<FixedMulModContext>::pow(*this, a, exp);
+	}
+};
+
+#endif/*MUL_MOD_H*/
@@ -0,0 +1,290 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "mul_mod.h"
+#include "montgomery.h"
+#include "barrett.h"
+#include "fixed_base_pow.h"
+#include "mul_group_mod.h"
+#include "primitive_roots.h"
+#include "square_root_mod.h"
+#include "uint128.h"
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// nanoseconds per pow_mod of random residues by random moduli (odd or even) of bits bits
+template <typename CONTEXT_TYPE>
+double bench_pow_mod(uint_fast8_t bits, bool is_odd = true) {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+	const num_type mask = (num_type)(~(num_type)0 >> (sizeof(num_type) * 8 - bits));
+	std::mt19937_64 rng(1);
+	const size_t count = 1 << 16;
+	std::vector<num_type> moduli(16), bases(count), exps(count);
+	for (size_t i=0; i<moduli.size(); ++i) moduli[i] = (((num_type)rng() & mask) | ((num_type)1 << (bits - 1)) | 1) - (is_odd ? 0 : 1);
+	for (size_t i=0; i<count; ++i) {
+		bases[i] = (num_type)rng() & mask;
+		exps[i] = (num_type)rng() & mask;
+	}
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t m=0; m<moduli.size(); ++m) {
+		const context_type context(moduli[m]);
+		for (size_t i=0; i<count; ++i) sum += context.pow_mod(bases[i] % moduli[m], exps[i]);
+	}
+	const double t = get_time() - t0;
+	assert(sum != 1);
+	return t * 1e9 / (moduli.size() * count);
+}
+
+// nanoseconds per pow_mod of random residues by one prime modulus
+template <typename CONTEXT_TYPE>
+double bench_one_modulus(const std::vector<typename CONTEXT_TYPE::num_type> &moduli) {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+	std::mt19937_64 rng(1);
+	const size_t count = 1 << 18;
+	const context_type context(moduli[0]);
+	std::vector<num_type> bases(count), exps(count);
+	for (size_t i=0; i<count; ++i) {
+		bases[i] = (num_type)rng() % moduli[0];
+		exps[i] = (num_type)rng();
+	}
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<count; ++i) sum += context.pow_mod(bases[i], exps[i]);
+	const double t = get_time() - t0;
+	assert(sum != 1);
+	return t * 1e9 / count;
+}
+
+// plain left-to-right square-and-multiply from the top bit of NUM_TYPE, reference of WindowPow
+template <typename CONTEXT_TYPE>
+typename CONTEXT_TYPE::num_type binary_pow(const CONTEXT_TYPE &context, typename CONTEXT_TYPE::num_type a, typename CONTEXT_TYPE::num_type exp) {
+	typedef typename CONTEXT_TYPE::num_type num_type;
+	num_type result = context.one();
+	for (num_type mask = (num_type)1 << (UnsignedOps<num_type>::BITS - 1); mask > 0; mask >>= 1) {
+		result = context.square(result);
+		if (exp & mask) result = context.mul(result, a);
+	}
+	return result;
+}
+
+// nanoseconds per power of one base by one prime modulus: square-and-multiply, sliding window, comb
+template <typename CONTEXT_TYPE>
+void bench_one_base(const char *name, typename CONTEXT_TYPE::num_type p) {
+	typedef CONTEXT_TYPE context_type;
+	typedef typename context_type::num_type num_type;
+	std::mt19937_64 rng(1);
+	const size_t count = 1 << 18;
+	std::vector<num_type> exps(count);
+	for (size_t i=0; i<count; ++i) exps[i] = (num_type)rng() % (p - 1);
+	const context_type context(p);
+	const num_type g = context.to_form(3);
+	// every exp depends on the previous power, so loops are not vectorized
+	num_type sum_binary = 0, sum_window = 0, sum_comb = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<count; ++i) sum_binary += binary_pow(context, g, exps[i] ^ (sum_binary & 1));
+	const double t_binary = get_time() - t0;
+	t0 = get_time();
+	for (size_t i=0; i<count; ++i) sum_window += context.pow(g, exps[i] ^ (sum_window & 1));
+	const double t_window = get_time() - t0;
+	const uint_fast8_t exp_bits = (uint_fast8_t)(UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(p));
+	// one table takes a few microseconds, so average of many ones
+	const size_t tables_count = 1024;
+	num_type sum_tables = 0;
+	t0 = get_time();
+	for (size_t i=0; i<tables_count; ++i) {
+		const FixedBasePow<context_type> table_fbp(context, 2 + (num_type)(i & 15) + (sum_tables & 1), exp_bits);
+		sum_tables += table_fbp.pow(1);
+	}
+	const double t_table = (get_time() - t0) / tables_count;
+	assert(sum_tables != 0);
+	const FixedBasePow<context_type> fbp(context, 3, exp_bits);
+	t0 = get_time();
+	for (size_t i=0; i<count; ++i) sum_comb += fbp.pow(exps[i] ^ (sum_comb & 1));
+	const double t_comb = get_time() - t0;
+	assert(sum_binary == sum_window && sum_window == sum_comb);
+	printf("%-16s %12.2f %12.2f %12.2f %12.2f\n", name, t_binary * 1e9 / count, t_window * 1e9 / count, t_comb * 1e9 / count, t_table * 1e9);
+}
+
+// nanoseconds per primitive root check of residues 2, ..., 257 by every prime of primes:
+// separate pows by every prime factor q of p - 1 with early exit against one chain of MultiPow
+template <typename CONTEXT_TYPE>
+void bench_primitive_roots(const char *name, const std::vector<uint_fast32_t> &primes) {
+	typedef CONTEXT_TYPE context_type;
+	typedef uint_fast32_t num_type;
+	typedef PrimitiveRoots<num_type, 9, ((num_type)1)<<31, uint_fast64_t, context_type> prrs_type;
+	size_t count = 0, sum_separate = 0, sum_multi = 0;
+	double t_separate = 0, t_multi = 0;
+	for (size_t idx=0; idx<primes.size(); ++idx) {
+		const num_type p = primes[idx];
+		if (p <= 3) continue;
+		const context_type context(p);
+		num_type exps[9] = {};
+		uint_fast8_t exps_count = 0;
+		num_type m = p - 1;
+		for (num_type d=2; d <= m / d; d += (d == 2 ? 1 : 2)) {
+			if (m % d) continue;
+			exps[exps_count++] = (p - 1) / d;
+			do {
+				m /= d;
+			} while (!(m % d));
+		}
+		if (m > 1) exps[exps_count++] = (p - 1) / m;
+		// the largest prime factor first as by PrimitiveRoots before
+		for (uint_fast8_t i=0; i<exps_count/2; ++i) {
+			const num_type t = exps[i];
+			exps[i] = exps[exps_count-i-1];
+			exps[exps_count-i-1] = t;
+		}
+		const prrs_type prrs(p);
+		const num_type last = (p < 258 ? p : 258);
+		double t0 = get_time();
+		for (num_type a=2; a<last; ++a) {
+			const num_type x = context.to_form(a);
+			uint_fast8_t i = 0;
+			while (i < exps_count && context.pow(x, exps[i]) != context.one()) ++i;
+			sum_separate += (i == exps_count);
+		}
+		t_separate += get_time() - t0;
+		t0 = get_time();
+		for (num_type a=2; a<last; ++a) sum_multi += prrs.is_primitive_root(a);
+		t_multi += get_time() - t0;
+		count += last - 2;
+	}
+	assert(sum_separate == sum_multi);
+	printf("%-28s %12.2f %12.2f\n", name, t_separate * 1e9 / count, t_multi * 1e9 / count);
+}
+
+// seconds of search of the largest primitive root of every prime < 2^16
+template <typename MGM_TYPE>
+double bench_mul_group_mod() {
+	typedef MGM_TYPE mgm_type;
+	typedef typename mgm_type::num_type num_type;
+	typedef typename mgm_type::canonic_factorizer_type cfzr_type;
+	typedef typename cfzr_type::primes_array_type primes_array_type;
+	// pi(2^16) = 6542
+	std::vector<num_type> primes(6542);
+	const size_t primes_count = primes_array_type::fill_primes(primes.data(), primes.size(), (num_type)UINT16_MAX + 1);
+	cfzr_type cfzr(primes_array_type(primes.data(), primes_count));
+	num_type sum = 0;
+	double t0 = get_time();
+	for (size_t idx=1; idx<primes_count; ++idx) {
+		mgm_type mul_group_mod(cfzr, primes[idx]);
+		num_type root = primes[idx] - 1;
+		while (!mul_group_mod.is_primitive_root(root)) --root;
+		sum += root;
+	}
+	const double t = get_time() - t0;
+	assert(sum != 0);
+	return t;
+}
+
+// seconds of square roots of 2^16 residues by primes == 1 mod 2^10 near 2^32
+template <typename SRM_TYPE>
+double bench_square_root_mod() {
+	typedef SRM_TYPE srm_type;
+	typedef uint_fast32_t num_type;
+	typedef PrimesArray<num_type> primes_array_type;
+	num_type primes[1024];
+	const size_t primes_count = primes_array_type::fill_primes(primes, 1024, UINT32_MAX);
+	PrimeChecker<num_type> prime_checker(primes_array_type(primes, primes_count));
+	std::mt19937_64 rng(1);
+	num_type sum = 0;
+	double t0 = get_time();
+	uint_fast8_t moduli_count = 0;
+	for (num_type p = UINT32_MAX - 1022; p > (1U << 31) && moduli_count < 4; p -= 1024) {
+		if (!prime_checker.is_prime(p)) continue;
+		++moduli_count;
+		srm_type square_root_mod(p, primes, primes_count);
+		for (uint_fast32_t i=0; i<(1 << 16); ++i) {
+			const num_type a = (num_type)rng() % p;
+			sum += (square_root_mod.legendre_symbol(a) == 1 ? square_root_mod.tonelli_shanks_algo(a) : 0);
+		}
+	}
+	const double t = get_time() - t0;
+	assert(sum != 0);
+	return t;
+}
+
+int main() {
+	printf("pow_mod, nanoseconds\n");
+	printf("%-16s %12s %12s %12s\n", "bits", "MulMod", "Montgomery", "Barrett");
+	printf("%-16s %12.2f %12.2f %12.2f\n", "32",
+		bench_pow_mod<MulModContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(32),
+		bench_pow_mod<MontgomeryContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(32),
+		bench_pow_mod<BarrettContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(32));
+	printf("%-16s %12.2f %12.2f %12.2f\n", "64",
+		bench_pow_mod<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(64),
+		bench_pow_mod<MontgomeryContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(64),
+		bench_pow_mod<BarrettContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(64));
+	printf("%-16s %12.2f %12s %12.2f\n", "32, even moduli",
+		bench_pow_mod<MulModContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(32, false), "-",
+		bench_pow_mod<BarrettContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(32, false));
+	printf("%-16s %12.2f %12s %12.2f\n", "64, even moduli",
+		bench_pow_mod<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(64, false), "-",
+		bench_pow_mod<BarrettContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(64, false));
+
+	// modulus known at compile time, runtime contexts get it from vector
+	static constexpr uint32_t P32 = 4294967291U;
+	static constexpr uint64_t P64 = 0xffffffffffffffc5ULL;
+	const std::vector<uint32_t> moduli32(1, P32);
+	const std::vector<uint64_t> moduli64(1, P64);
+	printf("\npow_mod by one prime modulus, nanoseconds\n");
+	printf("%-16s %12s %12s %12s %12s\n", "bits", "MulMod", "Montgomery", "Barrett", "FixedMulMod");
+	printf("%-16s %12.2f %12.2f %12.2f %12.2f\n", "32",
+		bench_one_modulus<MulModContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(moduli32),
+		bench_one_modulus<MontgomeryContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(moduli32),
+		bench_one_modulus<BarrettContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>(moduli32),
+		bench_one_modulus<FixedMulModContext<uint32_t, P32, ((uint32_t)1)<<31, uint64_t>>(moduli32));
+	printf("%-16s %12.2f %12.2f %12.2f %12.2f\n", "64",
+		bench_one_modulus<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(moduli64),
+		bench_one_modulus<MontgomeryContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(moduli64),
+		bench_one_modulus<BarrettContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>(moduli64),
+		bench_one_modulus<FixedMulModContext<uint64_t, P64, ((uint64_t)1)<<63, uint128_t>>(moduli64));
+
+	printf("\npowers of one base by one prime modulus, nanoseconds\n");
+	printf("%-16s %12s %12s %12s %12s\n", "", "binary", "window", "comb", "comb table");
+	bench_one_base<MulModContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>("MulMod, 32", P32);
+	bench_one_base<MontgomeryContext<uint32_t, ((uint32_t)1)<<31, uint64_t>>("Montgomery, 32", P32);
+	bench_one_base<MulModContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>("MulMod, 64", P64);
+	bench_one_base<MontgomeryContext<uint64_t, ((uint64_t)1)<<63, uint128_t>>("Montgomery, 64", P64);
+
+	typedef uint_fast32_t num_type;
+	typedef MulModContext<num_type, ((num_type)1)<<31, uint_fast64_t> plain_type;
+	typedef MontgomeryContext<num_type, ((num_type)1)<<31, uint_fast64_t> montgomery_type;
+	typedef BarrettContext<num_type, ((num_type)1)<<31, uint_fast64_t> barrett_type;
+
+	// primes < 2^16 as in primitive_roots_tests.cpp and the last primes < 2^32
+	std::vector<num_type> primes16(6542), primes32;
+	primes16.resize(PrimesArray<num_type>::fill_primes(primes16.data(), primes16.size(), (num_type)UINT16_MAX + 1));
+	PrimeChecker<num_type> prime_checker(PrimesArray<num_type>(primes16.data(), primes16.size()));
+	for (num_type p = UINT32_MAX; primes32.size() < 1024; p -= 2) {
+		if (prime_checker.is_prime(p)) primes32.push_back(p);
+	}
+	printf("\nprimitive root checks, nanoseconds\n");
+	printf("%-28s %12s %12s\n", "", "separate", "MultiPow");
+	bench_primitive_roots<plain_type>("MulMod, p < 2^16", primes16);
+	bench_primitive_roots<montgomery_type>("Montgomery, p < 2^16", primes16);
+	bench_primitive_roots<plain_type>("MulMod, p < 2^32", primes32);
+	bench_primitive_roots<montgomery_type>("Montgomery, p < 2^32", primes32);
+	printf("\nconsumers, seconds\n");
+	printf("%-36s %12s %12s %12s\n", "", "MulMod", "Montgomery", "Barrett");
+	printf("%-36s %12.6f %12.6f %12.6f\n", "MulGroupMod, max roots of p < 2^16",
+		bench_mul_group_mod<MulGroupMod<num_type, 9, ((num_type)1)<<31, uint_fast64_t>>(),
+		bench_mul_group_mod<MulGroupMod<num_type, 9, ((num_type)1)<<31, uint_fast64_t, Factorizer<num_type>, montgomery_type>>(),
+		bench_mul_group_mod<MulGroupMod<num_type, 9, ((num_type)1)<<31, uint_fast64_t, Factorizer<num_type>, barrett_type>>());
+	printf("%-36s %12.6f %12.6f %12.6f\n", "SquareRootMod, Tonelli-Shanks",
+		bench_square_root_mod<SquareRootMod<num_type, 32, uint_fast64_t>>(),
+		bench_square_root_mod<SquareRootMod<num_type, 32, uint_fast64_t, montgomery_type>>(),
+		bench_square_root_mod<SquareRootMod<num_type, 32, uint_fast64_t, barrett_type>>());
+	return 0;
+}
@@ -0,0 +1,225 @@
+#ifndef MULTIPLICATIVE_TABLES_H
+#define MULTIPLICATIVE_TABLES_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+#include "thread_pool.h"
+
+// Tables of arithmetic functions for every n <= bound:
+//     d(n) - divisors count, sigma(n) - divisors sum, phi(n) - Euler's totient,
+//     mu(n) - Moebius function, lambda(n) - Carmichael function.
+// Any subset of them is filled in one pass of segmented factor sieve (see RangeFactorizer):
+// table entries of segment are accumulators, every prime p <= sqrt(bound) multiplies in
+// its power to its multiples, cofactor > 1 left after that is a prime.
+// Segments are independent, so they may be filled by WorkStealingPool.
+// Value types may be narrow (e.g. uint16_t is enough for d(n), n < 2^32), partial values are <= final ones.
+template <
+	typename NUM_TYPE,
+	typename D_TYPE = uint16_t,
+	typename SIGMA_TYPE = uint64_t,
+	typename PHI_TYPE = NUM_TYPE,
+	typename LAMBDA_TYPE = NUM_TYPE
+>
+class MultiplicativeTables {
+public:
+	typedef NUM_TYPE num_type;
+	typedef D_TYPE d_type;
+	typedef SIGMA_TYPE sigma_type;
+	typedef PHI_TYPE phi_type;
+	typedef int8_t mu_type;
+	typedef LAMBDA_TYPE lambda_type;
+	typedef PrimeInverse<num_type> prime_inverse_type;
+	typedef uint_fast8_t exp_type;
+
+	// tables selection flags
+	static constexpr unsigned int TABLE_D = 1;
+	static constexpr unsigned int TABLE_SIGMA = 2;
+	static constexpr unsigned int TABLE_PHI = 4;
+	static constexpr unsigned int TABLE_MU = 8;
+	static constexpr unsigned int TABLE_LAMBDA = 16;
+	static constexpr unsigned int TABLE_ALL = 31;
+
+	// numbers per segment, segment of 256 KiB of cofactors fits L2 cache
+	static constexpr size_t DEFAULT_SEGMENT_SIZE = 32*1024;
+
+private:
+	num_type bound;
+	unsigned int tables;
+	// [n] is for n, [0] is not used
+	std::vector<d_type> d_table;
+	std::vector<sigma_type> sigma_table;
+	std::vector<phi_type> phi_table;
+	std::vector<mu_type> mu_table;
+	std::vector<lambda_type> lambda_table;
+	// odd primes <= sqrt(bound)
+	std::vector<num_type> primes;
+	std::vector<prime_inverse_type> inverses;
+
+	MultiplicativeTables() = delete;
+	MultiplicativeTables(const MultiplicativeTables &b) = delete;
+	MultiplicativeTables& operator=(const MultiplicativeTables &b) = delete;
+
+public:
+	// tables - bitwise or of TABLE_* flags
+	// pool - NULL for construction in calling thread
+	MultiplicativeTables(num_type b_bound, unsigned int b_tables, WorkStealingPool *pool = NULL, size_t segment_size = DEFAULT_SEGMENT_SIZE) :
+		bound(b_bound), tables(b_tables) {
+		assert(bound > 0);
+		assert(segment_size > 0);
+		assert(tables != 0 && (tables & ~TABLE_ALL) == 0);
+		const size_t size = (size_t)bound + 1;
+		if (tables & TABLE_D) d_table.resize(size);
+		if (tables & TABLE_SIGMA) sigma_table.resize(size);
+		if (tables & TABLE_PHI) phi_table.resize(size);
+		if (tables & TABLE_MU) mu_table.resize(size);
+		if (tables & TABLE_LAMBDA) lambda_table.resize(size);
+
+		PrimesSieve<num_type> sieve;
+		sieve.for_each_prime(3, PrimesSieve<num_type>::isqrt(bound), [this] (num_type p) -> bool {
+			primes.push_back(p);
+			inverses.push_back(prime_inverse_type(p));
+			return false;
+		});
+
+		// segment [1 + idx * segment_size, min(bound, (idx + 1) * segment_size)]
+		const size_t segments_count = ((size_t)bound + segment_size - 1) / segment_size;
+		if (pool == NULL) {
+			std::vector<num_type> cofactors(std::min((size_t)bound, segment_size));
+			for (size_t idx=0; idx<segments_count; ++idx) sieve_segment(idx, segment_size, cofactors.data());
+		} else {
+			std::vector< std::vector<num_type> > cofactors(pool->get_threads_count());
+			pool->run(segments_count, [this, segment_size, &cofactors] (size_t worker_idx, size_t idx) {
+				if (cofactors[worker_idx].empty()) cofactors[worker_idx].resize(std::min((size_t)bound, segment_size));
+				sieve_segment(idx, segment_size, cofactors[worker_idx].data());
+			});
+		}
+	}
+
+	num_type get_bound() const {
+		return bound;
+	}
+
+	bool has_tables(unsigned int b_tables) const {
+		return (tables & b_tables) == b_tables;
+	}
+
+	// 0 < n <= bound
+
+	d_type divisors_count(num_type n) const {
+		assert(has_tables(TABLE_D) && n > 0 && n <= bound);
+		return d_table[n];
+	}
+
+	sigma_type divisors_sum(num_type n) const {
+		assert(has_tables(TABLE_SIGMA) && n > 0 && n <= bound);
+		return sigma_table[n];
+	}
+
+	phi_type eulers_phi(num_type n) const {
+		assert(has_tables(TABLE_PHI) && n > 0 && n <= bound);
+		return phi_table[n];
+	}
+
+	mu_type moebius(num_type n) const {
+		assert(has_tables(TABLE_MU) && n > 0 && n <= bound);
+		return mu_table[n];
+	}
+
+	lambda_type carmichael(num_type n) const {
+		assert(has_tables(TABLE_LAMBDA) && n > 0 && n <= bound);
+		return lambda_table[n];
+	}
+
+	// whole tables of bound + 1 elements, NULL if table is not selected
+	const d_type *get_divisors_counts() const { return (d_table.empty() ? NULL : d_table.data()); }
+	const sigma_type *get_divisors_sums() const { return (sigma_table.empty() ? NULL : sigma_table.data()); }
+	const phi_type *get_eulers_phis() const { return (phi_table.empty() ? NULL : phi_table.data()); }
+	const mu_type *get_moebius() const { return (mu_table.empty() ? NULL : mu_table.data()); }
+	const lambda_type *get_carmichaels() const { return (lambda_table.empty() ? NULL : lambda_table.data()); }
+
+private:
+	// binary gcd, a > 0, b > 0
+	static lambda_type gcd(lambda_type a, lambda_type b) {
+		const uint_fast8_t shift = __builtin_ctzll(a | b);
+		a >>= __builtin_ctzll(a);
+		do {
+			b >>= __builtin_ctzll(b);
+			if (a > b) std::swap(a, b);
+			b -= a;
+		} while (b != 0);
+		return a << shift;
+	}
+
+	static lambda_type lcm(lambda_type a, lambda_type b) {
+		// the first prime power of n
+		if (a == 1) return b;
+		return a / gcd(a, b) * b;
+	}
+
+	// multiplies in p^exp to entry i, pe == p^exp, pe_sum == 1 + p + ... + p^exp
+	void mul_prime_pow(size_t i, num_type p, exp_type exp, num_type pe, sigma_type pe_sum) {
+		const num_type pe_1 = pe / p;
+		if (tables & TABLE_D) d_table[i] *= exp + 1;
+		if (tables & TABLE_SIGMA) sigma_table[i] *= pe_sum;
+		if (tables & TABLE_PHI) phi_table[i] *= pe_1 * (p - 1);
+		if (tables & TABLE_MU) mu_table[i] = (exp > 1 ? 0 : -mu_table[i]);
+		if (tables & TABLE_LAMBDA) {
+			// lambda(2) == 1, lambda(4) == 2, lambda(2^exp) == 2^(exp-2)
+			const lambda_type pe_lambda = (p == 2 && exp > 2 ? pe_1 / 2 : pe_1 * (p - 1));
+			lambda_table[i] = lcm(lambda_table[i], pe_lambda);
+		}
+	}
+
+	void sieve_segment(size_t idx, size_t segment_size, num_type cofactors[]) {
+		const num_type low = 1 + (num_type)(idx * segment_size);
+		const size_t count = std::min((size_t)(bound - low) + 1, segment_size);
+		const num_type high = low + (num_type)(count - 1);
+		for (size_t i=0; i<count; ++i) {
+			cofactors[i] = low + i;
+			const size_t n = low + i;
+			if (tables & TABLE_D) d_table[n] = 1;
+			if (tables & TABLE_SIGMA) sigma_table[n] = 1;
+			if (tables & TABLE_PHI) phi_table[n] = 1;
+			if (tables & TABLE_MU) mu_table[n] = 1;
+			if (tables & TABLE_LAMBDA) lambda_table[n] = 1;
+		}
+
+		for (size_t i=(low & 1); i<count; i+=2) {
+			const exp_type exp = __builtin_ctzll(cofactors[i]);
+			cofactors[i] >>= exp;
+			const num_type pe = (num_type)1 << exp;
+			mul_prime_pow(low + i, 2, exp, pe, 2 * (sigma_type)pe - 1);
+		}
+
+		for (size_t k=0; k<primes.size(); ++k) {
+			const num_type p = primes[k];
+			if (p > high / p) break;
+			const prime_inverse_type &inverse = inverses[k];
+			for (size_t i=(size_t)((p - low % p) % p); i<count; i+=p) {
+				num_type cofactor = prime_inverse_type::mul_low(cofactors[i], inverse.inverse);
+				exp_type exp = 1;
+				num_type pe = p;
+				sigma_type pe_sum = 1 + (sigma_type)p;
+				while (inverse.divide(cofactor)) {
+					++exp;
+					pe *= p;
+					pe_sum += pe;
+				}
+				cofactors[i] = cofactor;
+				mul_prime_pow(low + i, p, exp, pe, pe_sum);
+			}
+		}
+
+		for (size_t i=0; i<count; ++i) {
+			const num_type q = cofactors[i];
+			if (q > 1) mul_prime_pow(low + i, q, 1, q, (sigma_type)q + 1);
+		}
+	}
+};
+
+#endif/*MULTIPLICATIVE_TABLES_H*/
@@ -0,0 +1,36 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "multiplicative_tables.h"
+
+typedef MultiplicativeTables<uint32_t, uint16_t, uint64_t, uint32_t, uint32_t> tables_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void bench_tables(const char *name, uint32_t bound, unsigned int selected, WorkStealingPool *pool) {
+	double t0 = get_time();
+	tables_type tables(bound, selected, pool);
+	double t = get_time() - t0;
+	printf("%-16s %2u threads %9.3f s, %7.2f M numbers/s\n", name, (unsigned int)(pool != NULL ? pool->get_threads_count() : 1), t, bound / t * 1e-6);
+}
+
+// usage: multiplicative_tables_bench [bound], default bound is 10^8
+int main(int argc, char *argv[]) {
+	const uint32_t bound = (argc > 1 ? strtoul(argv[1], NULL, 10) : 100000000);
+	WorkStealingPool pool;
+	printf("bound %u, %u hardware threads\n", (unsigned int)bound, (unsigned int)pool.get_threads_count());
+	bench_tables("d", bound, tables_type::TABLE_D, NULL);
+	bench_tables("phi", bound, tables_type::TABLE_PHI, NULL);
+	bench_tables("mu", bound, tables_type::TABLE_MU, NULL);
+	bench_tables("d, phi, mu", bound, tables_type::TABLE_D | tables_type::TABLE_PHI | tables_type::TABLE_MU, NULL);
+	bench_tables("all", bound, tables_type::TABLE_ALL, NULL);
+	bench_tables("all", bound, tables_type::TABLE_ALL, &pool);
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "multiplicative_tables.h"
+#include "canonic_factors.h"
+
+typedef CanonicFactorsTemplate<uint_fast64_t, 15> cft_type;
+
+struct MyValues {
+	uint_fast64_t d, sigma, phi, lambda;
+	int mu;
+};
+
+MyValues my_values(cft_type::CanonicFactorizer &cfzr, uint_fast64_t n) {
+	MyValues values;
+	cft_type::CanonicFactors a(cfzr, n);
+	values.phi = cft_type::CanonicFactors::eulers_phi(a).value();
+	values.lambda = cft_type::CanonicFactors::carmichael(a).value();
+	cft_type::PrimePow pows[15];
+	const size_t pow_count = a.copy(pows, 15);
+	values.d = 1;
+	values.sigma = 1;
+	values.mu = 1;
+	for (size_t i=0; i<pow_count; ++i) {
+		values.d *= pows[i].exp + 1;
+		uint_fast64_t pe = 1, pe_sum = 1;
+		for (uint_fast8_t j=0; j<pows[i].exp; ++j) {
+			pe *= pows[i].prime;
+			pe_sum += pe;
+		}
+		values.sigma *= pe_sum;
+		values.mu = (pows[i].exp > 1 ? 0 : -values.mu);
+	}
+	return values;
+}
+
+template <typename TABLES_TYPE>
+void check_tables(const TABLES_TYPE &tables, unsigned int selected) {
+	cft_type::CanonicFactorizer cfzr;
+	for (uint_fast64_t n=1; n<=tables.get_bound(); ++n) {
+		const MyValues values = my_values(cfzr, n);
+		if (selected & TABLES_TYPE::TABLE_D) assert(tables.divisors_count(n) == values.d);
+		if (selected & TABLES_TYPE::TABLE_SIGMA) assert(tables.divisors_sum(n) == values.sigma);
+		if (selected & TABLES_TYPE::TABLE_PHI) assert(tables.eulers_phi(n) == values.phi);
+		if (selected & TABLES_TYPE::TABLE_MU) assert(tables.moebius(n) == values.mu);
+		if (selected & TABLES_TYPE::TABLE_LAMBDA) assert(tables.carmichael(n) == values.lambda);
+	}
+}
+
+void test_tables() {
+	typedef MultiplicativeTables<uint_fast64_t> tables_type;
+	const uint_fast64_t bounds[] = {1, 2, 3, 10, 1024*64+1};
+	for (size_t i=0; i<sizeof(bounds)/sizeof(bounds[0]); ++i) {
+		tables_type tables(bounds[i], tables_type::TABLE_ALL);
+		assert(tables.get_bound() == bounds[i]);
+		assert(tables.has_tables(tables_type::TABLE_ALL));
+		check_tables(tables, tables_type::TABLE_ALL);
+	}
+}
+
+void test_subsets() {
+	typedef MultiplicativeTables<uint_fast64_t> tables_type;
+	const unsigned int subsets[] = {
+		tables_type::TABLE_D, tables_type::TABLE_SIGMA, tables_type::TABLE_PHI, tables_type::TABLE_MU, tables_type::TABLE_LAMBDA,
+		tables_type::TABLE_PHI | tables_type::TABLE_MU
+	};
+	for (size_t i=0; i<sizeof(subsets)/sizeof(subsets[0]); ++i) {
+		tables_type tables(1024*4, subsets[i], NULL, 100);
+		assert(tables.has_tables(subsets[i]));
+		assert((tables.get_divisors_counts() != NULL) == tables.has_tables(tables_type::TABLE_D));
+		assert((tables.get_eulers_phis() != NULL) == tables.has_tables(tables_type::TABLE_PHI));
+		assert((tables.get_moebius() != NULL) == tables.has_tables(tables_type::TABLE_MU));
+		check_tables(tables, subsets[i]);
+	}
+}
+
+void test_parallel() {
+	// compact widths: d(n) < 2^8 and sigma(n) < 2^32 for n < 2^20
+	typedef MultiplicativeTables<uint32_t, uint8_t, uint32_t, uint32_t, uint32_t> tables_type;
+	const size_t threads_counts[] = {1, 3};
+	const size_t segment_sizes[] = {1, 1000, tables_type::DEFAULT_SEGMENT_SIZE};
+	for (size_t i=0; i<sizeof(threads_counts)/sizeof(threads_counts[0]); ++i) {
+		WorkStealingPool pool(threads_counts[i]);
+		for (size_t j=0; j<sizeof(segment_sizes)/sizeof(segment_sizes[0]); ++j) {
+			tables_type tables(1024*64, tables_type::TABLE_ALL, &pool, segment_sizes[j]);
+			check_tables(tables, tables_type::TABLE_ALL);
+		}
+	}
+	// the same as single thread
+	WorkStealingPool pool(4);
+	const uint32_t bound = 1024*1024;
+	tables_type tables(bound, tables_type::TABLE_ALL, &pool, 1024);
+	tables_type my_tables(bound, tables_type::TABLE_ALL);
+	for (uint32_t n=1; n<=bound; ++n) {
+		assert(tables.divisors_count(n) == my_tables.divisors_count(n));
+		assert(tables.divisors_sum(n) == my_tables.divisors_sum(n));
+		assert(tables.eulers_phi(n) == my_tables.eulers_phi(n));
+		assert(tables.moebius(n) == my_tables.moebius(n));
+		assert(tables.carmichael(n) == my_tables.carmichael(n));
+	}
+	// Mertens function M(10^6) == 212
+	int_fast64_t mertens = 0;
+	for (uint32_t n=1; n<=1000000; ++n) mertens += tables.moebius(n);
+	assert(mertens == 212);
+}
+
+void tests_suite() {
+	test_tables();
+	test_subsets();
+	test_parallel();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
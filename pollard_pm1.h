@@ -0,0 +1,283 @@
+#ifndef POLLARD_PM1_H
+#define POLLARD_PM1_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+#include "mul_mod.h"
+#include "pollard_rho.h"
+
+// Prime powers of stage 1 and pairs (m, j) of stage 2 for bounds B1 <= B2,
+// shared by Pollard's p - 1, Williams' p + 1 and ECM.
+// Stage 2 covers primes q in (B1, B2] by baby steps j and giant steps m*D, q == m*D +- j,
+// primes q <= D / 2 have no giant step m >= 1, so for B1 < D / 2 ones in (B1, D / 2] go to stage 1 once.
+struct StagesPlan {
+	// giant step of stage 2: 2 * 3 * 5 * 7 * 11
+	static constexpr uint64_t D = 2310;
+	// baby steps: odd j < D / 2 coprime to D
+	static constexpr uint_fast16_t BABY_COUNT = 240;
+	static constexpr uint_fast16_t BABY_WORDS = (BABY_COUNT + 63) / 64;
+
+	uint64_t b1;
+	uint64_t b2;
+	// p^k <= B1 for every prime p <= B1
+	std::vector<uint64_t> stage1_pows;
+	// m of the first giant step
+	uint64_t m_begin;
+	// BABY_WORDS words per giant step, bit of baby index is set if m*D + j or m*D - j is prime in (B1, B2]
+	std::vector<uint64_t> stage2_pairs;
+
+	// primes are taken from PrimesArray, primes above its last one from PrimesSieve
+	template <typename NUM_TYPE>
+	StagesPlan(PrimesArray<NUM_TYPE> primes_array, uint64_t b_b1, uint64_t b_b2) : b1(b_b1), b2(b_b2) {
+		assert(b2 >= b1);
+		auto add_prime = [this] (uint64_t p) -> bool {
+			uint64_t pow = p;
+			while (pow <= b1 / p) pow *= p;
+			stage1_pows.push_back(pow);
+			return false;
+		};
+		uint64_t last = 1;
+		for (size_t i=0; i<primes_array.count && (uint64_t)primes_array.primes[i] <= b1; ++i) {
+			last = (uint64_t)primes_array.primes[i];
+			add_prime(last);
+		}
+		if (last < b1) {
+			PrimesSieve<uint64_t> sieve;
+			sieve.for_each_prime(last + 1, b1, add_prime);
+		}
+
+		// primes of stage 2 are above it
+		const uint64_t first = std::max(b1, D / 2);
+		if (b1 < first) {
+			PrimesSieve<uint64_t> sieve;
+			sieve.for_each_prime(b1 + 1, std::min(b2, first), [this] (uint64_t q) -> bool {
+				stage1_pows.push_back(q);
+				return false;
+			});
+		}
+
+		// prime q > D / 2 is coprime to D, so is |q - m*D| < D / 2
+		m_begin = (first + 1 + D / 2) / D;
+		if (b2 <= first) return;
+		const uint64_t m_end = (b2 + D / 2) / D + 1;
+		stage2_pairs.assign((size_t)(m_end - m_begin) * BABY_WORDS, 0);
+		PrimesSieve<uint64_t> sieve;
+		sieve.for_each_prime(first + 1, b2, [this] (uint64_t q) -> bool {
+			const uint64_t m = (q + D / 2) / D;
+			const uint_fast16_t idx = baby_index(q > m * D ? q - m * D : m * D - q);
+			stage2_pairs[(size_t)(m - m_begin) * BABY_WORDS + idx / 64] |= (uint64_t)1 << (idx % 64);
+			return false;
+		});
+	}
+
+	// use default copy constructor and assignment operator
+
+	size_t steps_count() const {
+		return stage2_pairs.size() / BABY_WORDS;
+	}
+
+	static bool is_baby(uint64_t j) {
+		return (j & 1) && j % 3 != 0 && j % 5 != 0 && j % 7 != 0 && j % 11 != 0;
+	}
+
+	// j - baby step, index among baby steps in ascending order by table built once
+	static uint_fast16_t baby_index(uint64_t j) {
+		assert(is_baby(j) && j < D / 2);
+		static const std::vector<uint16_t> indexes = [] () {
+			std::vector<uint16_t> result(D / 2, 0);
+			uint16_t idx = 0;
+			for (uint64_t i=1; i<D/2; i+=2) {
+				if (is_baby(i)) result[i] = idx++;
+			}
+			return result;
+		}();
+		return indexes[j];
+	}
+};
+
+// Pollard's p - 1 and Williams' p + 1 methods: they find prime p | n if p - 1 or p + 1 is B1-smooth
+// except for at most one prime in (B1, B2].
+// Stage 1 of p - 1 raises x to every prime power <= B1 by MulMod::pow_mod,
+// stage 1 of p + 1 does the same with Lucas sequence V_k(P) by V_{a*b}(P) == V_a(V_b(P)).
+// Stage 2 of both is stage 2 of p + 1 by StagesPlan:
+// if P == a + 1/a, q == m*D +- j, then V_{m*D}(P) - V_j(P) == 0 modulo p iff a^q == 1 modulo p,
+// for p - 1 it starts from P == x + 1/x after stage 1.
+// They are cheap, so factorizers run them before heavier methods.
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class PollardPM1 {
+public:
+	typedef NUM_TYPE num_type;
+	typedef RhoFactorizer<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> rho_factorizer_type;
+	typedef typename rho_factorizer_type::trial_factorizer_type::primes_array_type primes_array_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	static constexpr uint64_t DEFAULT_B1 = 10000;
+	static constexpr uint64_t DEFAULT_B2 = 20 * DEFAULT_B1;
+	// gcd of stage 1 is computed once per so many prime powers
+	static constexpr size_t GCD_BATCH = 64;
+	// seeds of p + 1: P^2 - 4 is 5 and 12, (5 / p) and (3 / p) are independent,
+	// so one of them gives group of order p + 1 with probability 3/4
+	static constexpr uint_fast8_t PP1_SEEDS_COUNT = 2;
+	static constexpr num_type PP1_SEEDS[PP1_SEEDS_COUNT] = {3, 4};
+
+private:
+	StagesPlan plan;
+
+public:
+	PollardPM1(primes_array_type primes_array, uint64_t b1 = DEFAULT_B1, uint64_t b2 = DEFAULT_B2) :
+		plan(primes_array, b1, b2) {}
+
+	// use default copy constructor and assignment operator
+
+	const StagesPlan& get_plan() const {
+		return plan;
+	}
+
+private:
+	static num_type add_mod(num_type n, num_type a, num_type b) {
+		return (a >= n - b ? a - (n - b) : a + b);
+	}
+
+	static num_type sub_mod(num_type n, num_type a, num_type b) {
+		return (a >= b ? a - b : a + (n - b));
+	}
+
+	// stage 1 by step(x, pow) for every prime power, returns gcd(x - c, n)
+	template <typename STEP>
+	num_type stage1(num_type n, num_type &x, num_type c, STEP &&step) const {
+		const std::vector<uint64_t> &pows = plan.stage1_pows;
+		for (size_t i=0; i<pows.size(); i+=GCD_BATCH) {
+			const size_t end = std::min(i + GCD_BATCH, pows.size());
+			const num_type saved = x;
+			for (size_t k=i; k<end; ++k) x = step(x, pows[k]);
+			num_type g = rho_factorizer_type::gcd(sub_mod(n, x, c), n);
+			if (g == 1) continue;
+			if (g == n) {
+				// batch overshot, repeat it prime power by prime power
+				x = saved;
+				g = 1;
+				for (size_t k=i; k<end && g == 1; ++k) {
+					x = step(x, pows[k]);
+					g = rho_factorizer_type::gcd(sub_mod(n, x, c), n);
+				}
+			}
+			return g;
+		}
+		return 1;
+	}
+
+	// stage 2 from p == a + 1/a, returns divisor of n, 1 or n
+	num_type stage2(num_type n, num_type p) const {
+		// baby steps V_j for odd j: V_{j+2} == V_j * V_2 - V_{j-2}
+		const num_type v2 = sub_mod(n, mul_mod_type::square_mod(n, p), 2);
+		num_type babies[StagesPlan::BABY_COUNT];
+		uint_fast16_t babies_count = 0;
+		num_type prev = p, cur = sub_mod(n, mul_mod_type::mul_mod(n, p, v2), p);
+		babies[babies_count++] = p;
+		for (uint64_t j=3; j<StagesPlan::D/2; j+=2) {
+			if (StagesPlan::is_baby(j)) babies[babies_count++] = cur;
+			const num_type next = sub_mod(n, mul_mod_type::mul_mod(n, cur, v2), prev);
+			prev = cur;
+			cur = next;
+		}
+		assert(babies_count == StagesPlan::BABY_COUNT);
+
+		// giant steps V_{m*D}: V_{(m+1)*D} == V_{m*D} * V_D - V_{(m-1)*D}
+		const num_type vd = lucas_v(n, p, StagesPlan::D);
+		num_type g = lucas_v(n, vd, plan.m_begin), g_next = lucas_v(n, vd, plan.m_begin + 1);
+		num_type acc = 1;
+		const size_t steps_count = plan.steps_count();
+		for (size_t i=0; i<steps_count; ++i) {
+			for (uint_fast16_t w=0; w<StagesPlan::BABY_WORDS; ++w) {
+				for (uint64_t bits=plan.stage2_pairs[i * StagesPlan::BABY_WORDS + w]; bits!=0; bits&=bits-1) {
+					acc = mul_mod_type::mul_mod(n, acc, sub_mod(n, g, babies[w * 64 + __builtin_ctzll(bits)]));
+				}
+			}
+			const num_type next = sub_mod(n, mul_mod_type::mul_mod(n, g_next, vd), g);
+			g = g_next;
+			g_next = next;
+		}
+		return rho_factorizer_type::gcd(acc, n);
+	}
+
+public:
+	// a^-1 modulo n, gcd(a, n) == 1
+	static num_type inv_mod(num_type a, num_type n) {
+		num_type r0 = n, r1 = a % n, t0 = 0, t1 = 1;
+		while (r1 != 0) {
+			const num_type q = r0 / r1;
+			const num_type r = r0 - q * r1;
+			r0 = r1;
+			r1 = r;
+			const num_type t = sub_mod(n, t0, mul_mod_type::mul_mod(n, q % n, t1));
+			t0 = t1;
+			t1 = t;
+		}
+		assert(r0 == 1);
+		return t0;
+	}
+
+	// V_k(p) of Lucas sequence V_0 == 2, V_1 == p, V_{i+1} == p * V_i - V_{i-1} modulo n, n > 2, k > 0
+	static num_type lucas_v(num_type n, num_type p, uint64_t k) {
+		assert(n > 2 && k > 0);
+		// v1 == V_{i+1} for v0 == V_i
+		num_type v0 = p, v1 = sub_mod(n, mul_mod_type::square_mod(n, p), 2);
+		for (int_fast8_t i=62-__builtin_clzll(k); i>=0; --i) {
+			const num_type v = sub_mod(n, mul_mod_type::mul_mod(n, v0, v1), p);
+			if ((k >> i) & 1) {
+				v0 = v;
+				v1 = sub_mod(n, mul_mod_type::square_mod(n, v1), 2);
+			} else {
+				v1 = v;
+				v0 = sub_mod(n, mul_mod_type::square_mod(n, v0), 2);
+			}
+		}
+		return v0;
+	}
+
+	// p - 1, n - odd, n > 2
+	// returns divisor of n, 1 or n if method failed
+	num_type pm1(num_type n) const {
+		assert((n & 1) && n > 2);
+		num_type x = 2;
+		const num_type g = stage1(n, x, 1, [n] (num_type x, uint64_t pow) -> num_type {
+			return mul_mod_type::pow_mod(n, x, (num_type)pow);
+		});
+		if (g != 1) return g;
+		return stage2(n, add_mod(n, x, inv_mod(x, n)));
+	}
+
+	// p + 1 of seed p, n - odd, n > 2
+	// returns divisor of n, 1 or n if method failed
+	num_type pp1(num_type n, num_type p) const {
+		assert((n & 1) && n > 2);
+		num_type v = p % n;
+		const num_type g = stage1(n, v, 2, [n] (num_type v, uint64_t pow) -> num_type {
+			return lucas_v(n, v, pow);
+		});
+		if (g != 1) return g;
+		return stage2(n, v);
+	}
+
+	// n - odd composite, n > 2
+	// runs p - 1 and p + 1 of every seed, returns n if all of them failed
+	num_type find_divisor(num_type n) const {
+		num_type d = pm1(n);
+		if (d != 1 && d != n) return d;
+		for (uint_fast8_t i=0; i<PP1_SEEDS_COUNT; ++i) {
+			d = pp1(n, PP1_SEEDS[i]);
+			if (d != 1 && d != n) return d;
+		}
+		return n;
+	}
+};
+
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+constexpr NUM_TYPE PollardPM1<NUM_TYPE, NUM_TYPE_MAX_MASK, OPERATION_TYPE>::PP1_SEEDS[];
+
+#endif/*POLLARD_PM1_H*/
@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "pollard_pm1.h"
+#include "ecm.h"
+
+typedef PollardPM1<uint128_t, ((uint128_t)1)<<127, uint128_t> pm1_type;
+typedef EcmFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> ecm_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!ecm_type::is_prime(n)) ++n;
+	return n;
+}
+
+// prime p of about bits bits, p - 1 is 2 * distinct odd primes < 1000 and prime in (B1, B2]
+uint128_t smooth_prime(std::mt19937_64 &rng, uint_fast8_t bits) {
+	while (true) {
+		uint128_t k = 2 * next_prime(pm1_type::DEFAULT_B1 + rng() % (pm1_type::DEFAULT_B2 - pm1_type::DEFAULT_B1));
+		while (128 - UnsignedOps<uint128_t>::clz(k) < bits) {
+			const uint64_t t = rng() % 1000;
+			if (t > 2 && ecm_type::is_prime(t) && k % t != 0) k *= t;
+		}
+		if (ecm_type::is_prime(k + 1)) return k + 1;
+	}
+}
+
+// seconds per number, fn(n) returns divisor of n
+template <typename FN>
+double bench(const std::vector<uint128_t> &numbers, FN &&fn) {
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		const uint128_t d = fn(numbers[i]);
+		assert(numbers[i] % d == 0);
+	}
+	return (get_time() - t0) / numbers.size();
+}
+
+int main() {
+	pm1_type::primes_array_type primes;
+	pm1_type pm1(primes);
+	ecm_type ecm_factorizer(primes);
+	std::mt19937_64 rng(1);
+
+	// cost of failed pre-pass: n == p * q of balanced primes
+	printf("cost of pre-pass, B1 = %llu, B2 = %llu, seconds per number\n",
+		(unsigned long long)pm1_type::DEFAULT_B1, (unsigned long long)pm1_type::DEFAULT_B2);
+	printf("%-8s %10s %10s %10s\n", "n bits", "p - 1", "p + 1", "both");
+	const uint_fast8_t bits[] = {64, 96, 128};
+	for (size_t b=0; b<sizeof(bits)/sizeof(bits[0]); ++b) {
+		std::vector<uint128_t> numbers(8);
+		for (size_t i=0; i<numbers.size(); ++i) {
+			const uint_fast8_t half = bits[b] / 2;
+			const uint128_t p = next_prime((rng() >> (65 - half)) | ((uint128_t)1 << (half - 1)));
+			const uint128_t q = next_prime((rng() >> (64 - half)) | ((uint128_t)1 << (half - 1)));
+			numbers[i] = p * q;
+		}
+		printf("%-8u %10.6f %10.6f %10.6f\n", (unsigned int)bits[b],
+			bench(numbers, [&pm1] (uint128_t n) { return pm1.pm1(n); }),
+			bench(numbers, [&pm1] (uint128_t n) { return pm1.pp1(n, pm1_type::PP1_SEEDS[0]); }),
+			bench(numbers, [&pm1] (uint128_t n) { return pm1.find_divisor(n); }));
+	}
+
+	// p - 1 of factor is smooth: pre-pass against curves
+	printf("\nn of 120 bits == p * q, p - 1 is smooth, seconds per number\n");
+	printf("%-8s %10s %10s\n", "p bits", "p - 1", "ECM");
+	const uint_fast8_t p_bits[] = {48, 56, 64};
+	for (size_t b=0; b<sizeof(p_bits)/sizeof(p_bits[0]); ++b) {
+		std::vector<uint128_t> numbers(8);
+		for (size_t i=0; i<numbers.size(); ++i) {
+			const uint128_t p = smooth_prime(rng, p_bits[b]);
+			numbers[i] = p * next_prime((((uint128_t)rng() << 64) | rng()) >> (UnsignedOps<uint128_t>::clz(p) + 8));
+		}
+		printf("%-8u %10.6f %10.6f\n", (unsigned int)p_bits[b],
+			bench(numbers, [&pm1] (uint128_t n) { return pm1.pm1(n); }),
+			bench(numbers, [&ecm_factorizer] (uint128_t n) { return ecm_factorizer.find_divisor(n); }));
+	}
+	return 0;
+}
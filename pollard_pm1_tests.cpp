@@ -0,0 +1,150 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <random>
+#include "pollard_pm1.h"
+#include "miller_rabin.h"
+#include "ecm.h"
+
+typedef PollardPM1<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> pm1_type;
+typedef PollardPM1<uint128_t, ((uint128_t)1)<<127, uint128_t> pm1_128_type;
+typedef MillerRabin<uint128_t, ((uint128_t)1)<<127, uint128_t> mr_type;
+typedef EcmFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> ecm_fzr_type;
+
+// prime p of about bits bits, p - 1 (sign == -1) or p + 1 (sign == 1) is 2 * q * distinct odd primes < 1000
+uint128_t smooth_prime(std::mt19937_64 &rng, uint_fast8_t bits, int sign, uint64_t q) {
+	while (true) {
+		uint128_t k = 2 * q;
+		while (128 - UnsignedOps<uint128_t>::clz(k) < bits) {
+			const uint64_t t = rng() % 1000;
+			if (t > 2 && mr_type::is_prime(t) && k % t != 0) k *= t;
+		}
+		const uint128_t p = (sign < 0 ? k + 1 : k - 1);
+		if (mr_type::is_prime(p)) return p;
+	}
+}
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!mr_type::is_prime(n)) ++n;
+	return n;
+}
+
+void test_plan() {
+	pm1_type::primes_array_type primes;
+	pm1_type pm1(primes, 10000, 100000);
+	const StagesPlan &plan = pm1.get_plan();
+	// pi(10^4) == 1229, pi(10^5) == 9592
+	assert(plan.stage1_pows.size() == 1229);
+	assert(plan.stage1_pows[0] == 8192 && plan.stage1_pows[1] == 6561 && plan.stage1_pows[1228] == 9973);
+	size_t pairs_count = 0;
+	for (size_t i=0; i<plan.stage2_pairs.size(); ++i) pairs_count += __builtin_popcountll(plan.stage2_pairs[i]);
+	// a few pairs (m, j) cover both m*D - j and m*D + j
+	assert(pairs_count <= 9592 - 1229 && pairs_count > (9592 - 1229) / 2);
+	assert(plan.steps_count() == (100000 + StagesPlan::D / 2) / StagesPlan::D + 1 - plan.m_begin);
+
+	// B1 < D / 2: primes in (B1, D / 2] go to stage 1 once, pi(100) == 25, pi(1155) == 191, pi(5000) == 669
+	const StagesPlan small_plan(primes, 100, 5000);
+	assert(small_plan.stage1_pows.size() == 191);
+	assert(small_plan.stage1_pows[0] == 64 && small_plan.stage1_pows[25] == 101 && small_plan.stage1_pows[190] == 1153);
+	assert(small_plan.m_begin == 1);
+	pairs_count = 0;
+	for (size_t i=0; i<small_plan.stage2_pairs.size(); ++i) pairs_count += __builtin_popcountll(small_plan.stage2_pairs[i]);
+	assert(pairs_count <= 669 - 191 && pairs_count > (669 - 191) / 2);
+	// no stage 2
+	const StagesPlan tiny_plan(primes, 10, 100);
+	assert(tiny_plan.stage1_pows.size() == 25 && tiny_plan.steps_count() == 0);
+}
+
+void test_lucas() {
+	const uint_fast64_t n = 1000003 * 1000033ULL;
+	// inverse
+	for (uint_fast64_t a=2; a<100; ++a) assert((uint128_t)a * pm1_type::inv_mod(a, n) % n == 1);
+	// V_k by recurrence
+	const uint_fast64_t p = 123456789;
+	uint_fast64_t v0 = 2, v1 = p;
+	for (uint64_t k=1; k<=1000; ++k) {
+		assert(pm1_type::lucas_v(n, p, k) == v1);
+		const uint_fast64_t v2 = (uint_fast64_t)(((uint128_t)p * v1 + n - v0) % n);
+		v0 = v1;
+		v1 = v2;
+	}
+	// V_{a*b}(P) == V_a(V_b(P))
+	assert(pm1_type::lucas_v(n, pm1_type::lucas_v(n, p, 77), 2310) == pm1_type::lucas_v(n, p, 77 * 2310));
+}
+
+void test_pm1() {
+	pm1_128_type::primes_array_type primes;
+	pm1_128_type pm1(primes);
+	std::mt19937_64 rng(1);
+	for (uint_fast8_t i=0; i<8; ++i) {
+		// p - 1 is B1-smooth (stage 1) or has one prime in (B1, B2] (stage 2)
+		const uint64_t q = (i & 1 ? 150001 : 1);
+		const uint128_t p = smooth_prime(rng, 56, -1, q);
+		const uint128_t r = next_prime(rng() >> 4);
+		assert(pm1.pm1(p * r) == p);
+		assert(pm1.find_divisor(p * r) == p);
+	}
+	// cheap pre-pass with B1 < D: p - 1 == 2 * 3 * 5 * 7 * q * k
+	pm1_128_type small_pm1(primes, 100, 5000);
+	for (uint64_t q : {389, 1999, 4999}) {
+		uint128_t p = 0;
+		for (uint64_t k=1; p == 0; ++k) {
+			if (mr_type::is_prime(210 * q * k + 1)) p = 210 * q * k + 1;
+		}
+		const uint128_t r = next_prime(rng() >> 4);
+		assert(small_pm1.pm1(p * r) == p);
+	}
+	// every prime of 16 bits is found by stage 1: batch overshot is repeated prime power by prime power
+	const uint128_t d = pm1.pm1((uint128_t)65521 * 65519);
+	assert(d == 65521 || d == 65519);
+}
+
+void test_pp1() {
+	pm1_128_type::primes_array_type primes;
+	pm1_128_type pm1(primes);
+	std::mt19937_64 rng(2);
+	size_t found_count = 0;
+	for (uint_fast8_t i=0; i<16; ++i) {
+		const uint64_t q = (i & 1 ? 150001 : 1);
+		const uint128_t p = smooth_prime(rng, 56, 1, q);
+		const uint128_t r = next_prime(rng() >> 4);
+		// p + 1 is found by seed P iff P^2 - 4 is not quadratic residue modulo p
+		bool found = false;
+		for (uint_fast8_t j=0; j<pm1_128_type::PP1_SEEDS_COUNT; ++j) {
+			const uint128_t d = pm1.pp1(p * r, pm1_128_type::PP1_SEEDS[j]);
+			assert(d == p || d == 1);
+			found |= (d == p);
+		}
+		assert(pm1.find_divisor(p * r) == (found ? p : p * r));
+		found_count += found;
+	}
+	assert(found_count >= 8);
+}
+
+void test_factorize() {
+	ecm_fzr_type::primes_array_type primes;
+	ecm_fzr_type ecm_factorizer(primes);
+	std::mt19937_64 rng(3);
+	// two factors of 56 bits are too much for a few curves, p - 1 finds them at once
+	const uint128_t p = smooth_prime(rng, 56, -1, 1), q = smooth_prime(rng, 56, -1, 150001);
+	const uint128_t n = p * q * 7;
+	uint128_t m = 1;
+	uint_fast8_t count = 0;
+	ecm_factorizer.factorize(n, [&m, &count] (uint128_t prime, ecm_fzr_type::exp_type exp) -> bool {
+		assert(exp == 1 && ecm_fzr_type::is_prime(prime));
+		m *= prime;
+		++count;
+		return false;
+	});
+	assert(m == n && count == 3);
+}
+
+int main() {
+	test_plan();
+	test_lucas();
+	test_pm1();
+	test_pp1();
+	test_factorize();
+	return 0;
+}
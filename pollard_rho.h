@@ -0,0 +1,172 @@
+#ifndef POLLARD_RHO_H
+#define POLLARD_RHO_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <algorithm>
+#include "factorize.h"
+#include "mul_mod.h"
+#include "miller_rabin.h"
+
+// Hybrid factorization: trial division by primes <= trial_bound,
+// then Brent's variant of Pollard's rho for the rest of cofactor.
+// Prime factors are passed to cb in ascending order like Factorizer does,
+// so RhoFactorizer may be used as FACTORIZER_TYPE of CanonicFactorsTemplate and checkers.
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class RhoFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef Factorizer<num_type> trial_factorizer_type;
+	typedef typename trial_factorizer_type::primes_array_type primes_array_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename trial_factorizer_type::factorize_cb_type factorize_cb_type;
+	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	typedef MillerRabin<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> miller_rabin_type;
+	static constexpr num_type DEFAULT_TRIAL_BOUND = 1024;
+	// gcd is computed once per GCD_BATCH steps
+	static constexpr uint_fast16_t GCD_BATCH = 128;
+
+private:
+	// every cofactor prime > 2, so there are fewer of them than bits in num_type
+	static constexpr uint_fast16_t MAX_FACTORS_COUNT = sizeof(num_type) * 8;
+
+	trial_factorizer_type trial_factorizer;
+	factorize_cb_type cb;
+	num_type trial_bound;
+
+public:
+	RhoFactorizer(primes_array_type b_primes_array, factorize_cb_type b_cb, num_type b_trial_bound = DEFAULT_TRIAL_BOUND) :
+		trial_factorizer(b_primes_array), cb(b_cb), trial_bound(b_trial_bound) {
+		assert(trial_bound >= 2);
+	}
+	
+	// only factorize method with callback argument may be used
+	RhoFactorizer(primes_array_type b_primes_array, num_type b_trial_bound = DEFAULT_TRIAL_BOUND) :
+		trial_factorizer(b_primes_array), trial_bound(b_trial_bound) {
+		assert(trial_bound >= 2);
+	}
+
+	// use default copy constructor and assignment operator
+
+	primes_array_type get_primes_array() const {
+		return trial_factorizer.get_primes_array();
+	}
+
+	static num_type gcd(num_type a, num_type b) {
+		if (a == 0) return b;
+		if (b == 0) return a;
+		typedef UnsignedOps<num_type> ops_type;
+		uint_fast8_t shift = ops_type::ctz(a | b);
+		a >>= ops_type::ctz(a);
+		do {
+			b >>= ops_type::ctz(b);
+			if (a > b) std::swap(a, b);
+			b -= a;
+		} while (b != 0);
+		return a << shift;
+	}
+
+	// Miller-Rabin test, deterministic for n < 3.3 * 10^24
+	static bool is_prime(num_type n) {
+		return miller_rabin_type::is_prime(n);
+	}
+
+	// x^2 + c mod n
+	static num_type rho_step(num_type n, num_type x, num_type c) {
+		x = mul_mod_type::square_mod(n, x);
+		return (x >= n - c ? x - (n - c) : x + c);
+	}
+
+	static num_type abs_diff(num_type a, num_type b) {
+		return (a > b ? a - b : b - a);
+	}
+
+	// Brent's variant of Pollard's rho with f(x) = x^2 + c, 0 < c < n-2
+	// n - odd composite
+	// returns divisor of n, may be n itself if search failed
+	static num_type brent(num_type n, num_type c) {
+		assert(n > 3 && (n & 1));
+		num_type x = 2, y = 2, ys = 2, q = 1, g = 1;
+		for (uint_fast64_t r=1; g == 1; r <<= 1) {
+			x = y;
+			for (uint_fast64_t i=0; i<r; ++i) y = rho_step(n, y, c);
+			for (uint_fast64_t k=0; k<r && g == 1; k+=GCD_BATCH) {
+				ys = y;
+				const uint_fast64_t steps = std::min<uint_fast64_t>(GCD_BATCH, r - k);
+				for (uint_fast64_t i=0; i<steps; ++i) {
+					y = rho_step(n, y, c);
+					q = mul_mod_type::mul_mod(n, q, abs_diff(x, y));
+				}
+				g = gcd(q, n);
+			}
+		}
+		if (g == n) {
+			// batch overshot, repeat it step by step
+			do {
+				ys = rho_step(n, ys, c);
+				g = gcd(abs_diff(x, ys), n);
+			} while (g == 1);
+		}
+		return g;
+	}
+
+	// n - odd composite
+	static num_type find_divisor(num_type n) {
+		for (num_type c=1;; ++c) {
+			num_type d = brent(n, c);
+			if (d != n) return d;
+		}
+	}
+
+	// if cb returns true, factorize interrupts
+	// CB - callable as bool(num_type prime, exp_type exp)
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		assert(n > 0);
+		if (trial_factorizer.trial_division(n, trial_bound, cb)) return;
+		if (n == 1) return;
+		// all prime factors of n are > trial_bound
+		if (n / trial_bound < trial_bound || is_prime(n)) {
+			cb(n, 1);
+			return;
+		}
+
+		num_type factors[MAX_FACTORS_COUNT];
+		uint_fast16_t factors_count = 0;
+		num_type composites[MAX_FACTORS_COUNT];
+		uint_fast16_t composites_count = 0;
+		composites[composites_count++] = n;
+		while (composites_count > 0) {
+			num_type m = composites[--composites_count];
+			if (is_prime(m)) {
+				assert(factors_count < MAX_FACTORS_COUNT);
+				factors[factors_count++] = m;
+				continue;
+			}
+			num_type d = find_divisor(m);
+			assert(composites_count + 2 <= MAX_FACTORS_COUNT);
+			composites[composites_count++] = d;
+			composites[composites_count++] = m / d;
+		}
+
+		std::sort(factors, factors + factors_count);
+		for (uint_fast16_t i=0; i<factors_count;) {
+			num_type p = factors[i];
+			exp_type exp = 0;
+			do {
+				++exp;
+				++i;
+			} while (i < factors_count && factors[i] == p);
+			if (cb(p, exp)) return;
+		}
+	}
+
+	// std::function adapter
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+};
+
+#endif/*POLLARD_RHO_H*/
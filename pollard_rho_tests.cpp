@@ -0,0 +1,251 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "pollard_rho.h"
+#include "canonic_factors.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+typedef RhoFactorizer<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> rho_fzr_type;
+typedef RhoFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> rho128_fzr_type;
+
+struct MyPow {
+	uint_fast64_t prime;
+	uint_fast8_t exp;
+};
+
+struct MyFactors {
+	uint_fast8_t pow_count;
+	MyPow pows[16];
+};
+
+rho_fzr_type::factorize_cb_type make_cb(MyFactors &factors) {
+	return [&factors] (rho_fzr_type::num_type prime, rho_fzr_type::exp_type exp) -> bool {
+		assert(factors.pow_count < 16);
+		factors.pows[factors.pow_count].prime = prime;
+		factors.pows[factors.pow_count].exp = exp;
+		++factors.pow_count;
+		return false;
+	};
+}
+
+bool my_is_prime(uint_fast64_t n) {
+	if (n < 2) return false;
+	for (uint_fast64_t d=2; d<=n/d; ++d) {
+		if (n % d == 0) return false;
+	}
+	return true;
+}
+
+void test_is_prime() {
+	for (uint_fast64_t n=0; n<1024*64; ++n) {
+		assert(rho_fzr_type::is_prime(n) == my_is_prime(n));
+	}
+	for (uint_fast64_t n=UINT32_MAX-1024*4; n<(uint_fast64_t)UINT32_MAX+1024*4; ++n) {
+		assert(rho_fzr_type::is_prime(n) == my_is_prime(n));
+	}
+	// strong pseudoprimes to several small bases
+	assert(!rho_fzr_type::is_prime(3215031751ULL));
+	assert(!rho_fzr_type::is_prime(4759123141ULL));
+	assert(!rho_fzr_type::is_prime(3825123056546413051ULL));
+	assert(!rho_fzr_type::is_prime(341550071728321ULL));
+	assert(rho_fzr_type::is_prime(18446744073709551557ULL));		// largest 64-bit prime
+	assert(!rho_fzr_type::is_prime(18446744073709551559ULL));
+}
+
+void test_factorize_small() {
+	typedef Factorizer<uint_fast64_t> fzr_type;
+	MyFactors factors, my_factors;
+	rho_fzr_type::primes_array_type primes;
+	// small trial bound forces rho on small numbers
+	rho_fzr_type rho_factorizer(primes, make_cb(factors), 5);
+	fzr_type factorizer(primes, [&my_factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+		my_factors.pows[my_factors.pow_count].prime = prime;
+		my_factors.pows[my_factors.pow_count].exp = exp;
+		++my_factors.pow_count;
+		return false;
+	});
+
+	for (uint_fast64_t i=1; i<=1024*64+1; ++i) {
+		factors.pow_count = my_factors.pow_count = 0;
+		rho_factorizer.factorize(i);
+		factorizer.factorize(i);
+		assert(factors.pow_count == my_factors.pow_count);
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(factors.pows[j].prime == my_factors.pows[j].prime);
+			assert(factors.pows[j].exp == my_factors.pows[j].exp);
+		}
+	}
+}
+
+void test_factorize_semiprimes() {
+	typedef PrimesArray<uint_fast64_t> primes_array_type;
+	uint_fast64_t primes[1024];
+	size_t primes_count = primes_array_type::fill_primes(primes, 1024, UINT64_MAX);
+	MyFactors factors;
+	rho_fzr_type rho_factorizer(primes_array_type(primes, primes_count), make_cb(factors));
+
+	// primes just below 2^32
+	const uint_fast64_t big_primes[] = {4294967291ULL, 4294967279ULL, 4294967231ULL, 4294967197ULL, 4294967189ULL};
+	const size_t big_count = sizeof(big_primes) / sizeof(big_primes[0]);
+	for (size_t i=0; i<big_count; ++i) {
+		for (size_t j=i; j<big_count; ++j) {
+			factors.pow_count = 0;
+			rho_factorizer.factorize(big_primes[i] * big_primes[j]);
+			if (i == j) {
+				assert(factors.pow_count == 1);
+				assert(factors.pows[0].prime == big_primes[i] && factors.pows[0].exp == 2);
+			} else {
+				assert(factors.pow_count == 2);
+				assert(factors.pows[0].prime == big_primes[j] && factors.pows[0].exp == 1);
+				assert(factors.pows[1].prime == big_primes[i] && factors.pows[1].exp == 1);
+			}
+		}
+	}
+
+	// 2^64 - 1 = 3 * 5 * 17 * 257 * 641 * 65537 * 6700417
+	factors.pow_count = 0;
+	rho_factorizer.factorize(UINT64_MAX);
+	const uint_fast64_t my_primes[] = {3, 5, 17, 257, 641, 65537, 6700417};
+	assert(factors.pow_count == 7);
+	for (uint_fast8_t j=0; j<7; ++j) {
+		assert(factors.pows[j].prime == my_primes[j] && factors.pows[j].exp == 1);
+	}
+
+	// 1000003^2 * 1000033
+	factors.pow_count = 0;
+	rho_factorizer.factorize(1000003ULL * 1000003ULL * 1000033ULL);
+	assert(factors.pow_count == 2);
+	assert(factors.pows[0].prime == 1000003 && factors.pows[0].exp == 2);
+	assert(factors.pows[1].prime == 1000033 && factors.pows[1].exp == 1);
+}
+
+void test_factorize_rand() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	unsigned int seed = (unsigned int)tv.tv_sec * 1000000 + tv.tv_usec;
+	fprintf(stderr, "seed = %u\n", seed);
+	srand(seed);
+
+	MyFactors factors;
+	rho_fzr_type::primes_array_type primes;
+	rho_fzr_type rho_factorizer(primes, make_cb(factors));
+	for (uint_fast16_t i=0; i<1024; ++i) {
+		uint_fast64_t n = 0;
+		for (uint_fast8_t j=0; j<4; ++j) n = (n << 16) ^ (rand() & 0xffff);
+		if (n == 0) continue;
+		factors.pow_count = 0;
+		rho_factorizer.factorize(n);
+		uint_fast64_t m = 1;
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(j == 0 || factors.pows[j-1].prime < factors.pows[j].prime);
+			assert(rho_fzr_type::is_prime(factors.pows[j].prime));
+			for (uint_fast8_t k=0; k<factors.pows[j].exp; ++k) m *= factors.pows[j].prime;
+		}
+		assert(m == n);
+	}
+}
+
+void test_with_canonic_factors() {
+	typedef CanonicFactorsTemplate<uint_fast64_t, 15, rho_fzr_type> cft_type;
+	cft_type::CanonicFactorizer cfzr;
+	cft_type::CanonicFactors a(cfzr);
+	for (uint_fast64_t i=UINT64_MAX; i>=UINT64_MAX-1024; --i) {
+		a.assign(i);
+		assert(a.value() == i);
+	}
+
+	rho_fzr_type::primes_array_type primes;
+	PrimeChecker<uint_fast64_t, rho_fzr_type> prime_checker(primes);
+	DivisorsCounter<uint_fast64_t, rho_fzr_type> divisors_counter(primes);
+	assert(prime_checker.is_prime(18446744073709551557ULL));
+	assert(!prime_checker.is_prime(4294967291ULL * 4294967279ULL));
+	assert(divisors_counter.divisors_count(4294967291ULL * 4294967279ULL) == 4);
+	assert(divisors_counter.divisors_count(UINT64_MAX) == 128);
+}
+
+struct MyPow128 {
+	uint128_t prime;
+	uint_fast8_t exp;
+};
+
+void test_factorize_128() {
+	MyPow128 factors[16];
+	uint_fast8_t pow_count = 0;
+	auto cb = [&factors, &pow_count] (uint128_t prime, rho128_fzr_type::exp_type exp) -> bool {
+		assert(pow_count < 16);
+		factors[pow_count].prime = prime;
+		factors[pow_count].exp = exp;
+		++pow_count;
+		return false;
+	};
+	rho128_fzr_type::primes_array_type primes;
+	rho128_fzr_type rho_factorizer(primes);
+
+	// (2^39 + 151) * (2^40 + 15) > 2^64
+	const uint128_t p39 = 549755813911ULL, p40 = 1099511627791ULL;
+	rho_factorizer.factorize(p39 * p40, cb);
+	assert(pow_count == 2);
+	assert(factors[0].prime == p39 && factors[0].exp == 1);
+	assert(factors[1].prime == p40 && factors[1].exp == 1);
+
+	// (2^32 - 5) * (2^90 + 133)
+	const uint128_t p90 = ((uint128_t)1 << 90) + 133;
+	pow_count = 0;
+	rho_factorizer.factorize(4294967291ULL * p90, cb);
+	assert(pow_count == 2);
+	assert(factors[0].prime == 4294967291ULL && factors[0].exp == 1);
+	assert(factors[1].prime == p90 && factors[1].exp == 1);
+
+	// 2^128 - 1 = 3 * 5 * 17 * 257 * 641 * 65537 * 274177 * 6700417 * 67280421310721
+	pow_count = 0;
+	rho_factorizer.factorize(~(uint128_t)0, cb);
+	const uint_fast64_t my_primes[] = {3, 5, 17, 257, 641, 65537, 274177, 6700417, 67280421310721ULL};
+	assert(pow_count == 9);
+	for (uint_fast8_t j=0; j<9; ++j) assert(factors[j].prime == my_primes[j] && factors[j].exp == 1);
+
+	// products of random numbers < 2^30
+	srand(1);
+	for (uint_fast16_t i=0; i<256; ++i) {
+		uint128_t n = 1;
+		for (uint_fast8_t j=0; j<4; ++j) n *= (uint128_t)((rand() & 0x3fffffff) | 1);
+		pow_count = 0;
+		rho_factorizer.factorize(n, cb);
+		uint128_t m = 1;
+		for (uint_fast8_t j=0; j<pow_count; ++j) {
+			assert(j == 0 || factors[j-1].prime < factors[j].prime);
+			assert(rho128_fzr_type::is_prime(factors[j].prime));
+			for (uint_fast8_t k=0; k<factors[j].exp; ++k) m *= factors[j].prime;
+		}
+		assert(m == n);
+	}
+
+	// with canonic factors and checkers
+	typedef CanonicFactorsTemplate<uint128_t, 15, rho128_fzr_type> cft_type;
+	cft_type::CanonicFactorizer cfzr;
+	cft_type::CanonicFactors a(cfzr, ~(uint128_t)0);
+	assert(a.value() == ~(uint128_t)0);
+	a.assign(p39 * p40 * 3 * 3);
+	assert(a.value() == p39 * p40 * 9);
+	DivisorsCounter<uint128_t, rho128_fzr_type> divisors_counter(primes);
+	assert(divisors_counter.divisors_count(~(uint128_t)0) == 512);
+	PrimeChecker<uint128_t, rho128_fzr_type> prime_checker(primes);
+	assert(prime_checker.is_prime(p90));
+	assert(!prime_checker.is_prime(p39 * p40));
+}
+
+void tests_suite() {
+	test_is_prime();
+	test_factorize_small();
+	test_factorize_semiprimes();
+	test_factorize_rand();
+	test_with_canonic_factors();
+	test_factorize_128();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef PRIMES_COUNT_H
+#define PRIMES_COUNT_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "primes_sieve.h"
+#include "thread_pool.h"
+
+// Prime-counting function pi(x) by Lucy_Hedgehog method, O(x^(3/4)) time, O(sqrt(x)) memory.
+// S(v) - count of numbers in [2, v] which are primes or have no prime factor < p,
+// it is kept for every v == x / i: small[v] for v <= sqrt(x), large[i] for i <= sqrt(x).
+// Sieving by every prime p <= sqrt(x) (taken from PrimesSieve) is
+//     S(v) -= S(v / p) - pi(p - 1), for every v >= p^2,
+// and S(x) == pi(x) at the end.
+// Update of v reads S(v / p) only, so updates of v in (v_high / p, v_high] are independent:
+// such bands are split between workers of WorkStealingPool if they are long enough.
+template <typename NUM_TYPE>
+class PrimesCounter {
+public:
+	typedef NUM_TYPE num_type;
+	// band is split between workers if it has at least so many values
+	static constexpr size_t DEFAULT_PARALLEL_THRESHOLD = 64*1024;
+	// values per task of pool
+	static constexpr size_t CHUNK_SIZE = 8*1024;
+
+private:
+	WorkStealingPool *pool;
+	size_t parallel_threshold;
+	// [v] - S(v), v <= sqrt(x)
+	std::vector<num_type> small;
+	// [i] - S(x / i), i <= sqrt(x), [0] is not used
+	std::vector<num_type> large;
+
+	PrimesCounter(const PrimesCounter &b) = delete;
+	PrimesCounter& operator=(const PrimesCounter &b) = delete;
+
+public:
+	// pool - NULL for counting in calling thread
+	PrimesCounter(WorkStealingPool *b_pool = NULL, size_t b_parallel_threshold = DEFAULT_PARALLEL_THRESHOLD) :
+		pool(b_pool), parallel_threshold(b_parallel_threshold) {
+		assert(parallel_threshold > 0);
+	}
+
+	// count of primes <= x
+	num_type count(num_type x) {
+		if (x < 2) return 0;
+		const num_type r = (num_type)PrimesSieve<num_type>::isqrt(x);
+		small.resize((size_t)r + 1);
+		large.resize((size_t)r + 1);
+		small[0] = 0;
+		for (num_type v=1; v<=r; ++v) small[v] = v - 1;
+		for (num_type i=1; i<=r; ++i) large[i] = x / i - 1;
+
+		num_type primes_before = 0;
+		PrimesSieve<num_type> sieve;
+		sieve.for_each_prime(2, r, [this, x, r, &primes_before] (num_type p) -> bool {
+			sieve_prime(x, r, p, primes_before);
+			++primes_before;
+			return false;
+		});
+		return large[1];
+	}
+
+private:
+	// calls fn(begin, end) for [begin, end) by pool if the range is long enough
+	template <typename FN>
+	void run_band(size_t begin, size_t end, FN &&fn) {
+		if (pool == NULL || pool->get_threads_count() == 1 || end - begin < parallel_threshold) {
+			fn(begin, end);
+			return;
+		}
+		pool->run((end - begin + CHUNK_SIZE - 1) / CHUNK_SIZE, [begin, end, &fn] (size_t worker_idx, size_t task_idx) {
+			(void)worker_idx;
+			const size_t chunk_begin = begin + task_idx * CHUNK_SIZE;
+			fn(chunk_begin, std::min(chunk_begin + CHUNK_SIZE, end));
+		});
+	}
+
+	// floor(a / b), b_inv == 1.0 / b, quotient < 2^32:
+	// double estimate is off by at most 1, it is corrected by exact remainder
+	static num_type div_floor(num_type a, num_type b, double b_inv) {
+		num_type q = (num_type)((double)a * b_inv);
+		const num_type rem = a - q * b;
+		if ((int64_t)rem < 0) --q;
+		else if (rem >= b) ++q;
+		return q;
+	}
+
+	// primes_before == pi(p - 1)
+	void sieve_prime(num_type x, num_type r, num_type p, num_type primes_before) {
+		num_type *small_data = small.data();
+		num_type *large_data = large.data();
+		const num_type p2 = p * p;
+		const double p_inv = 1.0 / (double)p;
+
+		// x / i >= p^2, in ascending order of i: large[i] reads large[i * p] or small,
+		// bands [i_begin, i_begin * p) don't read themselves
+		const size_t i_end = (size_t)std::min(r, x / p2) + 1;
+		for (size_t i_begin=1; i_begin<i_end;) {
+			const size_t band_end = (size_t)std::min((num_type)i_end, (num_type)i_begin * p);
+			run_band(i_begin, band_end, [=] (size_t begin, size_t end) {
+				for (size_t i=begin; i<end; ++i) {
+					const num_type d = (num_type)i * p;
+					large_data[i] -= (d <= r ? large_data[d] : small_data[div_floor(x, d, p_inv / (double)i)]) - primes_before;
+				}
+			});
+			i_begin = band_end;
+		}
+
+		// v >= p^2, in descending order of v: bands (v_high / p, v_high] read smaller v only
+		for (num_type v_high=r; v_high>=p2;) {
+			const num_type v_low = std::max(v_high / p + 1, p2);
+			run_band((size_t)v_low, (size_t)v_high + 1, [=] (size_t begin, size_t end) {
+				for (size_t v=begin; v<end; ++v) small_data[v] -= small_data[div_floor(v, p, p_inv)] - primes_before;
+			});
+			v_high = v_low - 1;
+		}
+	}
+};
+
+#endif/*PRIMES_COUNT_H*/
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include "primes_count.h"
+
+typedef PrimesCounter<uint_fast64_t> counter_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void bench(uint_fast64_t x, WorkStealingPool *pool) {
+	counter_type counter(pool);
+	double t0 = get_time();
+	uint_fast64_t pi = counter.count(x);
+	double t = get_time() - t0;
+	printf("pi(%" PRIuFAST64 ") = %" PRIuFAST64 ", %2u threads %10.3f s\n", x, pi, (unsigned int)(pool != NULL ? pool->get_threads_count() : 1), t);
+}
+
+int main() {
+	WorkStealingPool pool;
+	printf("%u hardware threads\n", (unsigned int)pool.get_threads_count());
+	for (uint_fast64_t x=10000000000ULL; x<=10000000000000ULL; x*=10) {
+		bench(x, NULL);
+		bench(x, &pool);
+	}
+	return 0;
+}
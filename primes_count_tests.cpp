@@ -0,0 +1,54 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "primes_count.h"
+
+typedef PrimesCounter<uint_fast64_t> counter_type;
+
+void test_small() {
+	const uint_fast64_t bound = 1024*1024;
+	std::vector<uint_fast64_t> my_pi(bound + 1, 0);
+	PrimesSieve<uint_fast64_t> sieve;
+	sieve.for_each_prime(2, bound, [&my_pi] (uint_fast64_t p) -> bool {
+		my_pi[p] = 1;
+		return false;
+	});
+	for (uint_fast64_t n=1; n<=bound; ++n) my_pi[n] += my_pi[n-1];
+
+	counter_type counter;
+	for (uint_fast64_t x=0; x<=1024; ++x) assert(counter.count(x) == my_pi[x]);
+	// squares of primes and their neighbours
+	for (uint_fast64_t p=2; p*p<=bound; ++p) {
+		if (my_pi[p] == my_pi[p-1]) continue;
+		assert(counter.count(p*p - 1) == my_pi[p*p - 1]);
+		assert(counter.count(p*p) == my_pi[p*p]);
+		if (p*p < bound) assert(counter.count(p*p + 1) == my_pi[p*p + 1]);
+	}
+	for (uint_fast64_t x=bound-256; x<=bound; ++x) assert(counter.count(x) == my_pi[x]);
+}
+
+void test_powers_of_10() {
+	// OEIS A006880
+	const uint_fast64_t pis[] = {0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534, 455052511, 4118054813ULL};
+	counter_type counter;
+	uint_fast64_t x = 1;
+	for (size_t i=0; i<sizeof(pis)/sizeof(pis[0]); ++i, x*=10) assert(counter.count(x) == pis[i]);
+}
+
+void test_pool() {
+	WorkStealingPool pool(3);
+	// small threshold, so that every band is split between workers
+	counter_type pool_counter(&pool, 16), counter;
+	const uint_fast64_t xs[] = {2, 100, 65536, 1000003, 123456789, 10000000000ULL, 99999999977ULL};
+	for (size_t i=0; i<sizeof(xs)/sizeof(xs[0]); ++i) assert(pool_counter.count(xs[i]) == counter.count(xs[i]));
+	assert(pool_counter.count(1000000000ULL) == 50847534);
+}
+
+int main() {
+	test_small();
+	test_powers_of_10();
+	test_pool();
+	printf("Tests passed\n");
+	return 0;
+}
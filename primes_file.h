@@ -0,0 +1,371 @@
+#ifndef PRIMES_FILE_H
+#define PRIMES_FILE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>		// memcmp, memcpy, memset
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "factorize.h"
+#include "primes_sieve.h"
+
+// Binary file of primes table, native byte order, sections are aligned to 64 bytes:
+//     header (PrimesFileHeader), data at data_offset, optional inverses at inverses_offset.
+// FORMAT_ARRAY - primes [2, 3, 5, ...] as elem_size bytes integers and, with FLAG_INVERSES,
+//     PrimeInverse of every prime (inverses[0] for 2 is zero), so file is mapped as PrimesArray as is.
+// FORMAT_WHEEL - mod 30 wheel bitmap of PrimesSieve: bit j of byte i is set if 30*i + wheel_residues[j] is a prime,
+//     primes 2, 3, 5 are not stored, 3.75 numbers per bit.
+// Writers write to path.tmp and rename it, so readers never see partial file.
+struct PrimesFileHeader {
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+	static constexpr uint32_t FORMAT_ARRAY = 1;
+	static constexpr uint32_t FORMAT_WHEEL = 2;
+	static constexpr uint32_t FLAG_INVERSES = 1;
+	static constexpr size_t ALIGNMENT = 64;
+
+	char magic[8];
+	uint32_t version;
+	// BYTE_ORDER_MARK written in native byte order
+	uint32_t byte_order;
+	uint32_t format;
+	// sizeof(num_type) of FORMAT_ARRAY, 1 for FORMAT_WHEEL
+	uint32_t elem_size;
+	uint32_t flags;
+	uint32_t reserved;
+	// count of primes in file
+	uint64_t count;
+	// file has all primes <= max_num
+	uint64_t max_num;
+	uint64_t data_offset;
+	uint64_t data_size;
+	// 0 without FLAG_INVERSES
+	uint64_t inverses_offset;
+
+	static const char *get_magic() {
+		return "PRIMES\x1a\n";
+	}
+
+	static uint64_t align(uint64_t offset) {
+		return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+};
+
+template <typename NUM_TYPE>
+class PrimesFileWriter {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimeInverse<num_type> prime_inverse_type;
+	typedef PrimesSieve<num_type> sieve_type;
+
+private:
+	PrimesFileWriter() = delete;
+
+	static void init_header(PrimesFileHeader &header, uint32_t format, uint32_t elem_size) {
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, PrimesFileHeader::get_magic(), sizeof(header.magic));
+		header.version = PrimesFileHeader::VERSION;
+		header.byte_order = PrimesFileHeader::BYTE_ORDER_MARK;
+		header.format = format;
+		header.elem_size = elem_size;
+		header.data_offset = PrimesFileHeader::align(sizeof(header));
+	}
+
+	static bool write_at(FILE *file, uint64_t offset, const void *data, size_t size) {
+		return fseeko(file, (off_t)offset, SEEK_SET) == 0 && fwrite(data, 1, size, file) == size;
+	}
+
+	// header is written the last, file is renamed after it, is_ok - false if data wasn't written
+	static bool finish(FILE *file, const PrimesFileHeader &header, const std::string &tmp_path, const char *path, bool is_ok) {
+		is_ok = is_ok && write_at(file, 0, &header, sizeof(header));
+		// file ends with the last section even if it is empty
+		const uint64_t file_size = (
+			header.flags & PrimesFileHeader::FLAG_INVERSES ?
+			header.inverses_offset + header.count * sizeof(prime_inverse_type) :
+			header.data_offset + header.data_size
+		);
+		is_ok = is_ok && fflush(file) == 0 && ftruncate(fileno(file), (off_t)file_size) == 0;
+		is_ok = (fclose(file) == 0) && is_ok;
+		is_ok = is_ok && rename(tmp_path.c_str(), path) == 0;
+		if (!is_ok) unlink(tmp_path.c_str());
+		return is_ok;
+	}
+
+	// calls cb for primes in blocks
+	template <typename CB>
+	static void for_each_primes_block(size_t primes_size, num_type max_num, CB cb) {
+		static const size_t BLOCK_SIZE = 64*1024;
+		std::vector<num_type> block;
+		block.reserve(BLOCK_SIZE);
+		size_t count = 0;
+		sieve_type sieve;
+		sieve.for_each_prime(2, max_num, [&] (num_type p) -> bool {
+			block.push_back(p);
+			++count;
+			if (block.size() == BLOCK_SIZE) {
+				cb(block.data(), block.size());
+				block.clear();
+			}
+			return count == primes_size;
+		});
+		if (!block.empty()) cb(block.data(), block.size());
+	}
+
+public:
+	// primes <= max_num, at most primes_size of them, like Factorizer::fill_primes
+	// memory is a block of primes, returns false on i/o error
+	static bool write_array(const char *path, size_t primes_size, num_type max_num, bool with_inverses) {
+		const std::string tmp_path = std::string(path) + ".tmp";
+		FILE *file = fopen(tmp_path.c_str(), "wb");
+		if (file == NULL) return false;
+		PrimesFileHeader header;
+		init_header(header, PrimesFileHeader::FORMAT_ARRAY, sizeof(num_type));
+		header.max_num = max_num;
+
+		bool is_ok = (fseeko(file, (off_t)header.data_offset, SEEK_SET) == 0);
+		num_type last = 0;
+		for_each_primes_block(primes_size, max_num, [&] (const num_type primes[], size_t count) {
+			is_ok = is_ok && fwrite(primes, sizeof(num_type), count, file) == count;
+			header.count += count;
+			last = primes[count-1];
+		});
+		header.data_size = header.count * sizeof(num_type);
+		// primes_size primes are found before max_num
+		if (header.count == primes_size && header.count > 0) header.max_num = last;
+
+		if (with_inverses && is_ok) {
+			header.flags |= PrimesFileHeader::FLAG_INVERSES;
+			header.inverses_offset = PrimesFileHeader::align(header.data_offset + header.data_size);
+			is_ok = (fseeko(file, (off_t)header.inverses_offset, SEEK_SET) == 0);
+			std::vector<prime_inverse_type> inverses;
+			for_each_primes_block(primes_size, max_num, [&] (const num_type primes[], size_t count) {
+				inverses.resize(count);
+				PrimesArray<num_type>::fill_inverses(primes, count, inverses.data());
+				is_ok = is_ok && fwrite(inverses.data(), sizeof(prime_inverse_type), count, file) == count;
+			});
+		}
+		return finish(file, header, tmp_path, path, is_ok);
+	}
+
+	// all primes <= max_num, memory is a segment of PrimesSieve, returns false on i/o error
+	static bool write_wheel(const char *path, num_type max_num) {
+		const std::string tmp_path = std::string(path) + ".tmp";
+		FILE *file = fopen(tmp_path.c_str(), "wb");
+		if (file == NULL) return false;
+		PrimesFileHeader header;
+		init_header(header, PrimesFileHeader::FORMAT_WHEEL, 1);
+		header.max_num = max_num;
+		// 2, 3, 5
+		header.count = (max_num >= 2) + (max_num >= 3) + (max_num >= 5);
+		header.data_size = (uint64_t)max_num / sieve_type::WHEEL + 1;
+
+		bool is_ok = (fseeko(file, (off_t)header.data_offset, SEEK_SET) == 0);
+		sieve_type sieve;
+		std::vector<uint8_t> bytes;
+		for (sieve.seek(0); is_ok && sieve.get_segment_start() < header.data_size; sieve.next_segment()) {
+			sieve.sieve_segment();
+			const uint64_t size = std::min((uint64_t)sieve.segment_size(), header.data_size - sieve.get_segment_start());
+			bytes.assign(sieve.get_segment(), sieve.get_segment() + size);
+			// numbers > max_num in the last byte
+			if (sieve.get_segment_start() + size == header.data_size) {
+				for (uint_fast8_t j=0; j<sieve_type::WHEEL_COUNT; ++j) {
+					if ((header.data_size - 1) * sieve_type::WHEEL + sieve_type::wheel_residues[j] > max_num) bytes[size-1] &= ~(1 << j);
+				}
+			}
+			for (size_t j=0; j<size; ++j) header.count += __builtin_popcount(bytes[j]);
+			is_ok = fwrite(bytes.data(), 1, size, file) == size;
+		}
+		return finish(file, header, tmp_path, path, is_ok);
+	}
+};
+
+// Read-only shared mapping of file of PrimesFileWriter: processes share page cache copy,
+// opening costs header validation only.
+template <typename NUM_TYPE>
+class PrimesFile {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimesArray<num_type> primes_array_type;
+	typedef typename primes_array_type::prime_inverse_type prime_inverse_type;
+	typedef PrimesSieve<num_type> sieve_type;
+
+private:
+	const uint8_t *data;
+	size_t size;
+	PrimesFileHeader header;
+
+	PrimesFile(const PrimesFile &b) = delete;
+	PrimesFile& operator=(const PrimesFile &b) = delete;
+
+public:
+	PrimesFile() : data(NULL), size(0) {
+		memset(&header, 0, sizeof(header));
+	}
+
+	~PrimesFile() {
+		close();
+	}
+
+	// returns false if file can't be mapped or it isn't valid file of this version,
+	// byte order and num_type (for FORMAT_ARRAY)
+	bool open(const char *path) {
+		close();
+		const int fd = ::open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		bool is_ok = (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(header));
+		void *mapping = MAP_FAILED;
+		if (is_ok) mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mapping == MAP_FAILED) return false;
+		data = (const uint8_t*)mapping;
+		size = (size_t)st.st_size;
+		memcpy(&header, data, sizeof(header));
+		if (!is_valid()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close() {
+		if (data != NULL) munmap((void*)data, size);
+		data = NULL;
+		size = 0;
+		memset(&header, 0, sizeof(header));
+	}
+
+	bool is_open() const {
+		return data != NULL;
+	}
+
+	const PrimesFileHeader& get_header() const {
+		return header;
+	}
+
+	uint32_t get_format() const {
+		return header.format;
+	}
+
+	// count of primes in file
+	uint64_t get_count() const {
+		return header.count;
+	}
+
+	// file has all primes <= max_num
+	num_type get_max_num() const {
+		return (num_type)header.max_num;
+	}
+
+	bool has_inverses() const {
+		return (header.flags & PrimesFileHeader::FLAG_INVERSES) != 0;
+	}
+
+	// FORMAT_ARRAY, array is valid while file is open, factorizers only read it
+	primes_array_type get_primes_array() const {
+		assert(is_open() && header.format == PrimesFileHeader::FORMAT_ARRAY);
+		num_type *primes = (num_type*)(data + header.data_offset);
+		const prime_inverse_type *inverses = (has_inverses() ? (const prime_inverse_type*)(data + header.inverses_offset) : NULL);
+		return primes_array_type(primes, (size_t)header.count, inverses);
+	}
+
+	// FORMAT_WHEEL, bytes of PrimesSieve segment starting from 0
+	const uint8_t *get_wheel() const {
+		assert(is_open() && header.format == PrimesFileHeader::FORMAT_WHEEL);
+		return data + header.data_offset;
+	}
+
+	// FORMAT_WHEEL, n <= get_max_num()
+	bool is_prime(num_type n) const {
+		assert(n <= get_max_num());
+		if (n < 6) return (n == 2 || n == 3 || n == 5);
+		const uint8_t bit = sieve_type::wheel_bits[n % sieve_type::WHEEL];
+		return bit != 0xff && ((get_wheel()[n / sieve_type::WHEEL] >> bit) & 1);
+	}
+
+private:
+	bool is_valid() const {
+		if (memcmp(header.magic, PrimesFileHeader::get_magic(), sizeof(header.magic)) != 0) return false;
+		if (header.version != PrimesFileHeader::VERSION || header.byte_order != PrimesFileHeader::BYTE_ORDER_MARK) return false;
+		if (header.data_offset % PrimesFileHeader::ALIGNMENT || header.data_offset > size || header.data_size > size - header.data_offset) return false;
+		// max_num fits num_type
+		if ((uint64_t)(num_type)header.max_num != header.max_num) return false;
+		if (header.format == PrimesFileHeader::FORMAT_ARRAY) {
+			// count is checked before multiplication, so sizes don't overflow
+			if (header.elem_size != sizeof(num_type) || header.count > size / sizeof(num_type)) return false;
+			if (header.data_size != header.count * sizeof(num_type)) return false;
+			if (header.flags & PrimesFileHeader::FLAG_INVERSES) {
+				if (header.count > size / sizeof(prime_inverse_type)) return false;
+				const uint64_t inverses_size = header.count * sizeof(prime_inverse_type);
+				if (header.inverses_offset % PrimesFileHeader::ALIGNMENT || header.inverses_offset > size) return false;
+				if (inverses_size > size - header.inverses_offset) return false;
+			}
+			return true;
+		}
+		if (header.format == PrimesFileHeader::FORMAT_WHEEL) {
+			return header.elem_size == 1 && header.data_size == header.max_num / sieve_type::WHEEL + 1;
+		}
+		return false;
+	}
+};
+
+// Lazy ascending iteration over primes of FORMAT_WHEEL file, like PrimesIterator without sieving
+template <typename NUM_TYPE>
+class PrimesFileIterator {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimesFile<num_type> primes_file_type;
+	typedef PrimesSieve<num_type> sieve_type;
+
+private:
+	const uint8_t *wheel;
+	uint64_t wheel_size;
+	// index of next of 2, 3, 5, 3 if they are passed
+	uint_fast8_t small_idx;
+	uint64_t byte_idx;
+	unsigned int bits;
+	num_type max_num;
+
+public:
+	PrimesFileIterator(const primes_file_type &primes_file, num_type from = 0) :
+		wheel(primes_file.get_wheel()), wheel_size(primes_file.get_header().data_size), max_num(primes_file.get_max_num()) {
+		seek(from);
+	}
+	// use default copy constructor and assignment operator
+
+	// next call of next returns the first prime >= from
+	void seek(num_type from) {
+		small_idx = (from <= 2 ? 0 : from <= 3 ? 1 : from <= 5 ? 2 : 3);
+		byte_idx = (uint64_t)from / sieve_type::WHEEL;
+		bits = 0;
+		if (byte_idx >= wheel_size) return;
+		// residues < from % 30 are passed
+		uint_fast8_t k = 0;
+		while (k < sieve_type::WHEEL_COUNT && sieve_type::wheel_residues[k] < from % sieve_type::WHEEL) ++k;
+		bits = wheel[byte_idx] & (0xffu << k);
+	}
+
+	// primes in ascending order, 0 after primes <= get_max_num() of file
+	num_type next() {
+		static const uint8_t small_primes[3] = {2, 3, 5};
+		if (small_idx < 3) {
+			const num_type p = small_primes[small_idx++];
+			return (p <= max_num ? p : 0);
+		}
+		while (bits == 0) {
+			if (byte_idx + 1 >= wheel_size) return 0;
+			bits = wheel[++byte_idx];
+		}
+		const num_type p = (num_type)(byte_idx * sieve_type::WHEEL + sieve_type::wheel_residues[__builtin_ctz(bits)]);
+		bits &= bits - 1;
+		return p;
+	}
+};
+
+#endif/*PRIMES_FILE_H*/
@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+#include "primes_file.h"
+
+typedef uint_fast64_t num_type;
+typedef Factorizer<num_type> fzr_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// sum of primes touches every page of mapping
+num_type sum_primes(const fzr_type::primes_array_type &primes_array) {
+	num_type sum = 0;
+	for (size_t i=0; i<primes_array.count; ++i) sum += primes_array.primes[i] + primes_array.inverses[i].inverse;
+	return sum;
+}
+
+int main(int argc, char *argv[]) {
+	const num_type max_num = (argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000ULL);
+	const char *array_path = "primes_file_bench_array.bin";
+	const char *wheel_path = "primes_file_bench_wheel.bin";
+
+	double t0 = get_time();
+	// pi(x) < 1.26 * x / ln(x)
+	const size_t primes_size = 1.26 * max_num / log((double)max_num) + 16;
+	std::vector<num_type> primes(primes_size);
+	const size_t count = fzr_type::fill_primes(primes.data(), primes.size(), max_num);
+	std::vector<fzr_type::prime_inverse_type> inverses(count);
+	fzr_type::primes_array_type::fill_inverses(primes.data(), count, inverses.data());
+	double t = get_time() - t0;
+	const num_type sum = sum_primes(fzr_type::primes_array_type(primes.data(), count, inverses.data()));
+	printf("primes <= %" PRIuFAST64 ": %zu primes, %.1f MiB with inverses\n", max_num, count, count * (sizeof(num_type) + sizeof(fzr_type::prime_inverse_type)) / 1048576.0);
+	printf("fill_primes and fill_inverses    %9.3f ms\n", t * 1e3);
+
+	t0 = get_time();
+	assert(PrimesFileWriter<num_type>::write_array(array_path, SIZE_MAX, max_num, true));
+	printf("write_array                      %9.3f ms\n", (get_time() - t0) * 1e3);
+	t0 = get_time();
+	assert(PrimesFileWriter<num_type>::write_wheel(wheel_path, max_num));
+	printf("write_wheel                      %9.3f ms\n", (get_time() - t0) * 1e3);
+
+	{
+		PrimesFile<num_type> primes_file;
+		t0 = get_time();
+		assert(primes_file.open(array_path));
+		t = get_time() - t0;
+		printf("open array file                  %9.3f ms\n", t * 1e3);
+		t0 = get_time();
+		assert(sum_primes(primes_file.get_primes_array()) == sum);
+		printf("first pass over mapped array     %9.3f ms (page cache)\n", (get_time() - t0) * 1e3);
+	}
+	{
+		PrimesFile<num_type> primes_file;
+		t0 = get_time();
+		assert(primes_file.open(wheel_path));
+		t = get_time() - t0;
+		printf("open wheel file                  %9.3f ms, %.1f MiB\n", t * 1e3, primes_file.get_header().data_size / 1048576.0);
+		t0 = get_time();
+		PrimesFileIterator<num_type> it(primes_file);
+		size_t wheel_count = 0;
+		while (it.next() != 0) ++wheel_count;
+		assert(wheel_count == count);
+		printf("iteration over mapped wheel      %9.3f ms\n", (get_time() - t0) * 1e3);
+	}
+	unlink(array_path);
+	unlink(wheel_path);
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "primes_file.h"
+#include "canonic_factors.h"
+
+// files are written to the current directory and removed
+std::string get_path(const char *name) {
+	char buf[64];
+	snprintf(buf, sizeof(buf), "primes_file_tests_%u_%s.bin", (unsigned int)getpid(), name);
+	return buf;
+}
+
+template <typename NUM_TYPE>
+void test_array(size_t primes_size, NUM_TYPE max_num, bool with_inverses) {
+	typedef PrimesFile<NUM_TYPE> file_type;
+	const std::string path = get_path("array");
+	assert(PrimesFileWriter<NUM_TYPE>::write_array(path.c_str(), primes_size, max_num, with_inverses));
+	std::vector<NUM_TYPE> my_primes(primes_size);
+	my_primes.resize(Factorizer<NUM_TYPE>::fill_primes(my_primes.data(), primes_size, max_num));
+
+	file_type primes_file;
+	assert(primes_file.open(path.c_str()));
+	assert(unlink(path.c_str()) == 0);		// mapping stays valid
+	assert(primes_file.get_format() == PrimesFileHeader::FORMAT_ARRAY);
+	assert(primes_file.has_inverses() == with_inverses);
+	assert(primes_file.get_count() == my_primes.size());
+	// the last prime if primes_size is reached
+	if (my_primes.size() == primes_size) assert(primes_file.get_max_num() == my_primes.back());
+	else assert(primes_file.get_max_num() == max_num);
+	typename file_type::primes_array_type primes_array = primes_file.get_primes_array();
+	assert(primes_array.count == my_primes.size());
+	for (size_t i=0; i<my_primes.size(); ++i) {
+		assert(primes_array.primes[i] == my_primes[i]);
+		if (with_inverses && i > 0) {
+			assert(primes_array.inverses[i].inverse == PrimeInverse<NUM_TYPE>(my_primes[i]).inverse);
+			assert(primes_array.inverses[i].limit == PrimeInverse<NUM_TYPE>(my_primes[i]).limit);
+		}
+	}
+	if (!with_inverses) assert(primes_array.inverses == NULL);
+}
+
+void test_factorize_from_file() {
+	typedef CanonicFactorsTemplate<uint_fast64_t, 15> cf_type;
+	const std::string path = get_path("factorize");
+	assert(PrimesFileWriter<uint_fast64_t>::write_array(path.c_str(), 1024*4, UINT64_MAX, true));
+	PrimesFile<uint_fast64_t> primes_file;
+	assert(primes_file.open(path.c_str()));
+	unlink(path.c_str());
+
+	std::vector<uint_fast64_t> primes(1024*4);
+	std::vector<PrimeInverse<uint_fast64_t> > inverses(primes.size());
+	Factorizer<uint_fast64_t>::fill_primes(primes.data(), primes.size(), UINT64_MAX);
+	PrimesArray<uint_fast64_t>::fill_inverses(primes.data(), primes.size(), inverses.data());
+	cf_type::CanonicFactorizer file_factorizer(primes_file.get_primes_array());
+	cf_type::CanonicFactorizer factorizer(PrimesArray<uint_fast64_t>(primes.data(), primes.size(), inverses.data()));
+	for (uint_fast64_t n=1000000000000ULL; n<1000000000000ULL+1024; ++n) {
+		cf_type::PrimePow file_pows[15], pows[15];
+		const size_t pow_count = cf_type::CanonicFactors(file_factorizer, n).copy(file_pows, 15);
+		assert(pow_count == cf_type::CanonicFactors(factorizer, n).copy(pows, 15));
+		for (size_t i=0; i<pow_count; ++i) assert(file_pows[i].prime == pows[i].prime && file_pows[i].exp == pows[i].exp);
+	}
+}
+
+void test_wheel(uint_fast64_t max_num) {
+	typedef PrimesFile<uint_fast64_t> file_type;
+	const std::string path = get_path("wheel");
+	assert(PrimesFileWriter<uint_fast64_t>::write_wheel(path.c_str(), max_num));
+	file_type primes_file;
+	assert(primes_file.open(path.c_str()));
+	unlink(path.c_str());
+	assert(primes_file.get_format() == PrimesFileHeader::FORMAT_WHEEL);
+	assert(primes_file.get_max_num() == max_num);
+
+	std::vector<bool> my_is_prime(max_num + 1, false);
+	uint_fast64_t my_count = 0;
+	PrimesSieve<uint_fast64_t> sieve;
+	sieve.for_each_prime(0, max_num, [&] (uint_fast64_t p) -> bool {
+		my_is_prime[p] = true;
+		++my_count;
+		return false;
+	});
+	assert(primes_file.get_count() == my_count);
+	for (uint_fast64_t n=0; n<=max_num; ++n) assert(primes_file.is_prime(n) == my_is_prime[n]);
+
+	// iteration from every number up to a few primes ahead, 0 at the end
+	PrimesFileIterator<uint_fast64_t> primes(primes_file);
+	for (uint_fast64_t from=0; from<=max_num+1; from+=(max_num > 4096 ? 97 : 1)) {
+		primes.seek(from);
+		uint_fast64_t n = from;
+		for (size_t k=0; k<8; ++k, ++n) {
+			while (n <= max_num && !my_is_prime[n]) ++n;
+			assert(primes.next() == (n <= max_num ? n : 0));
+		}
+	}
+	PrimesFileIterator<uint_fast64_t> all_primes(primes_file);
+	uint_fast64_t count = 0;
+	while (all_primes.next() != 0) ++count;
+	assert(count == my_count);
+}
+
+void test_invalid_files() {
+	const std::string path = get_path("invalid");
+	PrimesFile<uint32_t> primes_file;
+	assert(!primes_file.open(path.c_str()));
+
+	// array of other num_type
+	assert(PrimesFileWriter<uint64_t>::write_array(path.c_str(), 100, UINT64_MAX, false));
+	assert(!primes_file.open(path.c_str()));
+	assert(PrimesFileWriter<uint32_t>::write_array(path.c_str(), 100, UINT32_MAX, false));
+	assert(primes_file.open(path.c_str()));
+	primes_file.close();
+	assert(!primes_file.is_open());
+
+	// truncated file
+	assert(truncate(path.c_str(), 128 + 99 * sizeof(uint32_t)) == 0);
+	assert(!primes_file.open(path.c_str()));
+	assert(truncate(path.c_str(), 16) == 0);
+	assert(!primes_file.open(path.c_str()));
+
+	// other version
+	assert(PrimesFileWriter<uint32_t>::write_wheel(path.c_str(), 1000));
+	FILE *file = fopen(path.c_str(), "r+b");
+	PrimesFileHeader header;
+	assert(fread(&header, sizeof(header), 1, file) == 1);
+	header.version = PrimesFileHeader::VERSION + 1;
+	assert(fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1);
+	fclose(file);
+	assert(!primes_file.open(path.c_str()));
+
+	// count * sizeof(num_type) overflows to data_size 0
+	assert(PrimesFileWriter<uint32_t>::write_array(path.c_str(), 100, UINT32_MAX, false));
+	file = fopen(path.c_str(), "r+b");
+	assert(fread(&header, sizeof(header), 1, file) == 1);
+	header.count = (uint64_t)1 << 62;
+	header.data_size = 0;
+	assert(fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1);
+	fclose(file);
+	assert(!primes_file.open(path.c_str()));
+	unlink(path.c_str());
+
+	// directory doesn't exist
+	assert(!PrimesFileWriter<uint32_t>::write_wheel("no_such_dir/primes.bin", 1000));
+}
+
+int main() {
+	test_array<uint_fast64_t>(1024, UINT64_MAX, true);
+	test_array<uint_fast64_t>(1024*1024, 1000000, true);
+	test_array<uint32_t>(100000, UINT32_MAX, false);
+	test_array<uint32_t>(10, 1, false);
+	test_factorize_from_file();
+	const uint_fast64_t max_nums[] = {0, 1, 2, 5, 6, 7, 29, 30, 31, 1000, 1000000, 10000019};
+	for (size_t i=0; i<sizeof(max_nums)/sizeof(max_nums[0]); ++i) test_wheel(max_nums[i]);
+	test_invalid_files();
+	printf("Tests passed\n");
+	return 0;
+}
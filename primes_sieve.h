@@ -0,0 +1,414 @@
+#ifndef PRIMES_SIEVE_H
+#define PRIMES_SIEVE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <string.h>		// memcpy
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "uint128.h"
+
+// Segmented sieve of Eratosthenes, bit-packed by mod 30 wheel:
+// bit j of segment byte i stands for number 30*(segment_start+i) + wheel_residues[j],
+// bit is set while the number is not crossed out.
+// Numbers are handled as uint64_t internally, sieve works for numbers < 2^64 - 2^40.
+template <typename NUM_TYPE>
+class PrimesSieve {
+public:
+	typedef NUM_TYPE num_type;
+	typedef uint64_t pos_type;
+	static constexpr uint_fast8_t WHEEL = 30;
+	static constexpr uint_fast8_t WHEEL_COUNT = 8;
+	// 32 KiB segment fits L1 data cache, use about 256 KiB to fit L2 cache
+	static constexpr size_t DEFAULT_SEGMENT_SIZE = 32*1024;
+
+	static const uint8_t wheel_residues[WHEEL_COUNT];
+	// bit index for wheel residue, 0xff for numbers not coprime to 30
+	static const uint8_t wheel_bits[WHEEL];
+	// wheel_steps[j] - distance from wheel_residues[j] to the next residue
+	static const uint8_t wheel_steps[WHEEL_COUNT];
+
+private:
+	// primes 7 <= p <= sieving_limit
+	std::vector<uint32_t> sieving_primes;
+	// WHEEL_COUNT per active sieving prime: next byte to cross out
+	std::vector<pos_type> next_bytes;
+	std::vector<uint8_t> segment;
+	pos_type sieving_limit;
+	size_t active_count;
+	// segment covers bytes [segment_start, segment_start+segment.size())
+	pos_type segment_start;
+
+	PrimesSieve(const PrimesSieve &b) = delete;
+	PrimesSieve& operator=(const PrimesSieve &b) = delete;
+
+public:
+	PrimesSieve(size_t segment_size = DEFAULT_SEGMENT_SIZE) :
+		segment(segment_size), sieving_limit(0), active_count(0), segment_start(0) {
+		assert(segment_size > 0);
+	}
+
+	static pos_type isqrt(pos_type n) {
+		return UnsignedOps<pos_type>::isqrt(n);
+	}
+
+	size_t segment_size() const {
+		return segment.size();
+	}
+
+	pos_type get_segment_start() const {
+		return segment_start;
+	}
+
+	const uint8_t *get_segment() const {
+		return segment.data();
+	}
+
+	// last number covered by current segment
+	pos_type segment_last() const {
+		const pos_type max_bytes = UINT64_MAX / WHEEL;
+		if (segment_start + segment.size() > max_bytes) return UINT64_MAX;
+		return (segment_start + segment.size()) * WHEEL - 1;
+	}
+
+	// move to segment which starts with number from (rounded down to 30)
+	void seek(pos_type from) {
+		segment_start = from / WHEEL;
+		active_count = 0;
+	}
+
+	void next_segment() {
+		segment_start += segment.size();
+	}
+
+	void sieve_segment() {
+		const pos_type last = segment_last();
+		const size_t size = segment.size();
+		uint8_t *seg = segment.data();
+		// pattern is periodic, 30 is coprime to presieved primes
+		const uint8_t *pattern = presieve_pattern().data();
+		for (size_t j=0, offset=segment_start % PRESIEVE_SIZE; j<size; offset=0) {
+			const size_t chunk = std::min(size - j, PRESIEVE_SIZE - offset);
+			memcpy(seg + j, pattern + offset, chunk);
+			j += chunk;
+		}
+		// 1 is not a prime, 7, 11, 13, 17 are primes
+		if (segment_start == 0) seg[0] = (seg[0] & ~1) | 0x1e;
+
+		extend_sieving_primes(isqrt(last));
+		while (
+			active_count < sieving_primes.size() &&
+			(pos_type)sieving_primes[active_count] * sieving_primes[active_count] <= last
+		) {
+			init_next_bytes(active_count);
+			++active_count;
+		}
+
+		const pos_type segment_end = segment_start + size;
+		for (size_t i=PRESIEVED_COUNT; i<active_count; ++i) {
+			const uint32_t p = sieving_primes[i];
+			const uint_fast8_t p_res = p % WHEEL;
+			pos_type *next = &next_bytes[i * WHEEL_COUNT];
+			for (uint_fast8_t k=0; k<WHEEL_COUNT; ++k) {
+				if (next[k] >= segment_end) continue;
+				const uint8_t mask = ~(1 << wheel_bits[p_res * wheel_residues[k] % WHEEL]);
+				size_t j = next[k] - segment_start;
+				for (; j < size; j += p) seg[j] &= mask;
+				next[k] = segment_start + j;
+			}
+		}
+	}
+
+	// call cb for every prime in [from, to] in ascending order
+	// if cb returns true, iteration interrupts and function returns true
+	template <typename CB>
+	bool for_each_prime(pos_type from, pos_type to, CB cb) {
+		static const uint8_t small_primes[3] = {2, 3, 5};
+		for (uint_fast8_t i=0; i<3; ++i) {
+			if (small_primes[i] >= from && small_primes[i] <= to) {
+				if (cb((num_type)small_primes[i])) return true;
+			}
+		}
+		if (to < 7) return false;
+
+		for (seek(from); segment_start <= to / WHEEL; next_segment()) {
+			sieve_segment();
+			const uint8_t *seg = segment.data();
+			const pos_type to_byte = to / WHEEL;
+			const size_t size = (
+				to_byte - segment_start < segment.size() ?
+				to_byte - segment_start + 1 :
+				segment.size()
+			);
+			for (size_t j=0; j<size; ++j) {
+				unsigned int bits = seg[j];
+				const pos_type base = (segment_start + j) * WHEEL;
+				while (bits) {
+					const pos_type n = base + wheel_residues[__builtin_ctz(bits)];
+					bits &= bits - 1;
+					if (n < from) continue;
+					if (n > to) return false;
+					if (cb((num_type)n)) return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// upper bound of n-th prime (1-based), Rosser's theorem for n >= 6
+	static pos_type nth_prime_upper_bound(size_t n) {
+		if (n < 6) return 13;
+		double ln_n = log((double)n);
+		double bound = (double)n * (ln_n + log(ln_n)) + 1;
+		if (bound >= (double)UINT64_MAX) return UINT64_MAX;
+		return bound;
+	}
+
+	// fill primes <= max_num, at most primes_size of them
+	static size_t fill_primes(num_type primes[], size_t primes_size, num_type max_num) {
+		if (primes_size == 0 || max_num < 2) return 0;
+		pos_type bound = nth_prime_upper_bound(primes_size);
+		if ((pos_type)max_num < bound) bound = max_num;
+		const pos_type bound_bytes = bound / WHEEL + 1;
+		PrimesSieve sieve(bound_bytes < DEFAULT_SEGMENT_SIZE ? bound_bytes : DEFAULT_SEGMENT_SIZE);
+		size_t count = 0;
+		sieve.for_each_prime(2, bound, [&] (num_type p) -> bool {
+			primes[count++] = p;
+			return count == primes_size;
+		});
+		return count;
+	}
+
+private:
+	// segment bytes start from copy of pattern of numbers coprime to 7, 11, 13, 17,
+	// so sieving_primes[0], ..., sieving_primes[PRESIEVED_COUNT-1] are not crossed out
+	static constexpr size_t PRESIEVED_COUNT = 4;
+	static constexpr size_t PRESIEVE_SIZE = 7*11*13*17;
+
+	static const std::vector<uint8_t>& presieve_pattern() {
+		static const std::vector<uint8_t> pattern = make_presieve_pattern();
+		return pattern;
+	}
+
+	static std::vector<uint8_t> make_presieve_pattern() {
+		static const uint8_t presieved_primes[PRESIEVED_COUNT] = {7, 11, 13, 17};
+		std::vector<uint8_t> pattern(PRESIEVE_SIZE, 0xff);
+		for (size_t j=0; j<PRESIEVE_SIZE; ++j) {
+			for (uint_fast8_t k=0; k<WHEEL_COUNT; ++k) {
+				const pos_type n = (pos_type)j * WHEEL + wheel_residues[k];
+				for (size_t i=0; i<PRESIEVED_COUNT; ++i) {
+					if (n % presieved_primes[i] == 0) pattern[j] &= ~(1 << k);
+				}
+			}
+		}
+		return pattern;
+	}
+
+	void init_next_bytes(size_t idx) {
+		const pos_type p = sieving_primes[idx];
+		const pos_type low = segment_start * WHEEL;
+		// cross out starting from p^2, smaller multiples have smaller prime factor
+		pos_type m0 = (low + p - 1) / p;
+		if (m0 < p) m0 = p;
+		const uint_fast8_t m0_res = m0 % WHEEL;
+		if (next_bytes.size() < (idx + 1) * WHEEL_COUNT) next_bytes.resize((idx + 1) * WHEEL_COUNT);
+		pos_type *next = &next_bytes[idx * WHEEL_COUNT];
+		for (uint_fast8_t k=0; k<WHEEL_COUNT; ++k) {
+			const pos_type m = m0 + (wheel_residues[k] + WHEEL - m0_res) % WHEEL;
+			next[k] = p * m / WHEEL;
+		}
+	}
+
+	void extend_sieving_primes(pos_type limit) {
+		if (limit <= sieving_limit) return;
+		if (limit < 2 * sieving_limit) limit = 2 * sieving_limit;
+		if (limit < 1024) limit = 1024;
+		if (limit > UINT32_MAX) limit = UINT32_MAX;
+		// odd numbers only: is_composite[i] is for 2*i+1
+		std::vector<bool> is_composite(limit / 2 + 1);
+		for (pos_type i=1; (2*i+1)*(2*i+1) <= limit; ++i) {
+			if (is_composite[i]) continue;
+			const pos_type p = 2*i+1;
+			for (pos_type j=p*p/2; j<=limit/2; j+=p) is_composite[j] = true;
+		}
+		for (pos_type i=(sieving_limit+1)/2; 2*i+1 <= limit; ++i) {
+			const pos_type n = 2*i+1;
+			if (n >= 7 && n > sieving_limit && !is_composite[i]) sieving_primes.push_back(n);
+		}
+		sieving_limit = limit;
+	}
+};
+
+// Lazy ascending iteration over primes by segments of PrimesSieve:
+// memory is one segment, sieving primes <= sqrt of current segment end and buffer of primes
+// of BUFFER_BYTES bytes of segment. Buffer is filled by 64-bit words of segment,
+// so there is one unpredictable branch per word instead of per byte.
+// Seek inside of current segment doesn't sieve again.
+template <typename NUM_TYPE>
+class PrimesIterator {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimesSieve<num_type> sieve_type;
+	typedef typename sieve_type::pos_type pos_type;
+	// 4 KiB segment covers 122880 numbers, short iterations don't sieve much ahead
+	static constexpr size_t DEFAULT_SEGMENT_SIZE = 4*1024;
+	static constexpr size_t BUFFER_BYTES = 64;
+
+private:
+	sieve_type sieve;
+	bool is_sieved;
+	// index of next of 2, 3, 5, 3 if they are passed
+	uint_fast8_t small_idx;
+	// next byte of segment to fill buffer from
+	size_t byte_idx;
+	std::vector<num_type> buffer;
+	size_t buffer_pos;
+	size_t buffer_count;
+
+	PrimesIterator(const PrimesIterator &b) = delete;
+	PrimesIterator& operator=(const PrimesIterator &b) = delete;
+
+public:
+	PrimesIterator(pos_type from = 0, size_t segment_size = DEFAULT_SEGMENT_SIZE) :
+		sieve(segment_size), is_sieved(false), buffer(BUFFER_BYTES * sieve_type::WHEEL_COUNT) {
+		seek(from);
+	}
+
+	// next call of next returns the first prime >= from
+	void seek(pos_type from) {
+		small_idx = (from <= 2 ? 0 : from <= 3 ? 1 : from <= 5 ? 2 : 3);
+		const pos_type byte = from / sieve_type::WHEEL;
+		const pos_type segment_start = sieve.get_segment_start();
+		if (!is_sieved || byte < segment_start || byte - segment_start >= sieve.segment_size()) {
+			sieve.seek(from);
+			sieve.sieve_segment();
+			is_sieved = true;
+		}
+		byte_idx = (size_t)(byte - sieve.get_segment_start());
+		fill_buffer();
+		// at most 7 primes of the first byte are < from
+		while (buffer_pos < buffer_count && buffer[buffer_pos] < from) ++buffer_pos;
+	}
+
+	// primes in ascending order, p < 2^64 - 2^40
+	num_type next() {
+		static const uint8_t small_primes[3] = {2, 3, 5};
+		if (small_idx < 3) return small_primes[small_idx++];
+		while (buffer_pos == buffer_count) fill_buffer();
+		return buffer[buffer_pos++];
+	}
+
+private:
+	void fill_buffer() {
+		if (byte_idx == sieve.segment_size()) {
+			sieve.next_segment();
+			sieve.sieve_segment();
+			byte_idx = 0;
+		}
+		const uint8_t *seg = sieve.get_segment();
+		const size_t end = std::min(byte_idx + BUFFER_BYTES, sieve.segment_size());
+		pos_type base = (sieve.get_segment_start() + byte_idx) * sieve_type::WHEEL;
+		num_type *primes = buffer.data();
+		size_t count = 0;
+		for (; byte_idx + 8 <= end; byte_idx += 8, base += 8 * sieve_type::WHEEL) {
+			uint64_t word;
+			memcpy(&word, seg + byte_idx, 8);
+			while (word) {
+				const uint_fast8_t bit = __builtin_ctzll(word);
+				primes[count++] = (num_type)(base + (bit >> 3) * sieve_type::WHEEL + sieve_type::wheel_residues[bit & 7]);
+				word &= word - 1;
+			}
+		}
+		for (; byte_idx < end; ++byte_idx, base += sieve_type::WHEEL) {
+			unsigned int bits = seg[byte_idx];
+			while (bits) {
+				primes[count++] = (num_type)(base + sieve_type::wheel_residues[__builtin_ctz(bits)]);
+				bits &= bits - 1;
+			}
+		}
+		buffer_pos = 0;
+		buffer_count = count;
+	}
+};
+
+// Sieve of Eratosthenes for numbers < BOUND built at compile time:
+//     static constexpr SmallPrimesSieve<1024*64> sieve;
+// BOUND is limited by constexpr loop and operations limits of compiler.
+template <size_t BOUND>
+struct SmallPrimesSieve {
+	static constexpr size_t WORDS_COUNT = (BOUND + 63) / 64;
+
+	// bit n is set if n is a prime
+	uint64_t bits[WORDS_COUNT];
+
+	constexpr SmallPrimesSieve() : bits() {
+		for (size_t n=2; n<BOUND; ++n) bits[n / 64] |= (uint64_t)1 << (n % 64);
+		for (size_t p=2; p*p<BOUND; ++p) {
+			if (!is_prime(p)) continue;
+			for (size_t m=p*p; m<BOUND; m+=p) bits[m / 64] &= ~((uint64_t)1 << (m % 64));
+		}
+	}
+
+	// n < BOUND
+	constexpr bool is_prime(size_t n) const {
+		return (bits[n / 64] >> (n % 64)) & 1;
+	}
+
+	// count of primes < BOUND
+	constexpr size_t count() const {
+		size_t result = 0;
+		for (size_t i=0; i<WORDS_COUNT; ++i) result += __builtin_popcountll(bits[i]);
+		return result;
+	}
+};
+
+// The first COUNT primes built at compile time, trial division by found primes:
+//     static constexpr SmallPrimes<uint_fast32_t, 1024> small_primes;
+//     Factorizer<uint_fast32_t> factorizer(PrimesArray<uint_fast32_t>((uint_fast32_t*)small_primes.primes, 1024));
+template <typename NUM_TYPE, size_t COUNT>
+struct SmallPrimes {
+	typedef NUM_TYPE num_type;
+
+	num_type primes[COUNT];
+
+	constexpr SmallPrimes() : primes() {
+		size_t count = 0;
+		for (num_type n=2; count<COUNT; ++n) {
+			bool is_prime = true;
+			for (size_t i=0; i<count && primes[i]*primes[i]<=n; ++i) {
+				if (n % primes[i] == 0) {
+					is_prime = false;
+					break;
+				}
+			}
+			if (is_prime) primes[count++] = n;
+		}
+	}
+
+	constexpr num_type operator[](size_t i) const {
+		return primes[i];
+	}
+
+	constexpr size_t size() const {
+		return COUNT;
+	}
+};
+
+template <typename NUM_TYPE>
+const uint8_t PrimesSieve<NUM_TYPE>::wheel_residues[PrimesSieve<NUM_TYPE>::WHEEL_COUNT] =
+	{1, 7, 11, 13, 17, 19, 23, 29};
+
+template <typename NUM_TYPE>
+const uint8_t PrimesSieve<NUM_TYPE>::wheel_steps[PrimesSieve<NUM_TYPE>::WHEEL_COUNT] =
+	{6, 4, 2, 4, 2, 4, 6, 2};
+
+template <typename NUM_TYPE>
+const uint8_t PrimesSieve<NUM_TYPE>::wheel_bits[PrimesSieve<NUM_TYPE>::WHEEL] = {
+	0xff, 0,    0xff, 0xff, 0xff, 0xff, 0xff, 1,    0xff, 0xff,
+	0xff, 2,    0xff, 3,    0xff, 0xff, 0xff, 4,    0xff, 5,
+	0xff, 0xff, 0xff, 6,    0xff, 0xff, 0xff, 0xff, 0xff, 7
+};
+
+#endif/*PRIMES_SIEVE_H*/
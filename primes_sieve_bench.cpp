@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+#include "primes_sieve.h"
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// former Factorizer::fill_primes: trial division by previous primes
+size_t trial_division_fill_primes(uint_fast64_t primes[], size_t primes_size, uint_fast64_t max_num) {
+	if (primes_size == 0 || max_num < 2) return 0;
+	primes[0] = 2;
+	size_t primes_count = 1;
+	uint_fast64_t n = 3;
+	uint_fast64_t n_sqrt = 1;
+	while (primes_count < primes_size && n <= max_num) {
+		bool is_prime = true;
+		for (size_t i=0; primes[i]<=n_sqrt; ++i) {
+			if (!(n % primes[i])) {
+				is_prime = false;
+				break;
+			}
+		}
+		if (is_prime) primes[primes_count++] = n;
+		n += 2;
+		n_sqrt = round(sqrt((double)n));
+	}
+	return primes_count;
+}
+
+void bench_fill_primes(size_t primes_size) {
+	typedef PrimesSieve<uint_fast64_t> sieve_type;
+	std::vector<uint_fast64_t> primes(primes_size), my_primes(primes_size);
+
+	double t0 = get_time();
+	size_t count = sieve_type::fill_primes(primes.data(), primes_size, UINT64_MAX);
+	double t1 = get_time();
+	size_t my_count = trial_division_fill_primes(my_primes.data(), primes_size, UINT64_MAX);
+	double t2 = get_time();
+
+	assert(count == primes_size && my_count == primes_size);
+	assert(primes == my_primes);
+	printf(
+		"fill %9zu primes: sieve %8.3f ms, trial division %9.3f ms, speedup %.1fx\n",
+		primes_size, (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t2 - t1) / (t1 - t0)
+	);
+}
+
+void bench_segment_size(uint_fast64_t max_num, size_t segment_size) {
+	typedef PrimesSieve<uint_fast64_t> sieve_type;
+	sieve_type sieve(segment_size);
+	size_t count = 0;
+	double t0 = get_time();
+	sieve.for_each_prime(0, max_num, [&] (uint_fast64_t p) -> bool {
+		(void)p;
+		++count;
+		return false;
+	});
+	double t1 = get_time();
+	printf(
+		"pi(%" PRIu64 ") = %zu, segment %7zu bytes: %8.3f ms\n",
+		(uint64_t)max_num, count, segment_size, (t1 - t0) * 1e3
+	);
+}
+
+int main() {
+	bench_fill_primes(1000);
+	bench_fill_primes(100000);
+	bench_fill_primes(1000000);
+
+	bench_segment_size(1000000000, 1024*8);
+	bench_segment_size(1000000000, 1024*32);
+	bench_segment_size(1000000000, 1024*256);
+	bench_segment_size(1000000000, 1024*1024*4);
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <vector>
+#include "primes_sieve.h"
+
+bool my_is_prime(uint_fast64_t n) {
+	if (n < 2) return false;
+	if (n < 4) return true;
+	if (!(n & 1)) return false;
+	for (uint_fast64_t d=3; d<=n/d; d+=2) {
+		if (n % d == 0) return false;
+	}
+	return true;
+}
+
+void test_isqrt() {
+	typedef PrimesSieve<uint_fast64_t> sieve_type;
+	for (uint_fast64_t i=0; i<1024*64; ++i) {
+		uint_fast64_t r = sieve_type::isqrt(i);
+		assert(r * r <= i && (r + 1) * (r + 1) > i);
+	}
+	for (uint_fast64_t r=UINT32_MAX; r>=(uint_fast64_t)UINT32_MAX-1024; --r) {
+		assert(sieve_type::isqrt(r * r) == r);
+		assert(sieve_type::isqrt(r * r - 1) == r - 1);
+	}
+	assert(sieve_type::isqrt(UINT64_MAX) == UINT32_MAX);
+}
+
+void test_fill_primes() {
+	typedef PrimesSieve<uint_fast64_t> sieve_type;
+	const size_t size = 1024*16;
+	std::vector<uint_fast64_t> primes(size);
+	size_t count = sieve_type::fill_primes(primes.data(), size, UINT64_MAX);
+	assert(count == size);
+	uint_fast64_t n = 2;
+	for (size_t i=0; i<count; ++i) {
+		while (!my_is_prime(n)) ++n;
+		assert(primes[i] == n);
+		++n;
+	}
+
+	// bounded by max_num
+	for (uint_fast64_t max_num=0; max_num<1024; ++max_num) {
+		count = sieve_type::fill_primes(primes.data(), size, max_num);
+		size_t my_count = 0;
+		for (uint_fast64_t i=0; i<=max_num; ++i) {
+			if (my_is_prime(i)) assert(primes[my_count++] == i);
+		}
+		assert(count == my_count);
+	}
+
+	// bounded by primes_size
+	for (size_t primes_size=0; primes_size<256; ++primes_size) {
+		count = sieve_type::fill_primes(primes.data(), primes_size, UINT64_MAX);
+		assert(count == primes_size);
+	}
+
+	// pi(2^16) = 6542, pi(10^6) = 78498
+	assert(sieve_type::fill_primes(primes.data(), size, 65536) == 6542);
+	primes.resize(100000);
+	assert(sieve_type::fill_primes(primes.data(), 100000, 1000000) == 78498);
+}
+
+void test_segments() {
+	typedef PrimesSieve<uint_fast32_t> sieve_type;
+	// pi(10^6) = 78498 for any segment size
+	const size_t segment_sizes[] = {1, 2, 3, 7, 64, 1000, 1024*32, 1024*256};
+	for (size_t i=0; i<sizeof(segment_sizes)/sizeof(segment_sizes[0]); ++i) {
+		sieve_type sieve(segment_sizes[i]);
+		size_t count = 0;
+		uint_fast32_t last = 0;
+		sieve.for_each_prime(0, 1000000, [&] (uint_fast32_t p) -> bool {
+			assert(p > last);
+			last = p;
+			++count;
+			return false;
+		});
+		assert(count == 78498);
+		assert(last == 999983);
+	}
+}
+
+void test_ranges() {
+	typedef PrimesSieve<uint_fast64_t> sieve_type;
+	sieve_type sieve(64);
+	const uint_fast64_t starts[] = {0, 1, 2, 3, 6, 7, 29, 30, 31, 1000000, 1000000000000ULL, 4294967296ULL - 1000};
+	for (size_t i=0; i<sizeof(starts)/sizeof(starts[0]); ++i) {
+		const uint_fast64_t from = starts[i], to = starts[i] + 4096;
+		uint_fast64_t n = from;
+		sieve.for_each_prime(from, to, [&] (uint_fast64_t p) -> bool {
+			while (!my_is_prime(n)) ++n;
+			assert(p == n);
+			++n;
+			return false;
+		});
+		while (n <= to) assert(!my_is_prime(n++));
+	}
+
+	// interruption
+	size_t count = 0;
+	bool interrupted = sieve.for_each_prime(0, 1000000, [&] (uint_fast64_t p) -> bool {
+		(void)p;
+		return ++count == 100;
+	});
+	assert(interrupted && count == 100);
+}
+
+void test_iterator() {
+	typedef PrimesIterator<uint_fast64_t> iterator_type;
+	// the same primes as of for_each_prime, segments of 1, 64 and default size are crossed
+	const size_t segment_sizes[] = {1, 64, iterator_type::DEFAULT_SEGMENT_SIZE};
+	const uint_fast64_t starts[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 29, 30, 31, 1000000, 1000000000000ULL, 4294967296ULL - 1000};
+	for (size_t i=0; i<sizeof(segment_sizes)/sizeof(segment_sizes[0]); ++i) {
+		for (size_t j=0; j<sizeof(starts)/sizeof(starts[0]); ++j) {
+			iterator_type primes(starts[j], segment_sizes[i]);
+			PrimesSieve<uint_fast64_t> sieve;
+			sieve.for_each_prime(starts[j], starts[j] + 4096, [&primes] (uint_fast64_t p) -> bool {
+				assert(primes.next() == p);
+				return false;
+			});
+		}
+	}
+
+	// seek forward and backward, inside of segment and outside of it
+	iterator_type primes(0, 64);
+	for (uint_fast64_t from=0; from<1024; ++from) {
+		primes.seek(from);
+		uint_fast64_t n = from;
+		while (!my_is_prime(n)) ++n;
+		assert(primes.next() == n);
+	}
+	const uint_fast64_t seeks[] = {1000000000000ULL, 1000, 1000000000000ULL + 7, 1000000000000ULL + 3, 30*64, 30*64 - 1, 0};
+	for (size_t i=0; i<sizeof(seeks)/sizeof(seeks[0]); ++i) {
+		primes.seek(seeks[i]);
+		size_t count = 0;
+		PrimesSieve<uint_fast64_t> sieve;
+		sieve.for_each_prime(seeks[i], UINT64_MAX, [&primes, &count] (uint_fast64_t p) -> bool {
+			assert(primes.next() == p);
+			return ++count == 16;
+		});
+	}
+
+	// pi(10^6) = 78498
+	iterator_type primes_1m;
+	size_t count = 0;
+	while (primes_1m.next() <= 1000000) ++count;
+	assert(count == 78498);
+}
+
+void test_constexpr() {
+	// evaluated at compile time
+	static constexpr SmallPrimesSieve<1024*64> sieve;
+	static_assert(sieve.count() == 6542, "pi(2^16) == 6542");
+	static_assert(sieve.is_prime(65521) && !sieve.is_prime(65535) && !sieve.is_prime(1) && sieve.is_prime(2), "primes < 2^16");
+	static constexpr SmallPrimes<uint_fast32_t, 1024> small_primes;
+	static_assert(small_primes[0] == 2 && small_primes[1023] == 8161, "the first 1024 primes");
+
+	// the same as PrimesSieve
+	size_t count = 0;
+	PrimesSieve<uint_fast64_t> primes_sieve;
+	primes_sieve.for_each_prime(0, 1024*64 - 1, [&count] (uint_fast64_t p) -> bool {
+		assert(sieve.is_prime(p));
+		if (count < small_primes.size()) assert(small_primes[count] == p);
+		++count;
+		return false;
+	});
+	assert(count == sieve.count());
+	for (uint_fast64_t n=0; n<1024*64; ++n) assert(sieve.is_prime(n) == my_is_prime(n));
+}
+
+void tests_suite() {
+	test_isqrt();
+	test_fill_primes();
+	test_segments();
+	test_ranges();
+	test_iterator();
+	test_constexpr();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
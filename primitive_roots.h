@@ -6,12 +6,16 @@
 #include "canonic_factors.h"
 #include "mul_mod.h"
 
-template <typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+// MOD_CONTEXT_TYPE - MulModContext or other class with the same interface (MontgomeryContext for odd moduli, BarrettContext for any ones)
+template <
+	typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE,
+	typename MOD_CONTEXT_TYPE = MulModContext<NUM_TYPE, NUM_TYPE_MAX_MASK, OPERATION_TYPE>
+>
 class PrimitiveRoots {
 public:
 	typedef NUM_TYPE num_type;
 private:
-	typedef MulMod<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> mul_mod_type;
+	typedef MOD_CONTEXT_TYPE mod_context_type;
 	typedef CanonicFactorsTemplate<num_type, MAX_POW_COUNT> cft_type;
 	typedef typename cft_type::pow_count_type pow_count_type;
 	typedef typename cft_type::PrimePow prime_pow_type;
@@ -20,18 +24,34 @@ public:
 	typedef typename cft_type::CanonicFactorizer canonic_factorizer_type;
 	
 private:
+	// exps[i] == radical / q_i by prime factors q_i of modulo - 1 (the largest one first),
+	// radical is their product
 	num_type exps[MAX_POW_COUNT];
+	num_type radical;
+	// (modulo - 1) / radical
+	num_type common_exp;
 	num_type modulo;
+	mod_context_type context;
 	pow_count_type exps_count;
 	
 	PrimitiveRoots() = delete;
 	PrimitiveRoots(const PrimitiveRoots &b) = delete;
 	PrimitiveRoots& operator=(const PrimitiveRoots &b) = delete;
 	
+	// exps[i] == (modulo - 1) / q_i before, they share common_exp
+	constexpr void split_common_exp() {
+		const num_type modulo_1 = modulo - 1;
+		radical = 1;
+		for (pow_count_type i=0; i<exps_count; ++i) radical *= modulo_1 / exps[i];
+		common_exp = modulo_1 / radical;
+		for (pow_count_type i=0; i<exps_count; ++i) exps[i] /= common_exp;
+	}
+	
 public:
 	// modulo must be prime
-	PrimitiveRoots(canonic_factorizer_type &canonic_factorizer, num_type b_modulo) : modulo(b_modulo) {
+	PrimitiveRoots(canonic_factorizer_type &canonic_factorizer, num_type b_modulo) : radical(1), common_exp(1), modulo(b_modulo) {
 		assert(modulo >= 2);
+		if (modulo > 2) context.assign(modulo);
 		if (modulo <= 3) {
 			exps_count = 0;
 			return;
@@ -47,14 +67,53 @@ public:
 			assert(modulo_1 % prime_factors[i].prime == 0);
 			exps[exps_count-i-1] = modulo_1 / prime_factors[i].prime;
 		}
+		split_common_exp();
+	}
+	
+	// modulo must be prime, modulo - 1 is factorized by trial division,
+	// constexpr, so exps of modulus known at compile time are built at compile time:
+	//     static constexpr PrimitiveRoots<uint32_t, 9, 1U<<31, uint64_t, FixedMulModContext<...>> prrs(P);
+	constexpr explicit PrimitiveRoots(num_type b_modulo) : exps(), radical(1), common_exp(1), modulo(b_modulo), context(), exps_count(0) {
+		assert(modulo >= 2);
+		if (modulo > 2) context.assign(modulo);
+		if (modulo <= 3) return;
+		
+		const num_type modulo_1 = modulo - 1;
+		num_type m = modulo_1;
+		// ascending prime factors, then reversed as by constructor with canonic factorizer
+		for (num_type d=2; d <= m / d; d += (d == 2 ? 1 : 2)) {
+			if (m % d) continue;
+			assert(exps_count < MAX_POW_COUNT);
+			exps[exps_count++] = modulo_1 / d;
+			do {
+				m /= d;
+			} while (!(m % d));
+		}
+		if (m > 1) {
+			assert(exps_count < MAX_POW_COUNT);
+			exps[exps_count++] = modulo_1 / m;
+		}
+		for (pow_count_type i=0; i<exps_count/2; ++i) {
+			const num_type t = exps[i];
+			exps[i] = exps[exps_count-i-1];
+			exps[exps_count-i-1] = t;
+		}
+		split_common_exp();
 	}
 	
 	// gcd(modulo, root) == 1
-	bool is_primitive_root(num_type root) const {
-		assert(mul_mod_type::pow_mod(modulo, root, modulo-1) == 1);
+	// root^((modulo - 1) / q_i) == (root^common_exp)^exps[i] for all q_i by one chain of squares, see MultiPow
+	constexpr bool is_primitive_root(num_type root) const {
+		if (exps_count == 0) return true;
+		const num_type x = context.pow(context.to_form(root), common_exp);
+#ifndef NDEBUG
+		// root^(modulo - 1)
+		assert(context.pow(x, radical) == context.one());
+#endif
+		num_type pows[MAX_POW_COUNT] = {};
+		MultiPow<mod_context_type>::pow(context, x, exps, exps_count, pows);
 		for (pow_count_type i=0; i<exps_count; ++i) {
-			num_type pow = mul_mod_type::pow_mod(modulo, root, exps[i]);
-			if (pow == 1) return false;
+			if (pows[i] == context.one()) return false;
 		}
 		return true;
 	}
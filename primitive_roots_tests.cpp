@@ -13,6 +13,16 @@
 #undef tests_suite
 #undef test_max_primitive_root
 
+typedef PrimitiveRoots<uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t> prrs32_type;
+typedef PrimitiveRoots<
+	uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t,
+	MontgomeryContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> prrs32_montgomery_type;
+typedef PrimitiveRoots<
+	uint_fast32_t, 9, ((uint_fast32_t)1)<<31, uint_fast64_t,
+	BarrettContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> prrs32_barrett_type;
+
 void test_is_primitive_root() {
 	typedef uint_fast32_t num_type;
 	typedef PrimitiveRoots<num_type, 9, ((num_type)1)<<31, uint_fast64_t> prrs_type;
@@ -51,15 +61,16 @@ void test_is_primitive_root() {
 	}
 }
 
+template <typename PRRS_TYPE>
 void test_max_primitive_root() {
 	fill_myprimes();
 	fill_max_roots();
 
 	typedef uint_fast32_t num_type;
-	typedef PrimitiveRoots<num_type, 9, ((num_type)1)<<31, uint_fast64_t> prrs_type;
+	typedef PRRS_TYPE prrs_type;
 	
-	typedef prrs_type::canonic_factorizer_type cfzr_type;
-	typedef cfzr_type::primes_array_type primes_array_type;
+	typedef typename prrs_type::canonic_factorizer_type cfzr_type;
+	typedef typename cfzr_type::primes_array_type primes_array_type;
 	// pi(2^16) = 6542
 	num_type primes[6542];
 	size_t primes_count = primes_array_type::fill_primes(
@@ -84,9 +95,38 @@ void test_max_primitive_root() {
 	}
 }
 
+// exps of modulus known at compile time are built at compile time
+void test_fixed_modulus() {
+	typedef uint_fast32_t num_type;
+	static constexpr num_type P = 998244353;
+	typedef PrimitiveRoots<
+		num_type, 9, ((num_type)1)<<31, uint_fast64_t,
+		FixedMulModContext<num_type, P, ((num_type)1)<<31, uint_fast64_t>
+	> prrs_fixed_type;
+	static constexpr prrs_fixed_type fixed(P);
+	static_assert(fixed.is_primitive_root(3) && !fixed.is_primitive_root(2), "3 is the least primitive root modulo 998244353");
+	
+	// the same as of constructor with canonic factorizer, trial division of modulo - 1 for every prime < 2^16
+	typedef prrs32_type::canonic_factorizer_type cfzr_type;
+	typedef cfzr_type::primes_array_type primes_array_type;
+	num_type primes[6542];
+	const size_t primes_count = primes_array_type::fill_primes(primes, sizeof(primes) / sizeof(primes[0]), (num_type)UINT16_MAX + 1);
+	cfzr_type cfzr(primes_array_type(primes, primes_count));
+	for (size_t idx=0; idx<primes_count; ++idx) {
+		const prrs32_type by_factorizer(cfzr, primes[idx]);
+		const prrs32_type by_trial_division(primes[idx]);
+		for (num_type a=1; a<primes[idx] && a<64; ++a) assert(by_trial_division.is_primitive_root(a) == by_factorizer.is_primitive_root(a));
+	}
+	const prrs32_type plain(P);
+	for (num_type a=1; a<1024; ++a) assert(fixed.is_primitive_root(a) == plain.is_primitive_root(a));
+}
+
 void tests_suite() {
 	//test_is_primitive_root();
-	test_max_primitive_root();
+	test_max_primitive_root<prrs32_type>();
+	test_max_primitive_root<prrs32_montgomery_type>();
+	test_max_primitive_root<prrs32_barrett_type>();
+	test_fixed_modulus();
 }
 
 int main() {
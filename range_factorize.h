@@ -0,0 +1,148 @@
+#ifndef RANGE_FACTORIZE_H
+#define RANGE_FACTORIZE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <vector>
+#include "factorize.h"
+#include "canonic_factors.h"
+#include "primes_sieve.h"
+
+// Factorization of every number of [a, b] by segmented factor sieve:
+// every prime p <= sqrt(b) is divided out of its multiples inside of segment,
+// cofactor > 1 left after that is a prime.
+// Division by p is exact, so it is multiplication by inverse of p (see PrimeInverse).
+// Memory: segment (remaining cofactors and MAX_POW_COUNT prime powers per number) and primes <= sqrt(b).
+template<typename NUM_TYPE, uint_fast8_t MAX_POW_COUNT>
+class RangeFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef CanonicFactorsTemplate<num_type, MAX_POW_COUNT> canonic_factors_type;
+	typedef typename canonic_factors_type::PrimePow prime_pow_type;
+	typedef typename canonic_factors_type::exp_type exp_type;
+	typedef typename canonic_factors_type::pow_count_type pow_count_type;
+	typedef typename canonic_factors_type::CanonicFactorizer canonic_factorizer_type;
+	typedef PrimeInverse<num_type> prime_inverse_type;
+	// numbers per segment
+	static constexpr size_t DEFAULT_SEGMENT_SIZE = 16*1024;
+
+private:
+	// odd primes <= primes_limit
+	std::vector<num_type> primes;
+	std::vector<prime_inverse_type> inverses;
+	num_type primes_limit;
+	// offset of next multiple of primes[k] from start of current segment
+	std::vector<size_t> next_offsets;
+	size_t active_count;
+	std::vector<num_type> cofactors;
+	std::vector<pow_count_type> pow_counts;
+	// MAX_POW_COUNT per number of segment
+	std::vector<prime_pow_type> pows;
+
+	RangeFactorizer(const RangeFactorizer &b) = delete;
+	RangeFactorizer& operator=(const RangeFactorizer &b) = delete;
+
+public:
+	RangeFactorizer(size_t segment_size = DEFAULT_SEGMENT_SIZE) :
+		primes_limit(2), active_count(0), cofactors(segment_size), pow_counts(segment_size), pows(segment_size * MAX_POW_COUNT) {
+		assert(segment_size > 0);
+	}
+
+	size_t segment_size() const {
+		return cofactors.size();
+	}
+
+	// calls cb for every n in [a, b] in ascending order, 0 < a <= b
+	// if cb returns true, factorization interrupts and function returns true
+	// CB - callable as bool(num_type n, const prime_pow_type pows[], pow_count_type pow_count),
+	//     prime powers are in ascending order of primes, pows are valid during call only
+	template <typename CB>
+	bool factorize(num_type a, num_type b, CB &&cb) {
+		assert(a > 0 && a <= b);
+		extend_primes((num_type)PrimesSieve<num_type>::isqrt(b));
+		const size_t size = cofactors.size();
+		active_count = 0;
+		for (num_type low=a;;) {
+			const num_type high = (b - low < size ? b : low + (num_type)(size - 1));
+			sieve_segment(low, high);
+			const size_t count = (size_t)(high - low) + 1;
+			for (size_t i=0; i<count; ++i) {
+				if (cb((num_type)(low + i), &pows[i * MAX_POW_COUNT], pow_counts[i])) return true;
+			}
+			if (high == b) return false;
+			low = high + 1;
+		}
+	}
+
+	// calls cb for every n in [a, b] in ascending order, 0 < a <= b
+	// CB - callable as bool(num_type n, const CanonicFactors &factors)
+	template <typename CB>
+	bool factorize(num_type a, num_type b, canonic_factorizer_type &canonic_factorizer, CB &&cb) {
+		return factorize(a, b, [&canonic_factorizer, &cb] (num_type n, const prime_pow_type n_pows[], pow_count_type pow_count) -> bool {
+			return cb(n, typename canonic_factors_type::CanonicFactors(canonic_factorizer, n_pows, pow_count));
+		});
+	}
+
+private:
+	void push_pow(size_t idx, num_type prime, exp_type exp) {
+		assert(pow_counts[idx] < MAX_POW_COUNT);
+		prime_pow_type &pow = pows[idx * MAX_POW_COUNT + pow_counts[idx]++];
+		pow.prime = prime;
+		pow.exp = exp;
+	}
+
+	void sieve_segment(num_type low, num_type high) {
+		const size_t count = (size_t)(high - low) + 1;
+		for (size_t i=0; i<count; ++i) {
+			cofactors[i] = low + i;
+			pow_counts[i] = 0;
+		}
+
+		for (size_t i=(low & 1); i<count; i+=2) {
+			const exp_type exp = __builtin_ctzll(cofactors[i]);
+			cofactors[i] >>= exp;
+			push_pow(i, 2, exp);
+		}
+
+		while (active_count < primes.size() && primes[active_count] <= high / primes[active_count]) {
+			// first multiple of p >= low
+			const num_type p = primes[active_count];
+			next_offsets[active_count] = (p - low % p) % p;
+			++active_count;
+		}
+		for (size_t k=0; k<active_count; ++k) {
+			const num_type p = primes[k];
+			const prime_inverse_type &inverse = inverses[k];
+			size_t i = next_offsets[k];
+			for (; i<count; i+=p) {
+				num_type cofactor = prime_inverse_type::mul_low(cofactors[i], inverse.inverse);
+				exp_type exp = 1;
+				while (inverse.divide(cofactor)) ++exp;
+				cofactors[i] = cofactor;
+				push_pow(i, p, exp);
+			}
+			next_offsets[k] = i - count;
+		}
+
+		for (size_t i=0; i<count; ++i) {
+			if (cofactors[i] > 1) push_pow(i, cofactors[i], 1);
+		}
+	}
+
+	void extend_primes(num_type limit) {
+		if (limit <= primes_limit) return;
+		PrimesSieve<num_type> sieve;
+		sieve.for_each_prime((typename PrimesSieve<num_type>::pos_type)primes_limit + 1, limit, [this] (num_type p) -> bool {
+			if (p > 2) {
+				primes.push_back(p);
+				inverses.push_back(prime_inverse_type(p));
+				next_offsets.push_back(0);
+			}
+			return false;
+		});
+		primes_limit = limit;
+	}
+};
+
+#endif/*RANGE_FACTORIZE_H*/
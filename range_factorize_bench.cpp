@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <vector>
+#include "range_factorize.h"
+
+typedef RangeFactorizer<uint_fast64_t, 15> range_fzr_type;
+typedef range_fzr_type::num_type num_type;
+typedef Factorizer<num_type> fzr_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// sum of divisors counts over [a, b]
+num_type bench_range(num_type a, num_type b, size_t segment_size) {
+	range_fzr_type range_factorizer(segment_size);
+	num_type sum = 0;
+	double t0 = get_time();
+	range_factorizer.factorize(a, b, [&sum] (num_type n, const range_fzr_type::prime_pow_type pows[], range_fzr_type::pow_count_type pow_count) -> bool {
+		(void)n;
+		num_type count = 1;
+		for (range_fzr_type::pow_count_type i=0; i<pow_count; ++i) count *= pows[i].exp + 1;
+		sum += count;
+		return false;
+	});
+	double t = get_time() - t0;
+	printf("range factorizer, segment %6u  %9.3f ms, %7.2f M numbers/s\n", (unsigned int)segment_size, t * 1e3, (b - a + 1) / t * 1e-6);
+	return sum;
+}
+
+num_type bench_factorizer(num_type a, num_type b) {
+	const num_type limit = PrimesSieve<num_type>::isqrt(b);
+	std::vector<num_type> primes(limit / 2 + 1);
+	size_t primes_count = fzr_type::fill_primes(primes.data(), primes.size(), limit);
+	std::vector<fzr_type::prime_inverse_type> inverses(primes_count);
+	fzr_type::primes_array_type::fill_inverses(primes.data(), primes_count, inverses.data());
+	DivisorsCounter<num_type> divisors_counter(fzr_type::primes_array_type(primes.data(), primes_count, inverses.data()));
+	num_type sum = 0;
+	double t0 = get_time();
+	for (num_type n=a; n<=b; ++n) sum += divisors_counter.divisors_count(n);
+	double t = get_time() - t0;
+	printf("DivisorsCounter per number          %9.3f ms, %7.2f M numbers/s\n", t * 1e3, (b - a + 1) / t * 1e-6);
+	return sum;
+}
+
+int main() {
+	const num_type bases[] = {1000000000ULL, 1000000000000ULL};
+	for (size_t i=0; i<sizeof(bases)/sizeof(bases[0]); ++i) {
+		const num_type a = bases[i], b = bases[i] + 1024*1024 - 1;
+		printf("[%" PRIuFAST64 ", %" PRIuFAST64 "]\n", a, b);
+		const num_type sum = bench_range(a, b, range_fzr_type::DEFAULT_SEGMENT_SIZE);
+		assert(bench_range(a, b, 1024*4) == sum);
+		assert(bench_range(a, b, 1024*64) == sum);
+		// per number factorization is much slower, so its range is shorter
+		bench_factorizer(a, a + 1024*64 - 1);
+		(void)sum;
+	}
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "range_factorize.h"
+
+typedef RangeFactorizer<uint_fast64_t, 15> range_fzr_type;
+typedef range_fzr_type::canonic_factors_type cft_type;
+
+void check_range(range_fzr_type &range_factorizer, cft_type::CanonicFactorizer &cfzr, uint_fast64_t a, uint_fast64_t b) {
+	uint_fast64_t next = a;
+	bool interrupted = range_factorizer.factorize(a, b, [&] (uint_fast64_t n, const range_fzr_type::prime_pow_type pows[], range_fzr_type::pow_count_type pow_count) -> bool {
+		assert(n == next);
+		++next;
+		cft_type::CanonicFactors my_factors(cfzr, n);
+		cft_type::PrimePow my_pows[15];
+		assert(my_factors.copy(my_pows, 15) == pow_count);
+		for (range_fzr_type::pow_count_type i=0; i<pow_count; ++i) {
+			assert(pows[i].prime == my_pows[i].prime);
+			assert(pows[i].exp == my_pows[i].exp);
+		}
+		return false;
+	});
+	assert(!interrupted);
+	assert(next == b + 1);
+}
+
+void test_factorize() {
+	uint_fast64_t primes[1024];
+	size_t primes_count = Factorizer<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	cft_type::CanonicFactorizer cfzr(cft_type::CanonicFactorizer::primes_array_type(primes, primes_count));
+
+	const size_t segment_sizes[] = {1, 2, 7, 1024, range_fzr_type::DEFAULT_SEGMENT_SIZE};
+	for (size_t i=0; i<sizeof(segment_sizes)/sizeof(segment_sizes[0]); ++i) {
+		range_fzr_type range_factorizer(segment_sizes[i]);
+		assert(range_factorizer.segment_size() == segment_sizes[i]);
+		check_range(range_factorizer, cfzr, 1, 1);
+		check_range(range_factorizer, cfzr, 1, 1024*16);
+		check_range(range_factorizer, cfzr, 1000, 1001);
+		// primes are extended by the next range
+		check_range(range_factorizer, cfzr, UINT32_MAX - 1024*4, (uint_fast64_t)UINT32_MAX + 1024*4);
+		check_range(range_factorizer, cfzr, 1000000000000ULL - 64, 1000000000000ULL + 64);
+	}
+}
+
+void test_factorize_32() {
+	typedef RangeFactorizer<uint32_t, 9> range_fzr32_type;
+	typedef range_fzr32_type::canonic_factors_type cft32_type;
+	range_fzr32_type range_factorizer(1000);
+	cft32_type::CanonicFactorizer cfzr;
+	// range ends at the last 32-bit number
+	uint32_t next = UINT32_MAX - 1024*4;
+	range_factorizer.factorize(UINT32_MAX - 1024*4, UINT32_MAX, cfzr, [&] (uint32_t n, const cft32_type::CanonicFactors &factors) -> bool {
+		assert(n == next);
+		++next;
+		assert(factors.value() == n);
+		return false;
+	});
+	assert(next == 0);
+}
+
+void test_interrupt() {
+	range_fzr_type range_factorizer(100);
+	uint_fast64_t last = 0;
+	bool interrupted = range_factorizer.factorize(1, 1000, [&last] (uint_fast64_t n, const range_fzr_type::prime_pow_type pows[], range_fzr_type::pow_count_type pow_count) -> bool {
+		(void)pows;
+		(void)pow_count;
+		last = n;
+		return n == 250;
+	});
+	assert(interrupted && last == 250);
+}
+
+void test_canonic_factors() {
+	range_fzr_type range_factorizer;
+	cft_type::CanonicFactorizer cfzr;
+	DivisorsCounter<uint_fast64_t>::primes_array_type primes_array;
+	DivisorsCounter<uint_fast64_t> divisors_counter(primes_array);
+	range_factorizer.factorize(1, 1024*16, cfzr, [&] (uint_fast64_t n, const cft_type::CanonicFactors &factors) -> bool {
+		assert(factors.value() == n);
+		cft_type::PrimePow pows[15];
+		const size_t pow_count = factors.copy(pows, 15);
+		uint_fast64_t divisors_count = 1;
+		for (size_t i=0; i<pow_count; ++i) divisors_count *= pows[i].exp + 1;
+		assert(divisors_count == divisors_counter.divisors_count(n));
+		return false;
+	});
+}
+
+void tests_suite() {
+	test_factorize();
+	test_factorize_32();
+	test_interrupt();
+	test_canonic_factors();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -0,0 +1,272 @@
+#ifndef RESUMABLE_FACTORIZE_H
+#define RESUMABLE_FACTORIZE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "factorize.h"
+#include "mul_mod.h"
+#include "miller_rabin.h"
+#include "pollard_rho.h"
+
+// Factorization of one number which may be interrupted by budget and resumed later:
+// trial division by primes in ascending order, then Brent's variant of Pollard's rho
+// for every composite cofactor like RhoFactorizer does.
+// Found prime powers and unfactored composites are kept between calls of resume,
+// so a scheduler may interleave many factorizations or settle for a partial one.
+// Work is counted in iterations: one trial divisor of one composite or one step of rho.
+// Budget is checked between batches (TRIAL_BATCH trial divisors or GCD_BATCH steps of rho),
+// so resume may exceed it by one batch.
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class ResumableFactorization {
+public:
+	typedef NUM_TYPE num_type;
+	typedef RhoFactorizer<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> rho_factorizer_type;
+	typedef typename rho_factorizer_type::trial_factorizer_type trial_factorizer_type;
+	typedef typename trial_factorizer_type::primes_array_type primes_array_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename rho_factorizer_type::mul_mod_type mul_mod_type;
+	static constexpr num_type DEFAULT_TRIAL_BOUND = 1024;
+	// rho needs composites without small prime factors, trial division always goes so far
+	static constexpr num_type MIN_TRIAL_BOUND = 16;
+	// budget is checked once per so many primes of primes array
+	static constexpr size_t TRIAL_BATCH = 256;
+	// above primes array trial division goes by ranges of so many numbers
+	static constexpr num_type TRIAL_RANGE = 30 * 256;
+	static constexpr uint_fast16_t GCD_BATCH = rho_factorizer_type::GCD_BATCH;
+
+	struct PrimePow {
+		num_type prime;
+		exp_type exp;
+	};
+
+	// trial division by primes <= trial_bound, then rho
+	// iterations, seconds - limits of one call of resume, 0 - no limit
+	struct Budget {
+		num_type trial_bound;
+		uint64_t iterations;
+		double seconds;
+
+		Budget(num_type b_trial_bound = DEFAULT_TRIAL_BOUND, uint64_t b_iterations = 0, double b_seconds = 0) :
+			trial_bound(b_trial_bound), iterations(b_iterations), seconds(b_seconds) {}
+	};
+
+private:
+	// Brent's rho of the last composite, see RhoFactorizer::brent:
+	// y is advanced r times from x (i steps done), then k of r steps accumulate |x - y| to q
+	struct RhoState {
+		num_type n;
+		num_type c;
+		num_type x;
+		num_type y;
+		num_type q;
+		uint64_t r;
+		uint64_t i;
+		uint64_t k;
+	};
+
+	primes_array_type primes_array;
+	num_type n;
+	// ascending primes
+	std::vector<PrimePow> factors;
+	// every one is composite without prime factors <= trial_last
+	std::vector<num_type> composites;
+	// the next prime of primes array to try
+	size_t trial_idx;
+	num_type trial_last;
+	RhoState rho;
+	uint64_t iterations;
+
+public:
+	ResumableFactorization(primes_array_type b_primes_array, num_type b_n) :
+		primes_array(b_primes_array), n(b_n), trial_idx(b_primes_array.count > 0 ? 1 : 0), trial_last(2), iterations(0) {
+		assert(n > 0);
+		// primes[0] == 2
+		assert(primes_array.count == 0 || primes_array.primes[0] == 2);
+		rho.n = 0;
+		num_type m = n;
+		if (m > 1) {
+			const uint_fast8_t exp = UnsignedOps<num_type>::ctz(m);
+			m >>= exp;
+			if (exp > 0) add_factor(2, exp);
+			classify(m);
+		}
+	}
+
+	// use default copy constructor and assignment operator
+
+	num_type get_n() const {
+		return n;
+	}
+
+	bool is_complete() const {
+		return composites.empty();
+	}
+
+	// prime factors found so far in ascending order
+	const std::vector<PrimePow>& get_factors() const {
+		return factors;
+	}
+
+	// unfactored composites, their product is get_cofactor()
+	const std::vector<num_type>& get_composites() const {
+		return composites;
+	}
+
+	// n divided by prime powers of get_factors()
+	num_type get_cofactor() const {
+		num_type cofactor = 1;
+		for (size_t i=0; i<composites.size(); ++i) cofactor *= composites[i];
+		return cofactor;
+	}
+
+	// iterations of all calls of resume
+	uint64_t get_iterations() const {
+		return iterations;
+	}
+
+	// continues factorization until it is complete or budget is over
+	// returns true if factorization is complete
+	bool resume(const Budget &budget = Budget()) {
+		typedef std::chrono::steady_clock clock_type;
+		const clock_type::time_point start = clock_type::now();
+		const uint64_t iterations_end = (budget.iterations == 0 ? UINT64_MAX : iterations + budget.iterations);
+		auto is_over = [this, &budget, start, iterations_end] () -> bool {
+			if (iterations >= iterations_end) return true;
+			return budget.seconds > 0 && std::chrono::duration<double>(clock_type::now() - start).count() >= budget.seconds;
+		};
+		const num_type bound = (budget.trial_bound > MIN_TRIAL_BOUND ? budget.trial_bound : MIN_TRIAL_BOUND);
+		while (!composites.empty() && trial_last < bound) {
+			if (is_over()) return false;
+			trial_batch(bound);
+		}
+		while (!composites.empty()) {
+			if (is_over()) return false;
+			rho_batch();
+		}
+		return true;
+	}
+
+private:
+	void add_factor(num_type p, exp_type exp) {
+		auto it = std::lower_bound(factors.begin(), factors.end(), p, [] (const PrimePow &pow, num_type prime) -> bool {
+			return pow.prime < prime;
+		});
+		if (it != factors.end() && it->prime == p) {
+			it->exp += exp;
+		} else {
+			factors.insert(it, PrimePow{p, exp});
+		}
+	}
+
+	// m - 1, prime or composite without prime factors <= trial_last
+	void classify(num_type m) {
+		if (m == 1) return;
+		if (m / trial_last < trial_last || rho_factorizer_type::is_prime(m)) {
+			add_factor(m, 1);
+		} else {
+			composites.push_back(m);
+		}
+	}
+
+	// trial division of every composite by the next batch of primes <= bound
+	void trial_batch(num_type bound) {
+		std::vector<num_type> pieces;
+		pieces.swap(composites);
+		num_type last = trial_last;
+		auto cb = [this] (num_type p, exp_type exp) -> bool {
+			add_factor(p, exp);
+			return false;
+		};
+		if (trial_idx < primes_array.count) {
+			const size_t end = std::min(trial_idx + TRIAL_BATCH, primes_array.count);
+			for (; trial_idx < end; ++trial_idx) {
+				const num_type p = primes_array.primes[trial_idx];
+				if (p > bound) {
+					last = bound;
+					break;
+				}
+				for (size_t j=0; j<pieces.size(); ++j) {
+					if (pieces[j] % p) continue;
+					exp_type exp = 0;
+					do {
+						pieces[j] /= p;
+						++exp;
+					} while (!(pieces[j] % p));
+					cb(p, exp);
+				}
+				iterations += pieces.size();
+				last = p;
+			}
+		} else {
+			// Factorizer::tail_division tries numbers coprime to 30: 8 of every 30,
+			// its wheel starts from number coprime to 30
+			num_type from = trial_last;
+			while (from > 7 && (!(from & 1) || from % 3 == 0 || from % 5 == 0)) --from;
+			last = (bound - last > TRIAL_RANGE ? last + TRIAL_RANGE : bound);
+			for (size_t j=0; j<pieces.size(); ++j) trial_factorizer_type::tail_division(pieces[j], from, last, cb);
+			iterations += pieces.size() * (uint64_t)((last - trial_last) * 8 / 30);
+		}
+		trial_last = last;
+		for (size_t j=0; j<pieces.size(); ++j) classify(pieces[j]);
+	}
+
+	void rho_reset(num_type m, num_type c) {
+		assert(c < m - 2);
+		rho = RhoState{m, c, 2, 2, 1, 1, 0, 0};
+	}
+
+	// at most GCD_BATCH steps of rho for the last composite
+	void rho_batch() {
+		const num_type m = composites.back();
+		if (rho.n != m) rho_reset(m, 1);
+		if (rho.i < rho.r) {
+			const uint64_t steps = std::min<uint64_t>((uint64_t)GCD_BATCH, rho.r - rho.i);
+			for (uint64_t s=0; s<steps; ++s) rho.y = rho_factorizer_type::rho_step(m, rho.y, rho.c);
+			rho.i += steps;
+			iterations += steps;
+			return;
+		}
+		const num_type ys = rho.y;
+		const uint64_t steps = std::min<uint64_t>((uint64_t)GCD_BATCH, rho.r - rho.k);
+		for (uint64_t s=0; s<steps; ++s) {
+			rho.y = rho_factorizer_type::rho_step(m, rho.y, rho.c);
+			rho.q = mul_mod_type::mul_mod(m, rho.q, rho_factorizer_type::abs_diff(rho.x, rho.y));
+		}
+		rho.k += steps;
+		iterations += steps;
+		num_type g = rho_factorizer_type::gcd(rho.q, m);
+		if (g == m) {
+			// batch overshot, repeat it step by step
+			num_type y = ys;
+			do {
+				y = rho_factorizer_type::rho_step(m, y, rho.c);
+				g = rho_factorizer_type::gcd(rho_factorizer_type::abs_diff(rho.x, y), m);
+			} while (g == 1);
+		}
+		if (g == 1) {
+			if (rho.k == rho.r) {
+				rho.x = rho.y;
+				rho.r <<= 1;
+				rho.i = 0;
+				rho.k = 0;
+			}
+			return;
+		}
+		if (g == m) {
+			// search failed, the next c
+			rho_reset(m, rho.c + 1);
+			return;
+		}
+		composites.pop_back();
+		rho.n = 0;
+		classify(g);
+		classify(m / g);
+	}
+};
+
+#endif/*RESUMABLE_FACTORIZE_H*/
@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "resumable_factorize.h"
+
+typedef ResumableFactorization<uint128_t, ((uint128_t)1)<<127, uint128_t> rf_type;
+typedef rf_type::rho_factorizer_type rho_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!rho_type::is_prime(n)) ++n;
+	return n;
+}
+
+// p * q, p of bits bits
+uint128_t semiprime(std::mt19937_64 &rng, uint_fast8_t bits) {
+	const uint128_t p = next_prime((rng() >> (65 - bits)) | ((uint128_t)1 << (bits - 1)));
+	return p * next_prime((rng() >> 4) | ((uint128_t)1 << 59));
+}
+
+int main() {
+	rf_type::primes_array_type primes;
+	rho_type rho_factorizer(primes);
+	std::mt19937_64 rng(1);
+
+	// every 16th number is hard: smallest factor of 40 bits instead of 20
+	std::vector<uint128_t> numbers(256);
+	for (size_t i=0; i<numbers.size(); ++i) numbers[i] = semiprime(rng, (i % 16 == 0 ? 40 : 20));
+
+	// one by one: overhead of resumable state
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		rho_factorizer.factorize(numbers[i], [] (uint128_t prime, rho_type::exp_type exp) -> bool {
+			(void)prime;
+			(void)exp;
+			return false;
+		});
+	}
+	const double t_rho = get_time() - t0;
+	t0 = get_time();
+	double latency_sum = 0;
+	for (size_t i=0; i<numbers.size(); ++i) {
+		rf_type rf(primes, numbers[i]);
+		rf.resume();
+		latency_sum += get_time() - t0;
+	}
+	const double t_resumable = get_time() - t0;
+	printf("%-44s %10.6f s\n", "RhoFactorizer, one by one", t_rho);
+	printf("%-44s %10.6f s, mean latency %.6f s\n", "ResumableFactorization, one by one", t_resumable, latency_sum / numbers.size());
+
+	// round robin: the same work, easy numbers are not stuck behind hard ones
+	const uint64_t slices[] = {1024, 16384};
+	for (size_t s=0; s<sizeof(slices)/sizeof(slices[0]); ++s) {
+		t0 = get_time();
+		latency_sum = 0;
+		std::vector<rf_type> queue;
+		for (size_t i=0; i<numbers.size(); ++i) queue.push_back(rf_type(primes, numbers[i]));
+		while (!queue.empty()) {
+			for (size_t i=0; i<queue.size();) {
+				if (queue[i].resume(rf_type::Budget(rf_type::DEFAULT_TRIAL_BOUND, slices[s]))) {
+					assert(queue[i].get_factors().size() == 2);
+					latency_sum += get_time() - t0;
+					queue[i] = queue.back();
+					queue.pop_back();
+				} else {
+					++i;
+				}
+			}
+		}
+		char name[64];
+		snprintf(name, sizeof(name), "round robin, %llu iterations per slice", (unsigned long long)slices[s]);
+		printf("%-44s %10.6f s, mean latency %.6f s\n", name, get_time() - t0, latency_sum / numbers.size());
+	}
+	return 0;
+}
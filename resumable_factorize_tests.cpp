@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <random>
+#include "resumable_factorize.h"
+
+typedef ResumableFactorization<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> rf_type;
+typedef ResumableFactorization<uint128_t, ((uint128_t)1)<<127, uint128_t> rf128_type;
+typedef rf_type::rho_factorizer_type rho_fzr_type;
+
+// product of found prime powers and cofactor is n, primes are ascending
+template <typename RF_TYPE>
+void check_state(const RF_TYPE &rf) {
+	typedef typename RF_TYPE::num_type num_type;
+	num_type m = rf.get_cofactor();
+	const std::vector<typename RF_TYPE::PrimePow> &factors = rf.get_factors();
+	for (size_t j=0; j<factors.size(); ++j) {
+		assert(j == 0 || factors[j-1].prime < factors[j].prime);
+		assert(RF_TYPE::rho_factorizer_type::is_prime(factors[j].prime));
+		for (uint_fast8_t k=0; k<factors[j].exp; ++k) m *= factors[j].prime;
+	}
+	assert(m == rf.get_n());
+	assert(rf.is_complete() == (rf.get_cofactor() == 1));
+	for (size_t j=0; j<rf.get_composites().size(); ++j) assert(!RF_TYPE::rho_factorizer_type::is_prime(rf.get_composites()[j]));
+}
+
+void test_complete() {
+	uint_fast64_t primes[1024];
+	const size_t primes_count = PrimesArray<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	rf_type::primes_array_type primes_array(primes, primes_count);
+	rho_fzr_type rho_factorizer(primes_array);
+	std::mt19937_64 rng(1);
+	// without budget the same factors as of RhoFactorizer, with and without primes array
+	for (uint_fast16_t i=0; i<1024; ++i) {
+		const uint_fast64_t n = rng() >> (rng() % 64);
+		if (n == 0) continue;
+		rf_type rf(primes_array, n), rf_empty(rf_type::primes_array_type(), n);
+		assert(rf.resume() && rf_empty.resume());
+		check_state(rf);
+		assert(rf.get_factors().size() == rf_empty.get_factors().size());
+		size_t j = 0;
+		rho_factorizer.factorize(n, [&rf, &rf_empty, &j] (uint_fast64_t prime, rf_type::exp_type exp) -> bool {
+			assert(rf.get_factors()[j].prime == prime && rf.get_factors()[j].exp == exp);
+			assert(rf_empty.get_factors()[j].prime == prime && rf_empty.get_factors()[j].exp == exp);
+			++j;
+			return false;
+		});
+		assert(j == rf.get_factors().size());
+	}
+
+	rf_type one(primes_array, 1);
+	assert(one.is_complete() && one.get_factors().empty() && one.resume());
+	rf_type pow2(primes_array, (uint_fast64_t)1 << 40);
+	assert(pow2.is_complete() && pow2.get_factors().size() == 1 && pow2.get_factors()[0].exp == 40);
+}
+
+void test_budget() {
+	uint_fast64_t primes[1024];
+	const size_t primes_count = PrimesArray<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	rf_type::primes_array_type primes_array(primes, primes_count);
+	// trial bound: 7919 is the 1000th prime, the rest is a product of two primes of 28 bits
+	const uint_fast64_t p = 268435399, q = 268435367;
+	rf_type rf(primes_array, 3 * 3 * 7919 * p);
+	assert(!rf.resume(rf_type::Budget(1000, 1)));
+	check_state(rf);
+	assert(rf.get_factors().size() == 1 && rf.get_factors()[0].prime == 3 && rf.get_factors()[0].exp == 2);
+	assert(rf.resume(rf_type::Budget(1000)));
+	check_state(rf);
+	// 7919 > 1000, so it is left for rho
+	assert(rf.get_factors().size() == 3 && rf.get_factors()[1].prime == 7919);
+
+	// iterations: rho needs about 2^14 steps, resume runs at most one batch more than budget
+	rf_type hard(primes_array, p * q);
+	uint_fast16_t calls_count = 1;
+	uint64_t last_iterations = 0;
+	while (!hard.resume(rf_type::Budget(rf_type::DEFAULT_TRIAL_BOUND, 1000))) {
+		check_state(hard);
+		assert(hard.get_composites().size() == 1 && hard.get_cofactor() == p * q);
+		assert(hard.get_iterations() - last_iterations <= 1000 + rf_type::TRIAL_BATCH);
+		last_iterations = hard.get_iterations();
+		++calls_count;
+	}
+	check_state(hard);
+	assert(calls_count > 4);
+	assert(hard.get_factors().size() == 2 && hard.get_factors()[0].prime == q && hard.get_factors()[1].prime == p);
+	// resumed rho does the same steps as one call
+	rf_type whole(primes_array, p * q);
+	assert(whole.resume() && whole.get_iterations() == hard.get_iterations());
+
+	// trial division above primes array by ranges
+	rf_type tail(rf_type::primes_array_type(), (uint_fast64_t)1000003 * 1000033 * 999983);
+	uint_fast16_t tail_calls = 1;
+	while (!tail.resume(rf_type::Budget(2000000, 100000))) {
+		check_state(tail);
+		++tail_calls;
+	}
+	check_state(tail);
+	assert(tail_calls > 1 && tail.get_factors().size() == 3);
+}
+
+void test_time() {
+	rf128_type::primes_array_type primes;
+	// two primes of 46 bits: rho takes about 2^23 steps, far more than 10 ms
+	const uint128_t p = 70368744177643ULL, q = 70368744177607ULL;
+	rf128_type rf(primes, p * q);
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	assert(!rf.resume(rf128_type::Budget(rf128_type::DEFAULT_TRIAL_BOUND, 0, 0.01)));
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	assert(seconds >= 0.01 && seconds < 0.5);
+	check_state(rf);
+	assert(rf.get_cofactor() == p * q && rf.get_iterations() > 0);
+}
+
+int main() {
+	test_complete();
+	test_budget();
+	test_time();
+	return 0;
+}
@@ -0,0 +1,360 @@
+#ifndef SIMD_TRIAL_DIVISION_H
+#define SIMD_TRIAL_DIVISION_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_TRIAL_DIVISION_X86
+#include <immintrin.h>
+#endif
+
+// Kernels of divisibility test of one n by many primes at once,
+// p divides n <=> n * inverse mod 2^w <= limit (see PrimeInverse).
+// AVX2 tests 4 primes by 64-bit lanes or 8 primes by 32-bit lanes,
+// AVX-512 tests 8 or 16 primes, instruction set is chosen at runtime.
+// Only kernels are compiled for AVX2 and AVX-512 by target attributes, so a binary runs on any x86-64 host
+// if the rest is built without -march=native (make MARCH=), default build runs on hosts like build machine.
+struct SimdTrialDivision {
+public:
+	enum isa_type {
+		ISA_SCALAR,
+		ISA_AVX2,
+		ISA_AVX512
+	};
+
+	static bool is_supported(isa_type isa) {
+#ifdef SIMD_TRIAL_DIVISION_X86
+		__builtin_cpu_init();
+		switch (isa) {
+			case ISA_SCALAR: return true;
+			case ISA_AVX2: return __builtin_cpu_supports("avx2");
+			case ISA_AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+		}
+		return false;
+#else
+		return isa == ISA_SCALAR;
+#endif
+	}
+
+	static isa_type best_isa() {
+		static const isa_type isa = (
+			is_supported(ISA_AVX512) ? ISA_AVX512 :
+			is_supported(ISA_AVX2) ? ISA_AVX2 :
+			ISA_SCALAR
+		);
+		return isa;
+	}
+
+	static const char *isa_name(isa_type isa) {
+		switch (isa) {
+			case ISA_SCALAR: return "scalar";
+			case ISA_AVX2: return "AVX2";
+			case ISA_AVX512: return "AVX-512";
+		}
+		return "";
+	}
+
+	// first idx in [from, to) such that n * inverses[idx] <= limits[idx], to if there is no such idx
+	static size_t find_divisor(isa_type isa, uint64_t n, const uint64_t inverses[], const uint64_t limits[], size_t from, size_t to) {
+#ifdef SIMD_TRIAL_DIVISION_X86
+		if (isa == ISA_AVX512) return find_divisor_avx512(n, inverses, limits, from, to);
+		if (isa == ISA_AVX2) return find_divisor_avx2(n, inverses, limits, from, to);
+#endif
+		return find_divisor_scalar(n, inverses, limits, from, to);
+	}
+
+	static size_t find_divisor(isa_type isa, uint32_t n, const uint32_t inverses[], const uint32_t limits[], size_t from, size_t to) {
+#ifdef SIMD_TRIAL_DIVISION_X86
+		if (isa == ISA_AVX512) return find_divisor_avx512(n, inverses, limits, from, to);
+		if (isa == ISA_AVX2) return find_divisor_avx2(n, inverses, limits, from, to);
+#endif
+		return find_divisor_scalar(n, inverses, limits, from, to);
+	}
+
+private:
+	template <typename UINT_TYPE>
+	static size_t find_divisor_scalar(UINT_TYPE n, const UINT_TYPE inverses[], const UINT_TYPE limits[], size_t from, size_t to) {
+		for (size_t idx=from; idx<to; ++idx) {
+			if ((UINT_TYPE)(n * inverses[idx]) <= limits[idx]) return idx;
+		}
+		return to;
+	}
+
+#ifdef SIMD_TRIAL_DIVISION_X86
+	// low 64 bits of a * b, b == b_high:b_low, there is no 64-bit mullo in AVX2
+	__attribute__((target("avx2")))
+	static __m256i mul_low_avx2(__m256i a, __m256i b_low, __m256i b_high) {
+		const __m256i low = _mm256_mul_epu32(a, b_low);
+		const __m256i cross = _mm256_add_epi64(
+			_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b_low),
+			_mm256_mul_epu32(a, b_high)
+		);
+		return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+	}
+
+	// lanes with a > b, unsigned comparison by signed one
+	__attribute__((target("avx2")))
+	static __m256i cmpgt_epu64_avx2(__m256i a, __m256i b) {
+		const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+		return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+	}
+
+	__attribute__((target("avx2")))
+	static size_t find_divisor_avx2(uint64_t n, const uint64_t inverses[], const uint64_t limits[], size_t from, size_t to) {
+		const __m256i n_low = _mm256_set1_epi64x(n & UINT32_MAX);
+		const __m256i n_high = _mm256_set1_epi64x(n >> 32);
+		size_t idx = from;
+		for (; idx + 8 <= to; idx += 8) {
+			const __m256i q0 = mul_low_avx2(_mm256_loadu_si256((const __m256i *)(inverses + idx)), n_low, n_high);
+			const __m256i q1 = mul_low_avx2(_mm256_loadu_si256((const __m256i *)(inverses + idx + 4)), n_low, n_high);
+			const __m256i gt0 = cmpgt_epu64_avx2(q0, _mm256_loadu_si256((const __m256i *)(limits + idx)));
+			const __m256i gt1 = cmpgt_epu64_avx2(q1, _mm256_loadu_si256((const __m256i *)(limits + idx + 4)));
+			// some lane is not greater than limit
+			if (!_mm256_testc_si256(_mm256_and_si256(gt0, gt1), _mm256_set1_epi64x(-1))) break;
+		}
+		return find_divisor_scalar(n, inverses, limits, idx, to);
+	}
+
+	__attribute__((target("avx2")))
+	static size_t find_divisor_avx2(uint32_t n, const uint32_t inverses[], const uint32_t limits[], size_t from, size_t to) {
+		const __m256i n_vec = _mm256_set1_epi32(n);
+		size_t idx = from;
+		for (; idx + 16 <= to; idx += 16) {
+			const __m256i q0 = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(inverses + idx)), n_vec);
+			const __m256i q1 = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(inverses + idx + 8)), n_vec);
+			// q <= limit <=> min(q, limit) == q
+			const __m256i le0 = _mm256_cmpeq_epi32(_mm256_min_epu32(q0, _mm256_loadu_si256((const __m256i *)(limits + idx))), q0);
+			const __m256i le1 = _mm256_cmpeq_epi32(_mm256_min_epu32(q1, _mm256_loadu_si256((const __m256i *)(limits + idx + 8))), q1);
+			if (!_mm256_testz_si256(le0, le0) || !_mm256_testz_si256(le1, le1)) break;
+		}
+		return find_divisor_scalar(n, inverses, limits, idx, to);
+	}
+
+	__attribute__((target("avx512f,avx512dq")))
+	static size_t find_divisor_avx512(uint64_t n, const uint64_t inverses[], const uint64_t limits[], size_t from, size_t to) {
+		const __m512i n_vec = _mm512_set1_epi64(n);
+		size_t idx = from;
+		for (; idx + 16 <= to; idx += 16) {
+			const __m512i q0 = _mm512_mullo_epi64(_mm512_loadu_si512(inverses + idx), n_vec);
+			const __m512i q1 = _mm512_mullo_epi64(_mm512_loadu_si512(inverses + idx + 8), n_vec);
+			const __mmask8 le0 = _mm512_cmple_epu64_mask(q0, _mm512_loadu_si512(limits + idx));
+			const __mmask8 le1 = _mm512_cmple_epu64_mask(q1, _mm512_loadu_si512(limits + idx + 8));
+			if (le0 | le1) return idx + (le0 ? __builtin_ctz(le0) : 8 + __builtin_ctz(le1));
+		}
+		for (; idx < to; idx += 8) {
+			const __mmask8 mask = (to - idx >= 8 ? 0xff : (1u << (to - idx)) - 1);
+			const __m512i q = _mm512_mullo_epi64(_mm512_maskz_loadu_epi64(mask, inverses + idx), n_vec);
+			const __mmask8 le = _mm512_mask_cmple_epu64_mask(mask, q, _mm512_maskz_loadu_epi64(mask, limits + idx));
+			if (le) return idx + __builtin_ctz(le);
+		}
+		return to;
+	}
+
+	__attribute__((target("avx512f")))
+	static size_t find_divisor_avx512(uint32_t n, const uint32_t inverses[], const uint32_t limits[], size_t from, size_t to) {
+		const __m512i n_vec = _mm512_set1_epi32(n);
+		size_t idx = from;
+		for (; idx + 32 <= to; idx += 32) {
+			const __m512i q0 = _mm512_mullo_epi32(_mm512_loadu_si512(inverses + idx), n_vec);
+			const __m512i q1 = _mm512_mullo_epi32(_mm512_loadu_si512(inverses + idx + 16), n_vec);
+			const __mmask16 le0 = _mm512_cmple_epu32_mask(q0, _mm512_loadu_si512(limits + idx));
+			const __mmask16 le1 = _mm512_cmple_epu32_mask(q1, _mm512_loadu_si512(limits + idx + 16));
+			if (le0 | le1) return idx + (le0 ? __builtin_ctz(le0) : 16 + __builtin_ctz(le1));
+		}
+		for (; idx < to; idx += 16) {
+			const __mmask16 mask = (to - idx >= 16 ? 0xffff : (1u << (to - idx)) - 1);
+			const __m512i q = _mm512_mullo_epi32(_mm512_maskz_loadu_epi32(mask, inverses + idx), n_vec);
+			const __mmask16 le = _mm512_mask_cmple_epu32_mask(mask, q, _mm512_maskz_loadu_epi32(mask, limits + idx));
+			if (le) return idx + __builtin_ctz(le);
+		}
+		return to;
+	}
+#endif
+};
+
+// Structure of arrays of inverses and limits for primes of PrimesArray, see PrimeInverse.
+// 32-bit arrays are used while n < 2^32 (twice more lanes), 64-bit ones for bigger n.
+template <typename NUM_TYPE>
+class SimdInverseTable {
+public:
+	typedef NUM_TYPE num_type;
+	typedef SimdTrialDivision::isa_type isa_type;
+	static_assert(sizeof(num_type) <= 8, "Too big num_type for SimdInverseTable");
+
+private:
+	// [0] is for primes[0] == 2 and never matches
+	std::vector<uint32_t> inverses32, limits32;
+	std::vector<uint64_t> inverses64, limits64;
+	size_t count;
+	isa_type isa;
+
+	SimdInverseTable() = delete;
+	SimdInverseTable(const SimdInverseTable &b) = delete;
+	SimdInverseTable& operator=(const SimdInverseTable &b) = delete;
+
+public:
+	// primes[0] == 2, primes[1] == 3, ...; primes < 2^32
+	SimdInverseTable(const num_type primes[], size_t b_count, isa_type b_isa = SimdTrialDivision::best_isa()) :
+		inverses32(b_count, 0), limits32(b_count, 0), count(b_count), isa(b_isa) {
+		assert(SimdTrialDivision::is_supported(isa));
+		const bool is_wide = sizeof(num_type) > 4;
+		if (is_wide) {
+			inverses64.resize(count, 0);
+			limits64.resize(count, 0);
+		}
+		for (size_t i=1; i<count; ++i) {
+			assert((uint_fast64_t)primes[i] <= UINT32_MAX);
+			const PrimeInverse<uint32_t> inverse32((uint32_t)primes[i]);
+			inverses32[i] = inverse32.inverse;
+			limits32[i] = inverse32.limit;
+			if (is_wide) {
+				const PrimeInverse<uint64_t> inverse64((uint64_t)primes[i]);
+				inverses64[i] = inverse64.inverse;
+				limits64[i] = inverse64.limit;
+			}
+		}
+	}
+
+	size_t get_count() const {
+		return count;
+	}
+
+	isa_type get_isa() const {
+		return isa;
+	}
+
+	void set_isa(isa_type b_isa) {
+		assert(SimdTrialDivision::is_supported(b_isa));
+		isa = b_isa;
+	}
+
+	// first idx in [from, to) such that primes[idx] divides n, to if there is no such idx
+	size_t find_divisor(num_type n, size_t from, size_t to) const {
+		assert(to <= count);
+		if (from == 0) from = 1;
+		if (from >= to) return to;
+		if (((uint_fast64_t)n >> 32) == 0) {
+			return SimdTrialDivision::find_divisor(isa, (uint32_t)n, inverses32.data(), limits32.data(), from, to);
+		}
+		return SimdTrialDivision::find_divisor(isa, (uint64_t)n, inverses64.data(), limits64.data(), from, to);
+	}
+};
+
+// primes array with pointer to its SimdInverseTable
+template <typename NUM_TYPE>
+struct SimdPrimesArray : public PrimesArray<NUM_TYPE> {
+public:
+	typedef SimdInverseTable<NUM_TYPE> simd_table_type;
+
+	const simd_table_type *simd_table;
+
+	SimdPrimesArray() : PrimesArray<NUM_TYPE>(), simd_table(NULL) {}
+	SimdPrimesArray(const simd_table_type *b_simd_table, PrimesArray<NUM_TYPE> b_primes_array) :
+		PrimesArray<NUM_TYPE>(b_primes_array), simd_table(b_simd_table) {
+		assert(simd_table == NULL || simd_table->get_count() == this->count);
+	}
+	// use default copy constructor and assignment operator
+};
+
+// Trial division by primes array with SimdInverseTable: vector kernel looks for next prime divisor,
+// scalar code divides it out, then the kernel continues from the next prime.
+// Numbers above the last prime of the array are tried by Factorizer::tail_division,
+// without table primes are tried by Factorizer.
+// May be used as FACTORIZER_TYPE of CanonicFactorsTemplate and checkers.
+template <typename NUM_TYPE>
+class SimdFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef Factorizer<num_type> trial_factorizer_type;
+	typedef SimdPrimesArray<num_type> primes_array_type;
+	typedef typename primes_array_type::simd_table_type simd_table_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename trial_factorizer_type::factorize_cb_type factorize_cb_type;
+
+private:
+	trial_factorizer_type trial_factorizer;
+	factorize_cb_type cb;
+	const simd_table_type *simd_table;
+
+public:
+	SimdFactorizer(primes_array_type b_primes_array, factorize_cb_type b_cb) :
+		trial_factorizer(b_primes_array), cb(b_cb), simd_table(b_primes_array.simd_table) {}
+
+	// only factorize methods with callback argument may be used
+	SimdFactorizer(primes_array_type b_primes_array) :
+		trial_factorizer(b_primes_array), simd_table(b_primes_array.simd_table) {}
+
+	// use default copy constructor and assignment operator
+
+	primes_array_type get_primes_array() const {
+		return primes_array_type(simd_table, trial_factorizer.get_primes_array());
+	}
+
+	// the same as Factorizer::trial_division
+	template <typename CB>
+	bool trial_division(num_type &n, num_type bound, CB &&cb) const {
+		const typename trial_factorizer_type::primes_array_type primes_array = trial_factorizer.get_primes_array();
+		if (simd_table == NULL || primes_array.count <= 1) return trial_factorizer.trial_division(n, bound, cb);
+		assert(n > 0);
+		if (n == 1) return false;
+
+		if (!(n & 1)) {
+			exp_type exp = 0;
+			do {
+				n >>= 1;
+				++exp;
+			} while (!(n & 1));
+			if (cb(2, exp)) return true;
+		}
+
+		const num_type *primes = primes_array.primes;
+		const size_t count = primes_array.count;
+		size_t idx = 1;
+		for (;;) {
+			const num_type p_max = std::min((num_type)PrimesSieve<num_type>::isqrt(n), bound);
+			const size_t end = std::upper_bound(primes + idx, primes + count, p_max) - primes;
+			idx = simd_table->find_divisor(n, idx, end);
+			if (idx == end) {
+				if (end < count) return false;
+				break;
+			}
+			const num_type p = primes[idx];
+			exp_type exp = 0;
+			do {
+				n /= p;
+				++exp;
+			} while (!(n % p));
+			if (cb(p, exp)) return true;
+			++idx;
+		}
+
+		// primes array is over
+		return trial_factorizer_type::tail_division(n, primes[count-1], bound, cb);
+	}
+
+	// if cb returns true, factorize interrupts
+	// CB - callable as bool(num_type prime, exp_type exp)
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		if (trial_division(n, (num_type)~(num_type)0, cb)) return;
+		if (n != 1) cb(n, 1);
+	}
+
+	// std::function adapters
+
+	bool trial_division(num_type &n, num_type bound) const {
+		return trial_division(n, bound, cb);
+	}
+
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+};
+
+#endif/*SIMD_TRIAL_DIVISION_H*/
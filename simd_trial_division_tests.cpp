@@ -0,0 +1,184 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "simd_trial_division.h"
+#include "canonic_factors.h"
+
+typedef SimdTrialDivision::isa_type isa_type;
+
+const isa_type all_isa[] = {SimdTrialDivision::ISA_SCALAR, SimdTrialDivision::ISA_AVX2, SimdTrialDivision::ISA_AVX512};
+const size_t all_isa_count = sizeof(all_isa) / sizeof(all_isa[0]);
+
+struct MyFactors {
+	uint_fast8_t pow_count;
+	uint_fast64_t primes[16];
+	uint_fast8_t exps[16];
+};
+
+template <typename FACTORIZER_TYPE>
+void my_factorize(const FACTORIZER_TYPE &factorizer, uint_fast64_t n, MyFactors &factors) {
+	factors.pow_count = 0;
+	factorizer.factorize(n, [&factors] (uint_fast64_t prime, uint_fast8_t exp) -> bool {
+		assert(factors.pow_count < 16);
+		factors.primes[factors.pow_count] = prime;
+		factors.exps[factors.pow_count] = exp;
+		++factors.pow_count;
+		return false;
+	});
+}
+
+void test_find_divisor() {
+	typedef SimdInverseTable<uint_fast64_t> simd_table_type;
+	uint_fast64_t primes[1024];
+	size_t primes_count = Factorizer<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	simd_table_type simd_table(primes, primes_count);
+
+	for (size_t i=0; i<all_isa_count; ++i) {
+		if (!SimdTrialDivision::is_supported(all_isa[i])) {
+			fprintf(stderr, "%s is not supported\n", SimdTrialDivision::isa_name(all_isa[i]));
+			continue;
+		}
+		simd_table.set_isa(all_isa[i]);
+		// every lane position, every tail length, 32-bit and 64-bit lanes
+		for (size_t from=0; from<40; ++from) {
+			for (size_t to=from; to<from+40; ++to) {
+				for (size_t idx=1; idx<to+2; ++idx) {
+					// primes[idx] * prime above the table, n < 2^32 and n > 2^32
+					const uint_fast64_t ns[] = {primes[idx] * 65537ULL, primes[idx] * 4294967291ULL};
+					for (size_t k=0; k<2; ++k) {
+						const size_t expected = (idx >= (from > 0 ? from : 1) && idx < to ? idx : to);
+						assert(simd_table.find_divisor(ns[k], from, to) == expected);
+					}
+				}
+				// no divisors in the table
+				assert(simd_table.find_divisor(4294967291ULL, from, to) == to);
+				assert(simd_table.find_divisor(65537ULL * 4294967291ULL, from, to) == to);
+			}
+		}
+		// divisor at the end of the table
+		assert(simd_table.find_divisor(primes[primes_count-1] * 3, 2, primes_count) == primes_count - 1);
+		assert(simd_table.find_divisor(primes[primes_count-1] * 4294967291ULL, 2, primes_count) == primes_count - 1);
+	}
+}
+
+void test_factorize() {
+	typedef SimdFactorizer<uint_fast64_t> simd_fzr_type;
+	typedef Factorizer<uint_fast64_t> fzr_type;
+	uint_fast64_t primes[1024];
+	size_t primes_count = fzr_type::fill_primes(primes, 1024, UINT64_MAX);
+	MyFactors factors, my_factors;
+
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	unsigned int seed = (unsigned int)tv.tv_sec * 1000000 + tv.tv_usec;
+	fprintf(stderr, "seed = %u\n", seed);
+	srand(seed);
+
+	// table ends at 3, 5, 7, 11, 13 and 8161: wheel continues after it
+	const size_t counts[] = {0, 1, 2, 3, 4, 5, 6, 1024};
+	for (size_t c=0; c<sizeof(counts)/sizeof(counts[0]); ++c) {
+		simd_fzr_type::simd_table_type simd_table(primes, counts[c]);
+		fzr_type factorizer(fzr_type::primes_array_type(primes, counts[c]));
+		for (size_t i=0; i<all_isa_count; ++i) {
+			if (!SimdTrialDivision::is_supported(all_isa[i])) continue;
+			simd_table.set_isa(all_isa[i]);
+			simd_fzr_type simd_factorizer(simd_fzr_type::primes_array_type(&simd_table, fzr_type::primes_array_type(primes, counts[c])));
+			for (uint_fast64_t n=1; n<=1024*16+1; ++n) {
+				my_factorize(simd_factorizer, n, factors);
+				my_factorize(factorizer, n, my_factors);
+				assert(factors.pow_count == my_factors.pow_count);
+				for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+					assert(factors.primes[j] == my_factors.primes[j]);
+					assert(factors.exps[j] == my_factors.exps[j]);
+				}
+			}
+			// 64-bit numbers with small prime factors
+			for (uint_fast16_t k=0; k<256; ++k) {
+				uint_fast64_t n = 1;
+				while (n <= UINT64_MAX / 8161) n *= primes[1 + rand() % (primes_count - 1)];
+				my_factorize(simd_factorizer, n, factors);
+				my_factorize(factorizer, n, my_factors);
+				assert(factors.pow_count == my_factors.pow_count);
+				for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+					assert(factors.primes[j] == my_factors.primes[j]);
+					assert(factors.exps[j] == my_factors.exps[j]);
+				}
+			}
+		}
+	}
+
+	// cofactor above the table
+	simd_fzr_type::simd_table_type simd_table(primes, primes_count);
+	simd_fzr_type simd_factorizer(simd_fzr_type::primes_array_type(&simd_table, fzr_type::primes_array_type(primes, primes_count)));
+	my_factorize(simd_factorizer, 8161ULL * 8161ULL * 65521ULL * 65537ULL, factors);
+	assert(factors.pow_count == 3);
+	assert(factors.primes[0] == 8161 && factors.exps[0] == 2);
+	assert(factors.primes[1] == 65521 && factors.exps[1] == 1);
+	assert(factors.primes[2] == 65537 && factors.exps[2] == 1);
+
+	// 2^64 - 1 = 3 * 5 * 17 * 257 * 641 * 65537 * 6700417
+	my_factorize(simd_factorizer, UINT64_MAX, factors);
+	const uint_fast64_t my_primes[] = {3, 5, 17, 257, 641, 65537, 6700417};
+	assert(factors.pow_count == 7);
+	for (uint_fast8_t j=0; j<7; ++j) {
+		assert(factors.primes[j] == my_primes[j] && factors.exps[j] == 1);
+	}
+}
+
+void test_factorize32() {
+	typedef SimdFactorizer<uint32_t> simd_fzr_type;
+	typedef Factorizer<uint32_t> fzr_type;
+	uint32_t primes[1024];
+	size_t primes_count = fzr_type::fill_primes(primes, 1024, UINT32_MAX);
+	simd_fzr_type::simd_table_type simd_table(primes, primes_count);
+	simd_fzr_type simd_factorizer(simd_fzr_type::primes_array_type(&simd_table, fzr_type::primes_array_type(primes, primes_count)));
+	fzr_type factorizer(fzr_type::primes_array_type(primes, primes_count));
+	MyFactors factors, my_factors;
+	for (uint32_t n=UINT32_MAX; n>=UINT32_MAX-1024*4; --n) {
+		my_factorize(simd_factorizer, n, factors);
+		my_factorize(factorizer, n, my_factors);
+		assert(factors.pow_count == my_factors.pow_count);
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(factors.primes[j] == my_factors.primes[j]);
+			assert(factors.exps[j] == my_factors.exps[j]);
+		}
+	}
+}
+
+void test_with_canonic_factors() {
+	typedef uint_fast64_t num_type;
+	typedef SimdFactorizer<num_type> simd_fzr_type;
+	typedef CanonicFactorsTemplate<num_type, 15, simd_fzr_type> cft_type;
+	num_type primes[1024];
+	size_t primes_count = Factorizer<num_type>::fill_primes(primes, 1024, UINT64_MAX);
+	simd_fzr_type::simd_table_type simd_table(primes, primes_count);
+	simd_fzr_type::primes_array_type primes_array(&simd_table, PrimesArray<num_type>(primes, primes_count));
+	cft_type::CanonicFactorizer cfzr(primes_array);
+	cft_type::CanonicFactors a(cfzr);
+	for (num_type i=((num_type)1 << 40) - 1024; i<=((num_type)1 << 40) + 1024; ++i) {
+		a.assign(i);
+		assert(a.value() == i);
+	}
+
+	PrimeChecker<num_type, simd_fzr_type> prime_checker(primes_array);
+	DivisorsCounter<num_type, simd_fzr_type> divisors_counter(primes_array);
+	assert(prime_checker.is_prime(4294967291ULL));
+	assert(!prime_checker.is_prime(65521ULL * 65537ULL));
+	assert(divisors_counter.divisors_count(65521ULL * 65537ULL) == 4);
+	assert(divisors_counter.divisors_count(2*2*3*5*7*11*13) == 2*2*2*2*2*3);
+}
+
+void tests_suite() {
+	test_find_divisor();
+	test_factorize();
+	test_factorize32();
+	test_with_canonic_factors();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
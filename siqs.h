@@ -0,0 +1,764 @@
+#ifndef SIQS_H
+#define SIQS_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "uint128.h"
+#include "mul_mod.h"
+#include "square_root_mod.h"
+#include "primes_sieve.h"
+#include "ecm.h"
+#include "thread_pool.h"
+
+// Self-initializing quadratic sieve for odd composites up to 128 bits which are not prime powers.
+// n is multiplied by small k chosen by Knuth-Schroeppel function, factor base is -1, 2 and odd primes p
+// with (kn / p) != -1, roots of kn modulo p are found by SquareRootMod.
+// Polynomial (A*x + B)^2 - kn == A * g(x), g(x) = A*x^2 + 2*B*x + C, A is product of s primes of factor base,
+// 2^(s-1) values of B per A are switched in Gray code order, so roots of g modulo p change by one addition.
+// x in [-M, M) is sieved by blocks of BLOCK_SIZE bytes (L1 cache) with rounded log2(p) of primes above
+// SMALL_PRIME_BOUND, values above threshold are trial divided: full relations have all factors in factor base,
+// partial ones have one large prime more, partials of the same large prime are combined.
+// Linear algebra is structured Gaussian elimination over GF(2): relations with odd singleton primes are removed,
+// the rest is dense bit matrix. Every dependency gives X^2 == Y^2 (mod n), gcd(X - Y, n) is tried.
+// Polynomials of different A are run by WorkStealingPool if it is given: one A per task.
+class Siqs {
+public:
+	typedef uint128_t num_type;
+	typedef MulMod<num_type, ((num_type)1)<<127, num_type> mul_mod_type;
+	typedef RhoFactorizer<num_type, ((num_type)1)<<127, num_type> rho_factorizer_type;
+	// primes of factor base are < 2^32, their products fit 64 bits
+	typedef SquareRootMod<uint64_t, 64, uint64_t> square_root_mod_type;
+	static constexpr size_t BLOCK_SIZE = 32*1024;
+	// smaller primes are not sieved, they are found by trial division
+	static constexpr uint32_t SMALL_PRIME_BOUND = 32;
+	// threshold is lowered by so many bits for primes which are not sieved
+	static constexpr uint_fast8_t SMALL_PRIMES_BITS = 4;
+	// relations above size of factor base
+	static constexpr size_t EXTRA_RELATIONS = 64;
+	// multipliers k of Knuth-Schroeppel function, squarefree
+	static constexpr uint_fast8_t MULTIPLIERS_COUNT = 22;
+	// values of A between checks of relations count: its multiple not less than count of threads,
+	// so results are the same for every count of threads up to it
+	static constexpr size_t A_PER_ROUND = 8;
+
+	// parameters by bits of kn, linearly interpolated
+	struct Params {
+		uint_fast8_t bits;
+		uint32_t fb_size;
+		// large primes < largest prime of factor base * large_prime_mult
+		uint32_t large_prime_mult;
+		uint32_t blocks_count;
+	};
+
+	// (A*x + B)^2 == product of factors * large_prime (mod kn)
+	struct Relation {
+		int128_t ax_b;
+		// 1 if relation is full
+		uint32_t large_prime;
+		// indices of factor base with repetitions, index 0 is -1
+		std::vector<uint32_t> factors;
+	};
+
+private:
+	// state of worker: sieve of one polynomial
+	struct Worker {
+		std::vector<uint8_t> sieve;
+		std::vector<uint32_t> ainv;
+		// roots of g modulo p as sieve indices of x = -M
+		std::vector<uint32_t> soln1;
+		std::vector<uint32_t> soln2;
+		// next sieve index by prime
+		std::vector<uint32_t> next1;
+		std::vector<uint32_t> next2;
+		// [l * fb_size + i] - 2 * B_l / A modulo p_i
+		std::vector<uint32_t> bainv2;
+	};
+
+	WorkStealingPool *pool;
+	num_type n;
+	num_type kn;
+	uint32_t multiplier;
+	Params params;
+	// [0] is -1, [1] is 2
+	std::vector<uint32_t> fb_primes;
+	// square root of kn modulo p
+	std::vector<uint32_t> fb_roots;
+	std::vector<uint8_t> fb_logs;
+	uint32_t large_prime_bound;
+	// sieve covers x in [-sieve_m, sieve_m)
+	uint32_t sieve_m;
+	uint8_t threshold;
+	// primes of A: count and range of factor base indices for random choice
+	uint_fast8_t a_count;
+	uint32_t a_begin;
+	uint32_t a_end;
+	double a_target;
+	std::vector<Worker> workers;
+	std::vector<Relation> fulls;
+	std::vector<Relation> partials;
+	// large prime to index in partials of the first relation with it
+	std::unordered_map<uint32_t, size_t> partial_firsts;
+	// count of partials combined with other ones
+	size_t cycles_count;
+
+	Siqs(const Siqs &b) = delete;
+	Siqs& operator=(const Siqs &b) = delete;
+
+public:
+	// pool - NULL for sieving in calling thread
+	Siqs(WorkStealingPool *b_pool = NULL) : pool(b_pool), n(0), kn(0), multiplier(1), cycles_count(0) {}
+
+	static Params get_params(uint_fast8_t bits) {
+		static const Params table[] = {
+			{40, 40, 30, 1},
+			{64, 100, 40, 1},
+			{80, 150, 40, 1},
+			{96, 250, 40, 2},
+			{112, 350, 40, 2},
+			{128, 500, 50, 2},
+			{136, 600, 60, 2}
+		};
+		const size_t count = sizeof(table) / sizeof(table[0]);
+		if (bits <= table[0].bits) return table[0];
+		for (size_t i=1; i<count; ++i) {
+			if (bits <= table[i].bits) {
+				const Params &a = table[i-1], &b = table[i];
+				Params params = b;
+				params.fb_size = a.fb_size + (b.fb_size - a.fb_size) * (bits - a.bits) / (b.bits - a.bits);
+				return params;
+			}
+		}
+		return table[count-1];
+	}
+
+	// a^-1 modulo p, gcd(a, p) == 1
+	static uint64_t inv_mod(uint64_t a, uint64_t p) {
+		int64_t t = 0, new_t = 1;
+		int64_t r = (int64_t)p, new_r = (int64_t)(a % p);
+		while (new_r != 0) {
+			const int64_t q = r / new_r;
+			std::swap(t, new_t);
+			new_t -= q * t;
+			std::swap(r, new_r);
+			new_r -= q * r;
+		}
+		assert(r == 1);
+		return (uint64_t)(t < 0 ? t + (int64_t)p : t);
+	}
+
+	// a modulo p for signed a
+	static uint32_t mod_signed(int128_t a, uint32_t p) {
+		const uint32_t r = (uint32_t)((a < 0 ? -(uint128_t)a : (uint128_t)a) % p);
+		return (a < 0 && r != 0 ? p - r : r);
+	}
+
+	// b if n == b^k for some k >= 2, otherwise 0
+	static num_type perfect_power_root(num_type n) {
+		typedef UnsignedOps<num_type> ops_type;
+		const uint_fast8_t bits = ops_type::BITS - ops_type::clz(n);
+		const num_type r = ops_type::isqrt(n);
+		if (r * r == n) return r;
+		for (uint_fast8_t k=3; k<bits; k+=2) {
+			const num_type b = (num_type)llround(pow((double)n, 1.0 / k));
+			for (num_type c=(b > 1 ? b - 1 : 1); c<=b+1; ++c) {
+				if (c < 2) continue;
+				num_type pow = 1;
+				uint_fast8_t i = 0;
+				while (i < k && pow <= n / c) {
+					pow *= c;
+					++i;
+				}
+				if (i == k && pow == n) return c;
+			}
+		}
+		return 0;
+	}
+
+	// Knuth-Schroeppel function: expected contribution of small primes to log of sieve values for kn
+	// n - odd
+	static uint32_t choose_multiplier(num_type n) {
+		static const uint8_t multipliers[MULTIPLIERS_COUNT] = {
+			1, 3, 5, 7, 11, 13, 15, 17, 19, 21, 23, 29, 31, 33, 35, 37, 39, 41, 43, 47, 51, 53
+		};
+		static const uint16_t primes[] = {
+			3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97,
+			101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199
+		};
+		uint32_t best = 1;
+		double best_score = -1e9;
+		for (uint_fast8_t i=0; i<MULTIPLIERS_COUNT; ++i) {
+			const uint32_t k = multipliers[i];
+			if (n > ~(num_type)0 / k) break;
+			const num_type kn = n * k;
+			double score = -0.5 * log((double)k);
+			switch ((uint_fast8_t)(kn & 7)) {
+				case 1: score += 2 * log(2.0); break;
+				case 5: score += log(2.0); break;
+				default: score += 0.5 * log(2.0);
+			}
+			for (size_t j=0; j<sizeof(primes)/sizeof(primes[0]); ++j) {
+				const uint32_t p = primes[j];
+				if (k % p == 0) {
+					score += log((double)p) / p;
+				} else if (square_root_mod_type::legendre_symbol(p, (uint64_t)(kn % p)) == 1) {
+					score += 2 * log((double)p) / (p - 1);
+				}
+			}
+			if (score > best_score) {
+				best_score = score;
+				best = k;
+			}
+		}
+		return best;
+	}
+
+	uint32_t get_multiplier() const {
+		return multiplier;
+	}
+
+	const std::vector<uint32_t>& get_factor_base() const {
+		return fb_primes;
+	}
+
+	// n - odd composite which is not a prime power, n > 2^32
+	// returns nontrivial divisor of n
+	num_type find_divisor(num_type b_n) {
+		n = b_n;
+		assert((n & 1) && (n >> 32) != 0);
+		assert(perfect_power_root(n) == 0);
+		const uint32_t divisor = init();
+		if (divisor != 0) return divisor;
+
+		const size_t threads_count = (pool != NULL ? pool->get_threads_count() : 1);
+		workers.resize(threads_count);
+		std::mt19937_64 rng(1);
+		std::set< std::vector<uint32_t> > used_as;
+		for (;;) {
+			// the same values of A independently of count of threads
+			std::vector< std::vector<uint32_t> > as((threads_count + A_PER_ROUND - 1) / A_PER_ROUND * A_PER_ROUND);
+			for (size_t i=0; i<as.size(); ++i) {
+				do {
+					as[i] = choose_a(rng);
+				} while (!used_as.insert(as[i]).second);
+			}
+			std::vector< std::vector<Relation> > results(as.size());
+			if (threads_count == 1) {
+				for (size_t i=0; i<as.size(); ++i) sieve_a(workers[0], as[i], results[i]);
+			} else {
+				pool->run(as.size(), [this, &as, &results] (size_t worker_idx, size_t task_idx) {
+					sieve_a(workers[worker_idx], as[task_idx], results[task_idx]);
+				});
+			}
+			for (size_t i=0; i<results.size(); ++i) {
+				for (size_t j=0; j<results[i].size(); ++j) add_relation(results[i][j]);
+			}
+			if (fulls.size() + cycles_count < fb_primes.size() + EXTRA_RELATIONS) continue;
+			const num_type d = solve();
+			if (d != 0) return d;
+		}
+	}
+
+private:
+	// returns prime of factor base which divides n or 0
+	uint32_t init() {
+		multiplier = choose_multiplier(n);
+		kn = n * multiplier;
+		const uint_fast8_t bits = UnsignedOps<num_type>::BITS - UnsignedOps<num_type>::clz(kn);
+		params = get_params(bits);
+
+		uint64_t small_primes[32];
+		const size_t small_count = PrimesSieve<uint64_t>::fill_primes(small_primes, 32, UINT64_MAX);
+		fb_primes.assign(1, 0);
+		fb_roots.assign(1, 0);
+		fb_primes.push_back(2);
+		fb_roots.push_back((uint32_t)(kn & 1));
+		PrimesIterator<uint64_t> it(3);
+		while (fb_primes.size() < params.fb_size) {
+			const uint32_t p = (uint32_t)it.next();
+			if (n % p == 0) return p;
+			const uint64_t a = (uint64_t)(kn % p);
+			if (a == 0) {
+				// p divides k
+				fb_primes.push_back(p);
+				fb_roots.push_back(0);
+			} else if (square_root_mod_type::legendre_symbol(p, a) == 1) {
+				square_root_mod_type square_root_mod(p, small_primes, small_count);
+				fb_primes.push_back(p);
+				fb_roots.push_back((uint32_t)square_root_mod.tonelli_shanks_algo(a));
+			}
+		}
+		fb_logs.resize(fb_primes.size());
+		for (size_t i=1; i<fb_primes.size(); ++i) fb_logs[i] = (uint8_t)lround(log2((double)fb_primes[i]));
+		const uint32_t p_max = fb_primes.back();
+		large_prime_bound = p_max * params.large_prime_mult;
+
+		sieve_m = params.blocks_count * BLOCK_SIZE / 2;
+		// |g(x)| <= M * sqrt(kn / 2)
+		const double max_log = log2((double)sieve_m) + 0.5 * log2((double)kn / 2);
+		threshold = (uint8_t)std::max(8.0, max_log - log2((double)large_prime_bound) - SMALL_PRIMES_BITS);
+
+		// A ~ sqrt(2 * kn) / M of a_count primes about 2^11 or smaller
+		a_target = sqrt(2 * (double)kn) / sieve_m;
+		const double q_max = std::min(2048.0, (double)fb_primes[fb_primes.size() * 3 / 4]);
+		a_count = (uint_fast8_t)std::max(2.0, ceil(log(a_target) / log(q_max)));
+		const double q_avg = pow(a_target, 1.0 / a_count);
+		a_begin = a_end = 2;
+		while (a_begin < fb_primes.size() && (fb_primes[a_begin] < q_avg / 2 || fb_primes[a_begin] <= SMALL_PRIME_BOUND)) ++a_begin;
+		a_end = a_begin;
+		while (a_end < fb_primes.size() && fb_primes[a_end] < q_avg * 2) ++a_end;
+		// enough primes for many values of A
+		while (a_end - a_begin < 2u * a_count + 24 && a_end < fb_primes.size()) ++a_end;
+		while (a_end - a_begin < 2u * a_count + 24 && fb_primes[a_begin - 1] > SMALL_PRIME_BOUND) --a_begin;
+		assert(a_end - a_begin > a_count);
+		return 0;
+	}
+
+	bool is_a_prime(uint32_t idx) const {
+		return fb_roots[idx] != 0 && fb_primes[idx] > SMALL_PRIME_BOUND;
+	}
+
+	// a_count - 1 random primes of range, the last one gives the closest product to a_target
+	std::vector<uint32_t> choose_a(std::mt19937_64 &rng) const {
+		std::vector<uint32_t> a_indices;
+		double a = 1;
+		while (a_indices.size() + 1 < a_count) {
+			const uint32_t idx = a_begin + (uint32_t)(rng() % (a_end - a_begin));
+			if (!is_a_prime(idx) || std::find(a_indices.begin(), a_indices.end(), idx) != a_indices.end()) continue;
+			a_indices.push_back(idx);
+			a *= fb_primes[idx];
+		}
+		uint32_t best = 0;
+		double best_diff = 0;
+		for (uint32_t idx=2; idx<fb_primes.size(); ++idx) {
+			if (!is_a_prime(idx) || std::find(a_indices.begin(), a_indices.end(), idx) != a_indices.end()) continue;
+			const double diff = fabs(log(a * fb_primes[idx] / a_target));
+			if (best == 0 || diff < best_diff) {
+				best = idx;
+				best_diff = diff;
+			}
+		}
+		a_indices.push_back(best);
+		std::sort(a_indices.begin(), a_indices.end());
+		return a_indices;
+	}
+
+	// all 2^(a_count-1) polynomials of A
+	void sieve_a(Worker &worker, const std::vector<uint32_t> &a_indices, std::vector<Relation> &relations) const {
+		const size_t fb_size = fb_primes.size();
+		const uint_fast8_t s = (uint_fast8_t)a_indices.size();
+		num_type a = 1;
+		for (uint_fast8_t l=0; l<s; ++l) a *= fb_primes[a_indices[l]];
+
+		// B_l == A / q_l * (sqrt(kn) / (A / q_l) mod q_l), B == sum of B_l, B^2 == kn (mod A)
+		num_type b_ls[32];
+		int128_t b = 0;
+		for (uint_fast8_t l=0; l<s; ++l) {
+			const uint32_t q = fb_primes[a_indices[l]];
+			const num_type a_q = a / q;
+			uint64_t gamma = (uint64_t)fb_roots[a_indices[l]] * inv_mod((uint64_t)(a_q % q), q) % q;
+			if (gamma > q / 2) gamma = q - gamma;
+			b_ls[l] = a_q * gamma;
+			b += (int128_t)b_ls[l];
+		}
+
+		worker.sieve.resize(2 * sieve_m);
+		worker.ainv.assign(fb_size, 0);
+		worker.soln1.assign(fb_size, 0);
+		worker.soln2.assign(fb_size, 0);
+		worker.next1.resize(fb_size);
+		worker.next2.resize(fb_size);
+		worker.bainv2.assign(s * fb_size, 0);
+		for (uint32_t i=2; i<fb_size; ++i) {
+			const uint32_t p = fb_primes[i];
+			if (p <= SMALL_PRIME_BOUND || std::binary_search(a_indices.begin(), a_indices.end(), i)) continue;
+			const uint64_t ainv = inv_mod((uint64_t)(a % p), p);
+			worker.ainv[i] = (uint32_t)ainv;
+			for (uint_fast8_t l=0; l<s; ++l) worker.bainv2[l * fb_size + i] = (uint32_t)(2 * (uint64_t)(b_ls[l] % p) * ainv % p);
+			// x == (+-root - B) / A, sieve index == x + M
+			const uint64_t b_mod = mod_signed(b, p), m_mod = sieve_m % p;
+			worker.soln1[i] = (uint32_t)(((fb_roots[i] + p - b_mod) * ainv + m_mod) % p);
+			worker.soln2[i] = (uint32_t)(((2 * (uint64_t)p - fb_roots[i] - b_mod) * ainv + m_mod) % p);
+		}
+
+		const uint32_t polys_count = (uint32_t)1 << (s - 1);
+		for (uint32_t j=0; j<polys_count; ++j) {
+			if (j > 0) {
+				// Gray code: bit v of j ^ (j >> 1) changed, sign of B_(v+1) is that bit
+				const uint_fast8_t v = (uint_fast8_t)__builtin_ctz(j);
+				const bool is_minus = ((j ^ (j >> 1)) >> v) & 1;
+				const uint32_t *bainv2 = worker.bainv2.data() + (v + 1) * fb_size;
+				if (is_minus) {
+					b -= 2 * (int128_t)b_ls[v + 1];
+				} else {
+					b += 2 * (int128_t)b_ls[v + 1];
+				}
+				for (uint32_t i=2; i<fb_size; ++i) {
+					if (worker.ainv[i] == 0) continue;
+					const uint32_t p = fb_primes[i], d = (is_minus ? bainv2[i] : p - bainv2[i]);
+					worker.soln1[i] = (worker.soln1[i] + d) % p;
+					worker.soln2[i] = (worker.soln2[i] + d) % p;
+				}
+			}
+			const uint128_t b_abs = (b < 0 ? -(uint128_t)b : (uint128_t)b);
+			assert((kn - b_abs * b_abs) % a == 0);
+			const int128_t c = -(int128_t)((kn - b_abs * b_abs) / a);
+			sieve_poly(worker, a, b, c, a_indices, relations);
+		}
+	}
+
+	void sieve_poly(Worker &worker, num_type a, int128_t b, int128_t c, const std::vector<uint32_t> &a_indices, std::vector<Relation> &relations) const {
+		const size_t fb_size = fb_primes.size();
+		for (uint32_t i=2; i<fb_size; ++i) {
+			worker.next1[i] = worker.soln1[i];
+			worker.next2[i] = worker.soln2[i];
+		}
+		uint8_t *sieve = worker.sieve.data();
+		const uint32_t sieve_size = 2 * sieve_m;
+		// values above threshold have top bit set
+		memset(sieve, 0x80 - threshold, sieve_size);
+		for (uint32_t block_begin=0; block_begin<sieve_size; block_begin+=BLOCK_SIZE) {
+			const uint32_t block_end = std::min(block_begin + (uint32_t)BLOCK_SIZE, sieve_size);
+			for (uint32_t i=2; i<fb_size; ++i) {
+				if (worker.ainv[i] == 0) continue;
+				const uint32_t p = fb_primes[i];
+				const uint8_t logp = fb_logs[i];
+				uint32_t pos = worker.next1[i];
+				for (; pos<block_end; pos+=p) sieve[pos] += logp;
+				worker.next1[i] = pos;
+				if (worker.soln2[i] == worker.soln1[i]) continue;
+				pos = worker.next2[i];
+				for (; pos<block_end; pos+=p) sieve[pos] += logp;
+				worker.next2[i] = pos;
+			}
+		}
+
+		for (uint32_t w=0; w<sieve_size/8; ++w) {
+			uint64_t word;
+			memcpy(&word, sieve + w * 8, sizeof(word));
+			if ((word & 0x8080808080808080ULL) == 0) continue;
+			for (uint32_t idx=w*8; idx<w*8+8; ++idx) {
+				if (sieve[idx] & 0x80) trial_divide(worker, a, b, c, a_indices, idx, relations);
+			}
+		}
+	}
+
+	void trial_divide(const Worker &worker, num_type a, int128_t b, int128_t c, const std::vector<uint32_t> &a_indices, uint32_t idx, std::vector<Relation> &relations) const {
+		const int128_t x = (int128_t)idx - sieve_m;
+		const int128_t g = ((int128_t)a * x + 2 * b) * x + c;
+		if (g == 0) return;
+		Relation relation;
+		relation.ax_b = (int128_t)a * x + b;
+		if (g < 0) relation.factors.push_back(0);
+		num_type v = (g < 0 ? -(uint128_t)g : (uint128_t)g);
+		relation.factors.insert(relation.factors.end(), a_indices.begin(), a_indices.end());
+		while (!(v & 1)) {
+			v >>= 1;
+			relation.factors.push_back(1);
+		}
+		for (uint32_t i=2; i<fb_primes.size(); ++i) {
+			const uint32_t p = fb_primes[i];
+			if (worker.ainv[i] != 0) {
+				const uint32_t r = idx % p;
+				if (r != worker.soln1[i] && r != worker.soln2[i]) continue;
+			}
+			while (v % p == 0) {
+				v /= p;
+				relation.factors.push_back(i);
+			}
+		}
+		if (v >= large_prime_bound) return;
+		relation.large_prime = (uint32_t)v;
+		relations.push_back(std::move(relation));
+	}
+
+	void add_relation(Relation &relation) {
+		if (relation.large_prime == 1) {
+			fulls.push_back(std::move(relation));
+			return;
+		}
+		if (partial_firsts.count(relation.large_prime) != 0) ++cycles_count;
+		else partial_firsts[relation.large_prime] = partials.size();
+		partials.push_back(std::move(relation));
+	}
+
+	// full relations and pairs of partials with the same large prime, relation is 1 or 2 indices:
+	// index < fulls.size() is full relation, the others are partials
+	void get_columns(std::vector< std::vector<size_t> > &columns) const {
+		for (size_t i=0; i<fulls.size(); ++i) columns.push_back(std::vector<size_t>(1, i));
+		for (size_t i=0; i<partials.size(); ++i) {
+			const size_t first = partial_firsts.find(partials[i].large_prime)->second;
+			if (first != i) columns.push_back(std::vector<size_t>{fulls.size() + first, fulls.size() + i});
+		}
+	}
+
+	const Relation& get_relation(size_t idx) const {
+		return (idx < fulls.size() ? fulls[idx] : partials[idx - fulls.size()]);
+	}
+
+	// structured Gaussian elimination, returns divisor or 0 if dependencies are trivial
+	num_type solve() const {
+		std::vector< std::vector<size_t> > columns;
+		get_columns(columns);
+		const size_t fb_size = fb_primes.size();
+		// odd exponents of factor base primes by column
+		std::vector< std::vector<uint32_t> > odds(columns.size());
+		for (size_t j=0; j<columns.size(); ++j) {
+			std::vector<uint32_t> factors;
+			for (size_t r=0; r<columns[j].size(); ++r) {
+				const std::vector<uint32_t> &f = get_relation(columns[j][r]).factors;
+				factors.insert(factors.end(), f.begin(), f.end());
+			}
+			std::sort(factors.begin(), factors.end());
+			for (size_t k=0; k<factors.size();) {
+				size_t e = k;
+				while (e < factors.size() && factors[e] == factors[k]) ++e;
+				if ((e - k) & 1) odds[j].push_back(factors[k]);
+				k = e;
+			}
+		}
+
+		// columns with prime of weight 1 are not in any dependency
+		std::vector<bool> is_active(columns.size(), true);
+		std::vector<uint32_t> weights(fb_size);
+		for (bool is_changed=true; is_changed;) {
+			is_changed = false;
+			std::fill(weights.begin(), weights.end(), 0);
+			for (size_t j=0; j<columns.size(); ++j) {
+				if (!is_active[j]) continue;
+				for (size_t k=0; k<odds[j].size(); ++k) ++weights[odds[j][k]];
+			}
+			for (size_t j=0; j<columns.size(); ++j) {
+				if (!is_active[j]) continue;
+				for (size_t k=0; k<odds[j].size(); ++k) {
+					if (weights[odds[j][k]] == 1) {
+						is_active[j] = false;
+						is_changed = true;
+						break;
+					}
+				}
+			}
+		}
+		std::vector<uint32_t> row_idx(fb_size, UINT32_MAX);
+		uint32_t rows_count = 0;
+		for (size_t i=0; i<fb_size; ++i) {
+			if (weights[i] > 0) row_idx[i] = rows_count++;
+		}
+		std::vector<size_t> active;
+		for (size_t j=0; j<columns.size() && active.size()<rows_count+EXTRA_RELATIONS; ++j) {
+			if (is_active[j]) active.push_back(j);
+		}
+		if (active.size() <= rows_count) return 0;
+
+		// dense matrix: rows_count bits of odd exponents, then identity of active.size() bits
+		const size_t cols_count = active.size();
+		const size_t words_count = (rows_count + cols_count + 63) / 64;
+		std::vector<uint64_t> matrix(cols_count * words_count, 0);
+		for (size_t j=0; j<cols_count; ++j) {
+			uint64_t *row = matrix.data() + j * words_count;
+			for (size_t k=0; k<odds[active[j]].size(); ++k) {
+				const uint32_t bit = row_idx[odds[active[j]][k]];
+				row[bit / 64] |= (uint64_t)1 << (bit % 64);
+			}
+			const size_t bit = rows_count + j;
+			row[bit / 64] |= (uint64_t)1 << (bit % 64);
+		}
+		size_t pivots_count = 0;
+		for (uint32_t bit=0; bit<rows_count; ++bit) {
+			const size_t word = bit / 64;
+			const uint64_t mask = (uint64_t)1 << (bit % 64);
+			size_t pivot = pivots_count;
+			while (pivot < cols_count && !(matrix[pivot * words_count + word] & mask)) ++pivot;
+			if (pivot == cols_count) continue;
+			uint64_t *pivot_row = matrix.data() + pivot * words_count;
+			std::swap_ranges(pivot_row, pivot_row + words_count, matrix.data() + pivots_count * words_count);
+			pivot_row = matrix.data() + pivots_count * words_count;
+			for (size_t j=pivots_count+1; j<cols_count; ++j) {
+				uint64_t *row = matrix.data() + j * words_count;
+				if (!(row[word] & mask)) continue;
+				for (size_t k=word; k<words_count; ++k) row[k] ^= pivot_row[k];
+			}
+			++pivots_count;
+		}
+
+		// rows without pivot are zero: dependencies
+		for (size_t j=pivots_count; j<cols_count; ++j) {
+			const uint64_t *row = matrix.data() + j * words_count;
+			std::vector<size_t> relations;
+			for (size_t k=0; k<cols_count; ++k) {
+				const size_t bit = rows_count + k;
+				if ((row[bit / 64] >> (bit % 64)) & 1) {
+					relations.insert(relations.end(), columns[active[k]].begin(), columns[active[k]].end());
+				}
+			}
+			const num_type d = try_dependency(relations);
+			if (d != 0) return d;
+		}
+		return 0;
+	}
+
+	static num_type mod_n(int128_t a, num_type n) {
+		const num_type r = (a < 0 ? -(uint128_t)a : (uint128_t)a) % n;
+		return (a < 0 && r != 0 ? n - r : r);
+	}
+
+	// X = product of A*x + B, Y = sqrt of product of factors
+	num_type try_dependency(const std::vector<size_t> &relations) const {
+		std::vector<uint32_t> exps(fb_primes.size(), 0);
+		num_type x = 1, y = 1;
+		for (size_t i=0; i<relations.size(); ++i) {
+			const Relation &relation = get_relation(relations[i]);
+			x = mul_mod_type::mul_mod(n, x, mod_n(relation.ax_b, n));
+			for (size_t k=0; k<relation.factors.size(); ++k) ++exps[relation.factors[k]];
+			// every large prime is in pair of partials
+			if (relation.large_prime != 1 && relations[i] == partial_firsts.find(relation.large_prime)->second + fulls.size()) {
+				continue;
+			}
+			if (relation.large_prime != 1) y = mul_mod_type::mul_mod(n, y, relation.large_prime);
+		}
+		for (size_t i=1; i<fb_primes.size(); ++i) {
+			assert(!(exps[i] & 1));
+			if (exps[i] > 0) y = mul_mod_type::mul_mod(n, y, mul_mod_type::pow_mod(n, fb_primes[i], exps[i] / 2));
+		}
+		const num_type d = rho_factorizer_type::gcd((x >= y ? x - y : x + (n - y)), n);
+		return (d != 1 && d != n ? d : 0);
+	}
+};
+
+// Factorization with SIQS as the final stage: trial division by primes <= trial_bound,
+// then every composite cofactor is split by Pollard's rho (at most rho_bits bits),
+// by Pollard's p - 1 and Williams' p + 1, by a few curves of ECM (small factors of big cofactors) or by Siqs.
+// Prime factors are passed to cb in ascending order like Factorizer does.
+// OPERATION_TYPE must hold product of two num_type values or num_type is uint128_t (see MulMod)
+template <typename NUM_TYPE, NUM_TYPE NUM_TYPE_MAX_MASK, typename OPERATION_TYPE>
+class SiqsFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	static_assert(sizeof(num_type) <= sizeof(Siqs::num_type), "Too big num_type for Siqs");
+	typedef EcmFactorizer<num_type, NUM_TYPE_MAX_MASK, OPERATION_TYPE> ecm_factorizer_type;
+	typedef typename ecm_factorizer_type::rho_factorizer_type rho_factorizer_type;
+	typedef typename ecm_factorizer_type::trial_factorizer_type trial_factorizer_type;
+	typedef typename trial_factorizer_type::primes_array_type primes_array_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename trial_factorizer_type::factorize_cb_type factorize_cb_type;
+	static constexpr num_type DEFAULT_TRIAL_BOUND = 1024;
+	static constexpr uint_fast8_t DEFAULT_RHO_BITS = 64;
+	// rho_bits >= MIN_RHO_BITS, Siqs needs n > 2^32
+	static constexpr uint_fast8_t MIN_RHO_BITS = 40;
+	// curves of ECM before Siqs, they cost about as much as Siqs of 128-bit number
+	static constexpr uint64_t DEFAULT_ECM_CURVES = 4;
+	static constexpr uint64_t ECM_B1 = 3000;
+	static constexpr uint64_t ECM_B2 = 100 * ECM_B1;
+
+private:
+	// every cofactor prime > 2, so there are fewer of them than bits in num_type
+	static constexpr uint_fast16_t MAX_FACTORS_COUNT = sizeof(num_type) * 8;
+
+	trial_factorizer_type trial_factorizer;
+	ecm_factorizer_type ecm_factorizer;
+	factorize_cb_type cb;
+	WorkStealingPool *pool;
+	uint64_t ecm_curves;
+	num_type trial_bound;
+	uint_fast8_t rho_bits;
+
+public:
+	// pool - NULL for running curves and sieve in calling thread, it must not run factorize itself
+	SiqsFactorizer(primes_array_type b_primes_array, factorize_cb_type b_cb, WorkStealingPool *b_pool = NULL,
+		uint64_t b_ecm_curves = DEFAULT_ECM_CURVES, num_type b_trial_bound = DEFAULT_TRIAL_BOUND, uint_fast8_t b_rho_bits = DEFAULT_RHO_BITS) :
+		trial_factorizer(b_primes_array), ecm_factorizer(b_primes_array, b_pool, ECM_B1, ECM_B2), cb(b_cb), pool(b_pool),
+		ecm_curves(b_ecm_curves), trial_bound(b_trial_bound), rho_bits(b_rho_bits) {
+		assert(trial_bound >= 2 && rho_bits >= MIN_RHO_BITS);
+	}
+
+	// only factorize method with callback argument may be used
+	SiqsFactorizer(primes_array_type b_primes_array, WorkStealingPool *b_pool = NULL,
+		uint64_t b_ecm_curves = DEFAULT_ECM_CURVES, num_type b_trial_bound = DEFAULT_TRIAL_BOUND, uint_fast8_t b_rho_bits = DEFAULT_RHO_BITS) :
+		trial_factorizer(b_primes_array), ecm_factorizer(b_primes_array, b_pool, ECM_B1, ECM_B2), pool(b_pool),
+		ecm_curves(b_ecm_curves), trial_bound(b_trial_bound), rho_bits(b_rho_bits) {
+		assert(trial_bound >= 2 && rho_bits >= MIN_RHO_BITS);
+	}
+
+	// use default copy constructor and assignment operator
+
+	primes_array_type get_primes_array() const {
+		return trial_factorizer.get_primes_array();
+	}
+
+	static bool is_prime(num_type n) {
+		return ecm_factorizer_type::is_prime(n);
+	}
+
+	// n - odd composite without prime factors <= trial_bound
+	num_type find_divisor(num_type n) const {
+		typedef UnsignedOps<num_type> ops_type;
+		if (ops_type::BITS - ops_type::clz(n) <= rho_bits) return rho_factorizer_type::find_divisor(n);
+		const num_type root = (num_type)Siqs::perfect_power_root(n);
+		if (root != 0) return root;
+		const num_type d = ecm_factorizer.get_pm1().find_divisor(n);
+		if (d != n) return d;
+		if (ecm_curves > 0) {
+			const num_type d = ecm_factorizer.find_divisor(n, ecm_curves);
+			if (d != n) return d;
+		}
+		Siqs siqs(pool);
+		return (num_type)siqs.find_divisor(n);
+	}
+
+	// if cb returns true, factorize interrupts
+	// CB - callable as bool(num_type prime, exp_type exp)
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		assert(n > 0);
+		if (trial_factorizer.trial_division(n, trial_bound, cb)) return;
+		if (n == 1) return;
+		// all prime factors of n are > trial_bound
+		if (n / trial_bound < trial_bound || is_prime(n)) {
+			cb(n, 1);
+			return;
+		}
+
+		num_type factors[MAX_FACTORS_COUNT];
+		uint_fast16_t factors_count = 0;
+		num_type composites[MAX_FACTORS_COUNT];
+		uint_fast16_t composites_count = 0;
+		composites[composites_count++] = n;
+		while (composites_count > 0) {
+			num_type m = composites[--composites_count];
+			if (is_prime(m)) {
+				assert(factors_count < MAX_FACTORS_COUNT);
+				factors[factors_count++] = m;
+				continue;
+			}
+			num_type d = find_divisor(m);
+			assert(composites_count + 2 <= MAX_FACTORS_COUNT);
+			composites[composites_count++] = d;
+			composites[composites_count++] = m / d;
+		}
+
+		std::sort(factors, factors + factors_count);
+		for (uint_fast16_t i=0; i<factors_count;) {
+			num_type p = factors[i];
+			exp_type exp = 0;
+			do {
+				++exp;
+				++i;
+			} while (i < factors_count && factors[i] == p);
+			if (cb(p, exp)) return;
+		}
+	}
+
+	// std::function adapter
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+};
+
+#endif/*SIQS_H*/
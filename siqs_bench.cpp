@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "siqs.h"
+#include "ecm.h"
+
+typedef EcmFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> ecm_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!ecm_type::is_prime(n)) ++n;
+	return n;
+}
+
+uint128_t random_bits(std::mt19937_64 &rng, uint_fast8_t bits) {
+	const uint128_t r = ((uint128_t)rng() << 64) | rng();
+	return (r >> (128 - bits)) | ((uint128_t)1 << (bits - 1));
+}
+
+// seconds per number
+double bench_ecm(const ecm_type &ecm, const std::vector<uint128_t> &numbers) {
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		const uint128_t d = ecm.find_divisor(numbers[i]);
+		assert(d != 1 && d != numbers[i] && numbers[i] % d == 0);
+	}
+	return (get_time() - t0) / numbers.size();
+}
+
+double bench_siqs(WorkStealingPool *pool, const std::vector<uint128_t> &numbers) {
+	double t0 = get_time();
+	for (size_t i=0; i<numbers.size(); ++i) {
+		Siqs siqs(pool);
+		const uint128_t d = siqs.find_divisor(numbers[i]);
+		assert(d != 1 && d != numbers[i] && numbers[i] % d == 0);
+	}
+	return (get_time() - t0) / numbers.size();
+}
+
+int main() {
+	ecm_type::primes_array_type primes;
+	ecm_type ecm(primes);
+	WorkStealingPool pool;
+	std::mt19937_64 rng(1);
+	printf("n == p * q of equal sizes, seconds per number\n");
+	printf("%-8s %10s %10s %10s(%zu threads)\n", "n bits", "ECM", "SIQS", "SIQS", pool.get_threads_count());
+	for (uint_fast8_t bits=64; bits<=128; bits+=16) {
+		std::vector<uint128_t> numbers(8);
+		for (size_t i=0; i<numbers.size(); ++i) {
+			numbers[i] = next_prime(random_bits(rng, bits / 2)) * next_prime(random_bits(rng, bits / 2));
+		}
+		printf("%-8u %10.4f %10.4f %10.4f\n", (unsigned int)bits, bench_ecm(ecm, numbers), bench_siqs(NULL, numbers), bench_siqs(&pool, numbers));
+	}
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <random>
+#include "siqs.h"
+#include "canonic_factors.h"
+
+typedef SiqsFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> siqs128_fzr_type;
+typedef SiqsFactorizer<uint_fast64_t, ((uint_fast64_t)1)<<63, uint128_t> siqs_fzr_type;
+
+struct MyPow128 {
+	uint128_t prime;
+	uint_fast8_t exp;
+};
+
+struct MyFactors128 {
+	uint_fast8_t pow_count;
+	MyPow128 pows[16];
+
+	MyFactors128() : pow_count(0) {}
+
+	bool operator()(uint128_t prime, uint_fast8_t exp) {
+		assert(pow_count < 16);
+		pows[pow_count].prime = prime;
+		pows[pow_count].exp = exp;
+		++pow_count;
+		return false;
+	}
+};
+
+// the first prime >= n
+uint128_t next_prime(uint128_t n) {
+	while (!siqs128_fzr_type::is_prime(n)) ++n;
+	return n;
+}
+
+uint128_t random_bits(std::mt19937_64 &rng, uint_fast8_t bits) {
+	const uint128_t r = ((uint128_t)rng() << 64) | rng();
+	return (r >> (128 - bits)) | ((uint128_t)1 << (bits - 1));
+}
+
+void test_perfect_power_root() {
+	assert(Siqs::perfect_power_root(1000003ULL * 1000003ULL) == 1000003);
+	assert(Siqs::perfect_power_root(1000003ULL * 1000003ULL - 2) == 0);
+	const uint128_t p = next_prime((uint128_t)1 << 40);
+	assert(Siqs::perfect_power_root(p * p * p) == p);
+	assert(Siqs::perfect_power_root(p * p * p + 2) == 0);
+	// 3^80
+	uint128_t pow = 1;
+	for (uint_fast8_t i=0; i<80; ++i) pow *= 3;
+	const uint128_t root = Siqs::perfect_power_root(pow);
+	assert(root * root == pow);
+	// 7^45 == (7^15)^3
+	uint128_t pow7 = 1, pow7_15 = 1;
+	for (uint_fast8_t i=0; i<45; ++i) pow7 *= 7;
+	for (uint_fast8_t i=0; i<15; ++i) pow7_15 *= 7;
+	assert(Siqs::perfect_power_root(pow7) == pow7_15);
+	assert(Siqs::perfect_power_root(pow - 2) == 0);
+	// 2^127 - 1 is prime
+	assert(Siqs::perfect_power_root(~(uint128_t)0 >> 1) == 0);
+}
+
+void test_factor_base() {
+	std::mt19937_64 rng(1);
+	const uint_fast8_t bits[] = {64, 96, 128};
+	for (size_t b=0; b<sizeof(bits)/sizeof(bits[0]); ++b) {
+		const uint128_t n = next_prime(random_bits(rng, bits[b] / 2)) * next_prime(random_bits(rng, bits[b] / 2));
+		Siqs siqs;
+		const uint128_t d = siqs.find_divisor(n);
+		assert(d > 1 && d < n && n % d == 0);
+		// kn is a quadratic residue modulo every prime of factor base
+		const uint128_t kn = n * siqs.get_multiplier();
+		const std::vector<uint32_t> &fb = siqs.get_factor_base();
+		assert(fb.size() >= Siqs::get_params(bits[b] - 1).fb_size);
+		assert(fb[0] == 0 && fb[1] == 2);
+		for (size_t i=2; i<fb.size(); ++i) {
+			assert(i == 2 || fb[i-1] < fb[i]);
+			const uint64_t a = (uint64_t)(kn % fb[i]);
+			assert(a == 0 || Siqs::square_root_mod_type::legendre_symbol(fb[i], a) == 1);
+		}
+	}
+}
+
+void test_find_divisor() {
+	std::mt19937_64 rng(2);
+	WorkStealingPool pool(3);
+	for (uint_fast8_t bits=48; bits<=128; bits+=8) {
+		const uint128_t p = next_prime(random_bits(rng, bits / 2)), q = next_prime(random_bits(rng, bits - bits / 2));
+		Siqs siqs, parallel_siqs(&pool);
+		const uint128_t d = siqs.find_divisor(p * q);
+		assert(d == p || d == q);
+		// relations and dependencies don't depend on count of threads
+		assert(parallel_siqs.find_divisor(p * q) == d);
+	}
+	// unbalanced factors and three factors
+	const uint128_t p = next_prime(random_bits(rng, 36)), q = next_prime(random_bits(rng, 90));
+	Siqs siqs;
+	const uint128_t d = siqs.find_divisor(p * q);
+	assert(d == p || d == q);
+	const uint128_t r = next_prime(random_bits(rng, 40)), s = next_prime(random_bits(rng, 44)), t = next_prime(random_bits(rng, 42));
+	Siqs siqs3;
+	const uint128_t d3 = siqs3.find_divisor(r * s * t);
+	assert(d3 > 1 && d3 < r * s * t && (r * s * t) % d3 == 0);
+}
+
+void test_factorize() {
+	siqs128_fzr_type::primes_array_type primes;
+	WorkStealingPool pool(2);
+	siqs128_fzr_type siqs_factorizer(primes);
+	// no ECM curves, every cofactor above 64 bits goes to Siqs
+	siqs128_fzr_type siqs_only_factorizer(primes, &pool, 0);
+	std::mt19937_64 rng(3);
+	const uint_fast8_t bits[][3] = {{60, 64, 0}, {30, 40, 50}, {42, 42, 42}, {20, 50, 56}, {64, 63, 0}};
+	for (size_t i=0; i<sizeof(bits)/sizeof(bits[0]); ++i) {
+		uint128_t n = 1;
+		for (uint_fast8_t j=0; j<3 && bits[i][j]!=0; ++j) n *= next_prime(random_bits(rng, bits[i][j]));
+		MyFactors128 factors, siqs_only_factors;
+		siqs_factorizer.factorize(n, factors);
+		siqs_only_factorizer.factorize(n, siqs_only_factors);
+		assert(factors.pow_count == siqs_only_factors.pow_count);
+		uint128_t m = 1;
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(j == 0 || factors.pows[j-1].prime < factors.pows[j].prime);
+			assert(siqs128_fzr_type::is_prime(factors.pows[j].prime));
+			assert(siqs_only_factors.pows[j].prime == factors.pows[j].prime && siqs_only_factors.pows[j].exp == factors.pows[j].exp);
+			for (uint_fast8_t k=0; k<factors.pows[j].exp; ++k) m *= factors.pows[j].prime;
+		}
+		assert(m == n);
+	}
+
+	// prime powers: p^2 * q and p^3
+	const uint128_t p = next_prime((uint128_t)1 << 40), q = next_prime((uint128_t)1 << 45);
+	MyFactors128 factors;
+	siqs_only_factorizer.factorize(p * p * q, factors);
+	assert(factors.pow_count == 2);
+	assert(factors.pows[0].prime == p && factors.pows[0].exp == 2 && factors.pows[1].prime == q && factors.pows[1].exp == 1);
+	factors.pow_count = 0;
+	siqs_only_factorizer.factorize(p * p * p * 5, factors);
+	assert(factors.pow_count == 2);
+	assert(factors.pows[0].prime == 5 && factors.pows[1].prime == p && factors.pows[1].exp == 3);
+
+	// with canonic factors and checkers
+	typedef CanonicFactorsTemplate<uint128_t, 15, siqs128_fzr_type> cft_type;
+	cft_type::CanonicFactorizer cfzr;
+	cft_type::CanonicFactors a(cfzr, p * q * 7);
+	assert(a.value() == p * q * 7);
+	DivisorsCounter<uint128_t, siqs128_fzr_type> divisors_counter(primes);
+	assert(divisors_counter.divisors_count(p * p * q) == 6);
+}
+
+void test_factorize_64() {
+	siqs_fzr_type::primes_array_type primes;
+	// cofactors above 40 bits go to Siqs
+	siqs_fzr_type siqs_factorizer(primes, NULL, 0, siqs_fzr_type::DEFAULT_TRIAL_BOUND, siqs_fzr_type::MIN_RHO_BITS);
+	std::mt19937_64 rng(4);
+	for (uint_fast16_t i=0; i<64; ++i) {
+		const uint_fast64_t n = rng() >> (rng() % 8);
+		uint_fast64_t m = 1, last = 1;
+		siqs_factorizer.factorize(n, [&m, &last] (uint_fast64_t prime, siqs_fzr_type::exp_type exp) -> bool {
+			assert(prime > last && siqs_fzr_type::is_prime(prime));
+			last = prime;
+			for (uint_fast8_t k=0; k<exp; ++k) m *= prime;
+			return false;
+		});
+		assert(m == n);
+	}
+}
+
+int main() {
+	test_perfect_power_root();
+	test_factor_base();
+	test_find_divisor();
+	test_factorize();
+	test_factorize_64();
+	return 0;
+}
@@ -0,0 +1,149 @@
+#ifndef SPF_TABLE_H
+#define SPF_TABLE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+
+// Smallest prime factor table for numbers <= bound, built by linear sieve.
+// Only odd numbers are stored, primes are stored as 0,
+// so SPF_TYPE must hold sqrt(bound) only: uint16_t is enough for bound < 2^32.
+template <typename NUM_TYPE, typename SPF_TYPE = uint16_t>
+class SpfTable {
+public:
+	typedef NUM_TYPE num_type;
+	typedef SPF_TYPE spf_type;
+
+private:
+	// spf[i] - smallest prime factor of 2*i+1 or 0 if 2*i+1 is prime
+	std::vector<spf_type> spf;
+	num_type bound;
+
+	SpfTable() = delete;
+	SpfTable(const SpfTable &b) = delete;
+	SpfTable& operator=(const SpfTable &b) = delete;
+
+public:
+	SpfTable(num_type b_bound) : spf(b_bound / 2 + 1, 0), bound(b_bound) {
+		assert(bound >= 2);
+		assert((uint_fast64_t)bound < ((uint_fast64_t)1 << 48));
+		const num_type bound_sqrt = PrimesSieve<num_type>::isqrt(bound);
+		assert((uint_fast64_t)bound_sqrt <= (uint_fast64_t)(spf_type)~(spf_type)0);
+		// odd primes <= sqrt(bound)
+		std::vector<spf_type> primes;
+		for (num_type n=3; n<=bound && n>=3; n+=2) {
+			const spf_type n_spf = spf[n >> 1];
+			if (n_spf == 0 && n <= bound_sqrt) primes.push_back(n);
+			// every odd composite n*p gets its smallest prime factor p exactly once
+			for (size_t i=0; i<primes.size(); ++i) {
+				const uint_fast64_t p = primes[i];
+				if ((n_spf != 0 && p > n_spf) || (uint_fast64_t)n * p > (uint_fast64_t)bound) break;
+				spf[((uint_fast64_t)n * p) >> 1] = p;
+			}
+		}
+	}
+
+	num_type get_bound() const {
+		return bound;
+	}
+
+	// 1 < n <= bound
+	num_type smallest_prime_factor(num_type n) const {
+		assert(n > 1 && n <= bound);
+		if (!(n & 1)) return 2;
+		const spf_type n_spf = spf[n >> 1];
+		return (n_spf != 0 ? n_spf : n);
+	}
+
+	// n <= bound
+	bool is_prime(num_type n) const {
+		assert(n <= bound);
+		if (n < 3) return n == 2;
+		return (n & 1) && spf[n >> 1] == 0;
+	}
+};
+
+// primes array for trial division of numbers > bound of spf table
+template <typename NUM_TYPE, typename SPF_TYPE = uint16_t>
+struct SpfPrimesArray : public PrimesArray<NUM_TYPE> {
+public:
+	typedef SpfTable<NUM_TYPE, SPF_TYPE> spf_table_type;
+
+	const spf_table_type *spf_table;
+
+	SpfPrimesArray() : PrimesArray<NUM_TYPE>(), spf_table(NULL) {}
+	SpfPrimesArray(const spf_table_type *b_spf_table) : PrimesArray<NUM_TYPE>(), spf_table(b_spf_table) {}
+	SpfPrimesArray(const spf_table_type *b_spf_table, PrimesArray<NUM_TYPE> b_primes_array) :
+		PrimesArray<NUM_TYPE>(b_primes_array), spf_table(b_spf_table) {}
+	// use default copy constructor and assignment operator
+};
+
+// Factorization of n <= bound by walking smallest prime factor table in O(log n),
+// numbers > bound (or all numbers if there is no table) are factorized by Factorizer.
+// May be used as FACTORIZER_TYPE of CanonicFactorsTemplate and checkers.
+template <typename NUM_TYPE, typename SPF_TYPE = uint16_t>
+class SpfFactorizer {
+public:
+	typedef NUM_TYPE num_type;
+	typedef Factorizer<num_type> trial_factorizer_type;
+	typedef SpfPrimesArray<num_type, SPF_TYPE> primes_array_type;
+	typedef typename primes_array_type::spf_table_type spf_table_type;
+	typedef typename trial_factorizer_type::exp_type exp_type;
+	typedef typename trial_factorizer_type::factorize_cb_type factorize_cb_type;
+
+private:
+	trial_factorizer_type trial_factorizer;
+	factorize_cb_type cb;
+	const spf_table_type *spf_table;
+
+public:
+	SpfFactorizer(primes_array_type b_primes_array, factorize_cb_type b_cb) :
+		trial_factorizer(b_primes_array), cb(b_cb), spf_table(b_primes_array.spf_table) {}
+
+	// only factorize method with callback argument may be used
+	SpfFactorizer(primes_array_type b_primes_array) :
+		trial_factorizer(b_primes_array), spf_table(b_primes_array.spf_table) {}
+
+	// use default copy constructor and assignment operator
+
+	primes_array_type get_primes_array() const {
+		return primes_array_type(spf_table, trial_factorizer.get_primes_array());
+	}
+
+	// if cb returns true, factorize interrupts
+	// CB - callable as bool(num_type prime, exp_type exp)
+	template <typename CB>
+	void factorize(num_type n, CB &&cb) const {
+		assert(n > 0);
+		if (spf_table == NULL || n > spf_table->get_bound()) {
+			trial_factorizer.factorize(n, cb);
+			return;
+		}
+		if (n == 1) return;
+
+		if (!(n & 1)) {
+			exp_type exp = __builtin_ctzll(n);
+			n >>= exp;
+			if (cb(2, exp)) return;
+		}
+		while (n != 1) {
+			const num_type p = spf_table->smallest_prime_factor(n);
+			exp_type exp = 0;
+			do {
+				n /= p;
+				++exp;
+			} while (n != 1 && spf_table->smallest_prime_factor(n) == p);
+			if (cb(p, exp)) return;
+		}
+	}
+
+	// std::function adapter
+	void factorize(num_type n) const {
+		factorize(n, cb);
+	}
+};
+
+#endif/*SPF_TABLE_H*/
@@ -0,0 +1,122 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "spf_table.h"
+#include "canonic_factors.h"
+
+uint_fast64_t my_smallest_prime_factor(uint_fast64_t n) {
+	assert(n > 1);
+	for (uint_fast64_t d=2; d<=n/d; ++d) {
+		if (n % d == 0) return d;
+	}
+	return n;
+}
+
+void test_spf_table() {
+	typedef SpfTable<uint_fast32_t> spf_table_type;
+	const uint_fast32_t bounds[] = {2, 3, 4, 9, 10, 25, 26, 1024*64, 1024*64+1};
+	for (size_t i=0; i<sizeof(bounds)/sizeof(bounds[0]); ++i) {
+		spf_table_type spf_table(bounds[i]);
+		assert(spf_table.get_bound() == bounds[i]);
+		for (uint_fast32_t n=2; n<=bounds[i]; ++n) {
+			assert(spf_table.smallest_prime_factor(n) == my_smallest_prime_factor(n));
+			assert(spf_table.is_prime(n) == (my_smallest_prime_factor(n) == n));
+		}
+	}
+}
+
+void test_spf_table_pi() {
+	// pi(10^7) = 664579
+	SpfTable<uint_fast32_t> spf_table(10000000);
+	size_t count = 0;
+	for (uint_fast32_t n=0; n<=10000000; ++n) {
+		if (spf_table.is_prime(n)) ++count;
+	}
+	assert(count == 664579);
+}
+
+struct MyFactors {
+	uint_fast8_t pow_count;
+	uint_fast64_t primes[16];
+	uint_fast8_t exps[16];
+};
+
+void test_factorize() {
+	typedef SpfFactorizer<uint_fast64_t> spf_fzr_type;
+	typedef Factorizer<uint_fast64_t> fzr_type;
+	spf_fzr_type::spf_table_type spf_table(1024*1024);
+	uint_fast64_t primes[1024];
+	size_t primes_count = fzr_type::fill_primes(primes, 1024, UINT64_MAX);
+
+	MyFactors factors, my_factors;
+	spf_fzr_type spf_factorizer(
+		spf_fzr_type::primes_array_type(&spf_table, fzr_type::primes_array_type(primes, primes_count)),
+		[&factors] (spf_fzr_type::num_type prime, spf_fzr_type::exp_type exp) -> bool {
+			factors.primes[factors.pow_count] = prime;
+			factors.exps[factors.pow_count] = exp;
+			++factors.pow_count;
+			return false;
+		}
+	);
+	fzr_type factorizer(
+		fzr_type::primes_array_type(primes, primes_count),
+		[&my_factors] (fzr_type::num_type prime, fzr_type::exp_type exp) -> bool {
+			my_factors.primes[my_factors.pow_count] = prime;
+			my_factors.exps[my_factors.pow_count] = exp;
+			++my_factors.pow_count;
+			return false;
+		}
+	);
+
+	// below and above table bound
+	for (uint_fast64_t i=1; i<=1024*1024+1024*4; ++i) {
+		factors.pow_count = my_factors.pow_count = 0;
+		spf_factorizer.factorize(i);
+		factorizer.factorize(i);
+		assert(factors.pow_count == my_factors.pow_count);
+		for (uint_fast8_t j=0; j<factors.pow_count; ++j) {
+			assert(factors.primes[j] == my_factors.primes[j]);
+			assert(factors.exps[j] == my_factors.exps[j]);
+		}
+	}
+}
+
+void test_with_canonic_factors() {
+	typedef uint_fast64_t num_type;
+	typedef SpfFactorizer<num_type> spf_fzr_type;
+	typedef CanonicFactorsTemplate<num_type, 15, spf_fzr_type> cft_type;
+	spf_fzr_type::spf_table_type spf_table(1024*64);
+	spf_fzr_type::primes_array_type primes_array(&spf_table);
+	cft_type::CanonicFactorizer cfzr(primes_array);
+	cft_type::CanonicFactors a(cfzr);
+	for (num_type i=1; i<=1024*64+1024; ++i) {
+		a.assign(i);
+		assert(a.value() == i);
+	}
+
+	// without table
+	cft_type::CanonicFactorizer cfzr_no_table;
+	cft_type::CanonicFactors b(cfzr_no_table);
+	for (num_type i=1; i<=1024; ++i) {
+		b.assign(i);
+		assert(b.value() == i);
+	}
+
+	DivisorsCounter<num_type, spf_fzr_type> divisors_counter(primes_array);
+	assert(divisors_counter.divisors_count(1) == 1);
+	assert(divisors_counter.divisors_count(65536) == 17);
+	assert(divisors_counter.divisors_count(2*2*3*5*7*11*13) == 2*2*2*2*2*3);
+}
+
+void tests_suite() {
+	test_spf_table();
+	test_spf_table_pi();
+	test_factorize();
+	test_with_canonic_factors();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -2,45 +2,51 @@
 #define SQUARE_ROOT_MOD_H
 
 #include <assert.h>
-#include <algorithm>
+#include <stddef.h>		// size_t
+#include <stdint.h>
 #include "mul_mod.h"
 
-template <typename NUM_TYPE, uint_fast8_t NUM_TYPE_LEN, typename OPERATION_TYPE>
+// MOD_CONTEXT_TYPE - MulModContext or other class with the same interface (MontgomeryContext for odd moduli, BarrettContext for any ones),
+//     static methods multiply by MulMod
+template <
+	typename NUM_TYPE, uint_fast8_t NUM_TYPE_LEN, typename OPERATION_TYPE,
+	typename MOD_CONTEXT_TYPE = MulModContext<NUM_TYPE, ((NUM_TYPE)1)<<(NUM_TYPE_LEN-1), OPERATION_TYPE>
+>
 class SquareRootMod {
 public:
 	typedef NUM_TYPE num_type;
 	static_assert(NUM_TYPE_LEN > 0, "NUM_TYPE_LEN can't be zero");
 	static_assert(sizeof(num_type) <= 32, "NUM_TYPE is too big for NUM_TYPE_LEN");
 	typedef MulMod<num_type, ((num_type)1)<<(NUM_TYPE_LEN-1), OPERATION_TYPE> mul_mod_type;
+	typedef MOD_CONTEXT_TYPE mod_context_type;
 private:
 	static_assert(sizeof(num_type) <= 32, "NUM_TYPE is too big for exp_type");
 	typedef uint_fast8_t exp_type;
 	
 	// z == nr - quadratic nonresidue
 	// zq = z^q mod p
-	// zq_pows[i] = (zq)^(2^i) mod p
+	// zq_pows[i] = (zq)^(2^i) mod p in form of context
 	num_type zq_pows[NUM_TYPE_LEN];
 	// p-1 == q * 2^s
 	// p_1d2 = (p-1)/2, q1d2 = (q+1)/2
 	num_type p, p_1d2, q, q1d2;
 	exp_type s;
+	mod_context_type context;
 	
 	SquareRootMod() = delete;
 	SquareRootMod(const SquareRootMod &b) = delete;
 	SquareRootMod& operator=(const SquareRootMod &b) = delete;
 	
 public:
-	// only for prime modulo = 4k+3
-	SquareRootMod(num_type modulo) : p(modulo) {
-		assert(p % 4 == 3);
-		p_1d2 = q = (p-1) >> 1;
-		q1d2 = (q+1) >> 1;
-		s = 1;
-	}
+	// modulo - odd prime, least nonresidue (if needed) is found by legendre_symbol of 2, 3, ...
+	// constexpr, so state of modulus known at compile time is built at compile time too:
+	//     static constexpr SquareRootMod<uint32_t, 32, uint64_t, FixedMulModContext<...>> srm(P);
+	constexpr explicit SquareRootMod(num_type modulo) :
+		SquareRootMod(modulo, ((modulo & 3) == 3 ? 0 : least_nonresidue(modulo))) {}
 	
 	// modulo - odd prime
 	// nr - quadratic nonresidue modulo p (if needed)
-	SquareRootMod(num_type modulo, num_type nr) : p(modulo) {
+	constexpr SquareRootMod(num_type modulo, num_type nr) : zq_pows(), p(modulo), p_1d2(0), q(0), q1d2(0), s(0), context(modulo) {
 		assert(p > 2);
 		assert((p & 1) == 1);
 		p_1d2 = (p-1) >> 1;
@@ -55,8 +61,9 @@ public:
 				q >>= 1;
 				++s;
 			} while (!(q & 1));
-			std::fill(zq_pows, zq_pows+NUM_TYPE_LEN, 0);
-			zq_pows[0] = mul_mod_type::pow_mod(p, nr, q);
+			// zq_pows[i] == zq^(2^i), i < s
+			zq_pows[0] = context.pow(context.to_form(nr), q);
+			for (exp_type i=1; i<s; ++i) zq_pows[i] = context.square(zq_pows[i-1]);
 		}
 		q1d2 = (q+1) >> 1;
 	}
@@ -66,7 +73,7 @@ public:
 	
 	// legendre symbol (a / p)
 	// p - odd prime
-	static int legendre_symbol(num_type p, num_type a) {
+	static constexpr int legendre_symbol(num_type p, num_type a) {
 		assert(p > 2);
 		num_type pow = mul_mod_type::pow_mod(p, a, (p-1)>>1);
 		if (pow == 1) {
@@ -78,11 +85,11 @@ public:
 		}
 	}
 	
-	int legendre_symbol(num_type a) const {
-		num_type pow = mul_mod_type::pow_mod(p, a, p_1d2);
+	constexpr int legendre_symbol(num_type a) const {
+		num_type pow = context.from_form(context.pow(context.to_form(a), p_1d2));
 		if (pow == 1) {
 			return 1;
-		} else if (pow+1 == p) {
+		} else if (pow == p - 1) {
 			return -1;
 		} else {
 			return 0;
@@ -102,6 +109,14 @@ public:
 		return 0;
 	}
 	
+	// p - odd prime, least nonresidue without primes array
+	static constexpr num_type least_nonresidue(num_type p) {
+		assert(p > 2);
+		num_type nr = 2;
+		while (legendre_symbol(p, nr) != -1) ++nr;
+		return nr;
+	}
+	
 	static num_type square_root_mod_algo_01(num_type p, num_type nr, num_type a) {
 		assert(p > 2);
 		assert(a > 0);
@@ -129,49 +144,63 @@ public:
 	}
 	
 	// a - quadratic residue modulo p
-	num_type tonelli_shanks_algo(num_type a) {
+	constexpr num_type tonelli_shanks_algo(num_type a) const {
 		assert(legendre_symbol(p, a) == 1);
-		num_type r = mul_mod_type::pow_mod(p, a, q1d2);
-		if (s == 1) return r;
-		num_type t = mul_mod_type::pow_mod(p, a, q);
-		num_type c = zq_pows[0];
+		const num_type x = context.to_form(a);
+		num_type r = context.pow(x, q1d2);
+		if (s == 1) return context.from_form(r);
+		num_type t = context.pow(x, q);
 		exp_type m = s;
-		while (t != 1) {
+		while (t != context.one()) {
 			exp_type i = 0;
 			num_type tpow = t;
 			do {
-				tpow = mul_mod_type::square_mod(p, tpow);
+				tpow = context.square(tpow);
 				++i;
-			} while (tpow != 1);
+			} while (tpow != context.one());
 			assert(i < m);
 			
-			num_type b = (
-				zq_pows[s-i-1] == 0 ?
-				zq_pows[s-i-1] = mul_mod_type::pow_mod(p, c, ((num_type)1)<<(m-i-1)) :
-				zq_pows[s-i-1]
-			);
-			num_type bsq = (
-				zq_pows[s-i] == 0 ?
-				zq_pows[s-i] = mul_mod_type::square_mod(p, b) :
-				zq_pows[s-i]
-			);
-			
-			r = mul_mod_type::mul_mod(p, r, b);
-			t = mul_mod_type::mul_mod(p, t, bsq);
-			c = bsq;
+			// b == zq^(2^(s-i-1)), bsq == b^2
+			const num_type b = zq_pows[s-i-1];
+			const num_type bsq = zq_pows[s-i];
+			r = context.mul(r, b);
+			t = context.mul(t, bsq);
 			m = i;
 		}
-		return r;
+		return context.from_form(r);
 	}
 	
 	// solve x^2 = a (mod p)
 	// if a is not quadratic residue returns 0
 	// else returns any (of two) square root
-	num_type square_root_mod(num_type a) {
+	constexpr num_type square_root_mod(num_type a) const {
 		if (legendre_symbol(a) != 1) return 0;
 		return tonelli_shanks_algo(a);
 	}
 };
 
+// Bitmask of quadratic residues modulo MODULO, built at compile time:
+//     static constexpr QuadraticResiduesMask<64> squares_mod_64;
+// n is not a square if n mod MODULO is not a residue, masks for 64, 63, 65, 11 together reject 99% of non-squares.
+template <uint32_t MODULO>
+struct QuadraticResiduesMask {
+	static_assert(MODULO > 0, "MODULO can't be zero");
+	static constexpr size_t WORDS_COUNT = (MODULO + 63) / 64;
+
+	uint64_t bits[WORDS_COUNT];
+
+	constexpr QuadraticResiduesMask() : bits() {
+		for (uint64_t a=0; a<MODULO; ++a) {
+			const uint64_t r = a * a % MODULO;
+			bits[r / 64] |= (uint64_t)1 << (r % 64);
+		}
+	}
+
+	constexpr bool is_residue(uint64_t n) const {
+		const uint64_t r = n % MODULO;
+		return (bits[r / 64] >> (r % 64)) & 1;
+	}
+};
+
 #endif/*SQUARE_ROOT_MOD_H*/
 
@@ -2,10 +2,25 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <math.h>
 #include <sys/time.h>
+#include <random>
 #include "square_root_mod.h"
 #include "factorize.h"
 #include "mul_mod.h"
+#include "montgomery.h"
+#include "barrett.h"
+#include "uint128.h"
+
+typedef SquareRootMod<uint_fast32_t, 32, uint_fast64_t> srm32_type;
+typedef SquareRootMod<
+	uint_fast32_t, 32, uint_fast64_t,
+	MontgomeryContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> srm32_montgomery_type;
+typedef SquareRootMod<
+	uint_fast32_t, 32, uint_fast64_t,
+	BarrettContext<uint_fast32_t, ((uint_fast32_t)1)<<31, uint_fast64_t>
+> srm32_barrett_type;
 
 uint_fast32_t my_min_nonresidue(uint_fast32_t primes[], size_t primes_count, uint_fast32_t p) {
 	assert(p > 2);
@@ -64,9 +79,10 @@ void test_square_root_mod_algo_01() {
 	}
 }
 
+template <typename SRM_TYPE>
 void test_tonelli_shanks_algo() {
 	typedef uint_fast32_t num_type;
-	typedef SquareRootMod<num_type, 32, uint_fast64_t> srm_type;
+	typedef SRM_TYPE srm_type;
 	typedef PrimesArray<num_type> primes_array_type;
 	num_type primes[1024];
 	size_t primes_count = primes_array_type::fill_primes(primes, 1024, UINT32_MAX);
@@ -87,6 +103,7 @@ void test_tonelli_shanks_algo() {
 	}
 }
 
+template <typename SRM_TYPE>
 void test_tonelli_shanks_algo_02_rand() {
 	struct timeval tv;
 	gettimeofday(&tv, NULL);
@@ -95,7 +112,7 @@ void test_tonelli_shanks_algo_02_rand() {
 	srand(seed);
 
 	typedef uint_fast32_t num_type;
-	typedef SquareRootMod<num_type, 32, uint_fast64_t> srm_type;
+	typedef SRM_TYPE srm_type;
 	typedef PrimesArray<num_type> primes_array_type;
 	num_type primes[1024];
 	size_t primes_count = primes_array_type::fill_primes(primes, 1024, UINT32_MAX);
@@ -116,11 +133,105 @@ void test_tonelli_shanks_algo_02_rand() {
 	}
 }
 
+// 2^89 - 1 and 2^127 - 1 (== 3 mod 4), 2^100 + 0xa500001 (== 1 mod 2^20)
+void test_tonelli_shanks_algo_128() {
+	typedef uint128_t num_type;
+	typedef SquareRootMod<num_type, 128, num_type> srm_type;
+	typedef PrimesArray<num_type> primes_array_type;
+	num_type primes[64];
+	size_t primes_count = primes_array_type::fill_primes(primes, 64, UINT64_MAX);
+	assert(primes_count == 64);
+	
+	const num_type moduli[] = {
+		((num_type)1 << 89) - 1, ((num_type)1 << 127) - 1, ((num_type)1 << 100) + 0xa500001
+	};
+	srand(1);
+	for (size_t i=0; i<sizeof(moduli)/sizeof(moduli[0]); ++i) {
+		const num_type p = moduli[i];
+		if ((p & 3) == 1) assert(srm_type::least_nonresidue(primes, primes_count, p) == 3);
+		srm_type square_root_mod(p, primes, primes_count);
+		for (uint_fast16_t j=0; j<1024; ++j) {
+			num_type x = 0;
+			for (uint_fast8_t k=0; k<8; ++k) x = (x << 16) ^ (rand() & 0xffff);
+			x %= p;
+			if (x == 0) continue;
+			const num_type a = srm_type::mul_mod_type::square_mod(p, x);
+			assert(square_root_mod.legendre_symbol(a) == 1);
+			const num_type r = square_root_mod.square_root_mod(a);
+			assert(r == x || r == p - x);
+			// -1 is a residue iff p == 1 (mod 4)
+			assert(square_root_mod.legendre_symbol(p - a) == ((p & 3) == 1 ? 1 : -1));
+		}
+	}
+}
+
+void test_constexpr() {
+	typedef MulMod<uint_fast32_t, ((uint_fast32_t)1 << 31), uint_fast64_t> mul_mod_type;
+	typedef SquareRootMod<uint_fast32_t, 32, uint_fast64_t> srm_type;
+	// evaluated at compile time
+	static_assert(mul_mod_type::pow_mod(1000000007, 2, 1000000006) == 1, "Fermat's little theorem");
+	static_assert(mul_mod_type::pow_mod(97, 0, 0) == 1, "0^0 == 1");
+	static_assert(mul_mod_type::mul_mod(4294967291U, 4294967290U, 4294967290U) == 1, "(-1)^2 == 1");
+	static_assert(srm_type::legendre_symbol(7, 2) == 1 && srm_type::legendre_symbol(7, 3) == -1, "squares mod 7: 1, 2, 4");
+	static_assert(srm_type::legendre_symbol(1000000007, 5) == -1 && srm_type::legendre_symbol(1000000007, 1000000007) == 0, "quadratic reciprocity");
+	static constexpr QuadraticResiduesMask<64> squares_mod_64;
+	static constexpr QuadraticResiduesMask<11> squares_mod_11;
+	static_assert(squares_mod_64.bits[0] == 0x0202021202030213ULL, "squares mod 64: 0, 1, 4, 9, 16, 17, 25, 33, 36, 41, 49, 57");
+	static_assert(squares_mod_11.is_residue(3) && !squares_mod_11.is_residue(2), "squares mod 11: 0, 1, 3, 4, 5, 9");
+
+	// the same as runtime legendre_symbol, masks agree with it
+	static constexpr QuadraticResiduesMask<65521> squares_mod_65521;
+	for (uint_fast32_t a=0; a<65521; ++a) {
+		const int symbol = srm_type::legendre_symbol(65521, a);
+		assert(squares_mod_65521.is_residue(a) == (symbol != -1));
+	}
+	static constexpr QuadraticResiduesMask<63> squares_mod_63;
+	for (uint_fast64_t n=0; n<1024*16; ++n) {
+		const bool is_square = squares_mod_64.is_residue(n) && squares_mod_63.is_residue(n) && squares_mod_11.is_residue(n);
+		const uint_fast64_t r = (uint_fast64_t)sqrt((double)n);
+		if (r * r == n) assert(is_square);
+	}
+}
+
+// state of modulus known at compile time is built at compile time
+void test_fixed_modulus() {
+	typedef uint_fast32_t num_type;
+	// 998244353 == 119 * 2^23 + 1, 3 is the least nonresidue
+	static constexpr num_type P = 998244353;
+	typedef SquareRootMod<num_type, 32, uint_fast64_t, FixedMulModContext<num_type, P, ((num_type)1)<<31, uint_fast64_t>> srm_fixed_type;
+	static constexpr srm_fixed_type fixed(P);
+	static_assert(srm_fixed_type::least_nonresidue(P) == 3, "3 is the least nonresidue modulo 998244353");
+	static_assert(fixed.square_root_mod(4) == 2 || fixed.square_root_mod(4) == P - 2, "2^2 == 4");
+	static_assert(fixed.square_root_mod(3) == 0, "3 is nonresidue");
+	constexpr num_type r = fixed.tonelli_shanks_algo(123456789);
+	static_assert(FixedMulMod<num_type, P, ((num_type)1)<<31, uint_fast64_t>::square_mod(r) == 123456789, "r^2 == a");
+
+	// the same roots as of runtime state by runtime modulus
+	num_type primes[1024];
+	const size_t primes_count = PrimesArray<num_type>::fill_primes(primes, 1024, UINT32_MAX);
+	const srm32_type plain(P, primes, primes_count);
+	const srm32_type plain_nr(P);
+	std::mt19937_64 rng(1);
+	for (uint_fast32_t i=0; i<1024*16; ++i) {
+		const num_type a = (num_type)rng() % P;
+		assert(fixed.legendre_symbol(a) == plain.legendre_symbol(a));
+		assert(fixed.square_root_mod(a) == plain.square_root_mod(a));
+		assert(plain_nr.square_root_mod(a) == plain.square_root_mod(a));
+	}
+}
+
 void tests_suite() {
 	//test_least_nonresidue();
 	//test_square_root_mod_algo_01();
-	test_tonelli_shanks_algo();
-	test_tonelli_shanks_algo_02_rand();
+	test_tonelli_shanks_algo<srm32_type>();
+	test_tonelli_shanks_algo<srm32_montgomery_type>();
+	test_tonelli_shanks_algo<srm32_barrett_type>();
+	test_tonelli_shanks_algo_02_rand<srm32_type>();
+	test_tonelli_shanks_algo_02_rand<srm32_montgomery_type>();
+	test_tonelli_shanks_algo_02_rand<srm32_barrett_type>();
+	test_tonelli_shanks_algo_128();
+	test_constexpr();
+	test_fixed_modulus();
 }
 
 int main() {
@@ -0,0 +1,155 @@
+#ifndef SUM_OF_TWO_SQUARES_SIEVE_H
+#define SUM_OF_TWO_SQUARES_SIEVE_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t, NULL
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "factorize.h"
+#include "primes_sieve.h"
+#include "thread_pool.h"
+
+// Classification of every number of [a, b] by theorem about sum of two squares (see SumOfTwoSquaresChecker).
+// Let n = 2^s * m, m - odd, m = r * q, r - product of powers of primes <= sqrt(n), q - 1 or prime.
+// If every prime p == 3 (mod 4) has even exponent in r, then r == 1 (mod 4) and q == m (mod 4), so
+//     n is sum of two squares <=> m == 1 (mod 4) and every prime p == 3 (mod 4), p <= sqrt(n) has even exponent.
+// Segmented sieve starts from m == 1 (mod 4) and crosses out multiples of primes p == 3 (mod 4) <= sqrt(b)
+// with odd exponent (found by exact division by inverse of p), primes p == 1 (mod 4) are not needed.
+// Result of segment is bitset: bit i of bits[i/64] is set if low + i is sum of two squares.
+template <typename NUM_TYPE>
+class SumOfTwoSquaresSieve {
+public:
+	typedef NUM_TYPE num_type;
+	typedef PrimeInverse<num_type> prime_inverse_type;
+	typedef uint64_t word_type;
+	static constexpr size_t WORD_BITS = 64;
+	// numbers per segment, multiple of WORD_BITS
+	static constexpr size_t DEFAULT_SEGMENT_SIZE = 32*1024;
+
+private:
+	// buffers of one thread
+	struct Segment {
+		std::vector<word_type> bits;
+	};
+
+	// primes p == 3 (mod 4), p <= primes_limit
+	std::vector<num_type> primes;
+	std::vector<prime_inverse_type> inverses;
+	num_type primes_limit;
+	size_t segment_size;
+	Segment segment;
+
+	SumOfTwoSquaresSieve(const SumOfTwoSquaresSieve &b) = delete;
+	SumOfTwoSquaresSieve& operator=(const SumOfTwoSquaresSieve &b) = delete;
+
+public:
+	SumOfTwoSquaresSieve(size_t b_segment_size = DEFAULT_SEGMENT_SIZE) : primes_limit(2), segment_size(b_segment_size) {
+		assert(segment_size > 0 && segment_size % WORD_BITS == 0);
+	}
+
+	size_t get_segment_size() const {
+		return segment_size;
+	}
+
+	// calls cb for every segment of [a, b] in ascending order, 0 < a <= b
+	// if cb returns true, iteration interrupts and function returns true
+	// CB - callable as bool(num_type low, num_type high, const word_type bits[]),
+	//     bits of numbers > high are 0, bits are valid during call only
+	template <typename CB>
+	bool for_each_segment(num_type a, num_type b, CB &&cb) {
+		assert(a > 0 && a <= b);
+		extend_primes((num_type)PrimesSieve<num_type>::isqrt(b));
+		for (num_type low=a;;) {
+			const num_type high = (b - low < segment_size ? b : low + (num_type)(segment_size - 1));
+			sieve_segment(low, high, segment);
+			if (cb(low, high, segment.bits.data())) return true;
+			if (high == b) return false;
+			low = high + 1;
+		}
+	}
+
+	// count of sums of two squares in [a, b], 0 < a <= b
+	// pool - NULL for counting in calling thread
+	num_type count(num_type a, num_type b, WorkStealingPool *pool = NULL) {
+		assert(a > 0 && a <= b);
+		if (pool == NULL) {
+			num_type result = 0;
+			for_each_segment(a, b, [&result] (num_type low, num_type high, const word_type bits[]) -> bool {
+				result += count_bits(bits, (size_t)(high - low) + 1);
+				return false;
+			});
+			return result;
+		}
+
+		extend_primes((num_type)PrimesSieve<num_type>::isqrt(b));
+		const size_t segments_count = (size_t)((b - a) / segment_size) + 1;
+		std::vector<Segment> segments(pool->get_threads_count());
+		// one cache line per worker
+		const size_t stride = WorkStealingPool::CACHE_LINE_SIZE / sizeof(num_type);
+		std::vector<num_type> counts(segments.size() * stride, 0);
+		pool->run(segments_count, [this, a, b, &segments, &counts, stride] (size_t worker_idx, size_t idx) {
+			const num_type low = a + (num_type)(idx * segment_size);
+			const num_type high = (b - low < segment_size ? b : low + (num_type)(segment_size - 1));
+			sieve_segment(low, high, segments[worker_idx]);
+			counts[worker_idx * stride] += count_bits(segments[worker_idx].bits.data(), (size_t)(high - low) + 1);
+		});
+		num_type result = 0;
+		for (size_t i=0; i<segments.size(); ++i) result += counts[i * stride];
+		return result;
+	}
+
+	static num_type count_bits(const word_type bits[], size_t count) {
+		num_type result = 0;
+		for (size_t i=0; i<(count + WORD_BITS - 1) / WORD_BITS; ++i) result += __builtin_popcountll(bits[i]);
+		return result;
+	}
+
+private:
+	static void clear_bit(word_type bits[], size_t i) {
+		bits[i / WORD_BITS] &= ~((word_type)1 << (i % WORD_BITS));
+	}
+
+	void sieve_segment(num_type low, num_type high, Segment &seg) const {
+		const size_t count = (size_t)(high - low) + 1;
+		if (seg.bits.size() < segment_size / WORD_BITS) seg.bits.resize(segment_size / WORD_BITS);
+		word_type *bits = seg.bits.data();
+		const size_t words_count = (count + WORD_BITS - 1) / WORD_BITS;
+		for (size_t j=0; j<words_count; ++j) {
+			word_type word = 0;
+			const size_t word_count = std::min(WORD_BITS, count - j * WORD_BITS);
+			for (size_t i=0; i<word_count; ++i) {
+				const num_type n = low + (num_type)(j * WORD_BITS + i);
+				word |= (word_type)(((n >> __builtin_ctzll(n)) & 3) == 1) << i;
+			}
+			bits[j] = word;
+		}
+
+		for (size_t k=0; k<primes.size(); ++k) {
+			const num_type p = primes[k];
+			if (p > high / p) break;
+			const prime_inverse_type &inverse = inverses[k];
+			for (size_t i=(size_t)((p - low % p) % p); i<count; i+=p) {
+				num_type cofactor = prime_inverse_type::mul_low(low + (num_type)i, inverse.inverse);
+				bool is_odd_exp = true;
+				while (inverse.divide(cofactor)) is_odd_exp = !is_odd_exp;
+				if (is_odd_exp) clear_bit(bits, i);
+			}
+		}
+	}
+
+	void extend_primes(num_type limit) {
+		if (limit <= primes_limit) return;
+		PrimesSieve<num_type> sieve;
+		sieve.for_each_prime((typename PrimesSieve<num_type>::pos_type)primes_limit + 1, limit, [this] (num_type p) -> bool {
+			if ((p & 3) == 3) {
+				primes.push_back(p);
+				inverses.push_back(prime_inverse_type(p));
+			}
+			return false;
+		});
+		primes_limit = limit;
+	}
+};
+
+#endif/*SUM_OF_TWO_SQUARES_SIEVE_H*/
@@ -0,0 +1,58 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <vector>
+#include "sum_of_two_squares_sieve.h"
+
+typedef SumOfTwoSquaresSieve<uint_fast64_t> sieve_type;
+typedef sieve_type::num_type num_type;
+typedef Factorizer<num_type> fzr_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+num_type bench_sieve(num_type a, num_type b, WorkStealingPool *pool) {
+	sieve_type sieve;
+	double t0 = get_time();
+	num_type count = sieve.count(a, b, pool);
+	double t = get_time() - t0;
+	printf("sieve, %2u threads       %9.3f ms, %8.2f M numbers/s\n", (unsigned int)(pool != NULL ? pool->get_threads_count() : 1), t * 1e3, (b - a + 1) / t * 1e-6);
+	return count;
+}
+
+num_type bench_checker(num_type a, num_type b) {
+	const num_type limit = PrimesSieve<num_type>::isqrt(b);
+	std::vector<num_type> primes(limit / 2 + 1);
+	size_t primes_count = fzr_type::fill_primes(primes.data(), primes.size(), limit);
+	std::vector<fzr_type::prime_inverse_type> inverses(primes_count);
+	fzr_type::primes_array_type::fill_inverses(primes.data(), primes_count, inverses.data());
+	SumOfTwoSquaresChecker<num_type> checker(fzr_type::primes_array_type(primes.data(), primes_count, inverses.data()));
+	num_type count = 0;
+	double t0 = get_time();
+	for (num_type n=a; n<=b; ++n) count += checker.is_sum_of_two_squares(n);
+	double t = get_time() - t0;
+	printf("checker per number      %9.3f ms, %8.2f M numbers/s\n", t * 1e3, (b - a + 1) / t * 1e-6);
+	return count;
+}
+
+int main() {
+	WorkStealingPool pool;
+	printf("%u hardware threads\n", (unsigned int)pool.get_threads_count());
+	const num_type bases[] = {1000000000ULL, 100000000000ULL};
+	for (size_t i=0; i<sizeof(bases)/sizeof(bases[0]); ++i) {
+		const num_type a = bases[i], b = bases[i] + 1024*1024*16 - 1;
+		printf("[%" PRIuFAST64 ", %" PRIuFAST64 "]\n", a, b);
+		const num_type count = bench_sieve(a, b, NULL);
+		assert(bench_sieve(a, b, &pool) == count);
+		// per number checker is much slower, so its range is shorter
+		const num_type b_short = a + 1024*16 - 1;
+		assert(bench_checker(a, b_short) == sieve_type().count(a, b_short));
+		(void)count;
+	}
+	return 0;
+}
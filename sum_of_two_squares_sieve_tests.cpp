@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "sum_of_two_squares_sieve.h"
+
+typedef SumOfTwoSquaresSieve<uint_fast64_t> sieve_type;
+
+bool my_is_sum_of_two_squares(uint_fast64_t n) {
+	for (uint_fast64_t x=0; x*x<=n; ++x) {
+		uint_fast64_t y2 = n - x*x;
+		uint_fast64_t y = PrimesSieve<uint_fast64_t>::isqrt(y2);
+		if (y*y == y2) return true;
+	}
+	return false;
+}
+
+void check_range(sieve_type &sieve, SumOfTwoSquaresChecker<uint_fast64_t> &checker, uint_fast64_t a, uint_fast64_t b, bool is_brute_force) {
+	uint_fast64_t next = a, my_count = 0;
+	bool interrupted = sieve.for_each_segment(a, b, [&] (uint_fast64_t low, uint_fast64_t high, const sieve_type::word_type bits[]) -> bool {
+		assert(low == next && low <= high && high <= b);
+		assert(high - low < sieve.get_segment_size());
+		for (uint_fast64_t n=low; n<=high; ++n) {
+			const size_t i = n - low;
+			const bool result = (bits[i / sieve_type::WORD_BITS] >> (i % sieve_type::WORD_BITS)) & 1;
+			assert(result == checker.is_sum_of_two_squares(n));
+			if (is_brute_force) assert(result == my_is_sum_of_two_squares(n));
+			if (result) ++my_count;
+		}
+		// bits above high are 0
+		const size_t count = high - low + 1;
+		if (count % sieve_type::WORD_BITS) assert((bits[count / sieve_type::WORD_BITS] >> (count % sieve_type::WORD_BITS)) == 0);
+		next = high + 1;
+		return false;
+	});
+	assert(!interrupted);
+	assert(next == b + 1);
+	assert(sieve.count(a, b) == my_count);
+}
+
+void test_for_each_segment() {
+	uint_fast64_t primes[1024];
+	size_t primes_count = Factorizer<uint_fast64_t>::fill_primes(primes, 1024, UINT64_MAX);
+	SumOfTwoSquaresChecker<uint_fast64_t> checker(SumOfTwoSquaresChecker<uint_fast64_t>::primes_array_type(primes, primes_count));
+	const size_t segment_sizes[] = {64, 128, 1024, sieve_type::DEFAULT_SEGMENT_SIZE};
+	for (size_t i=0; i<sizeof(segment_sizes)/sizeof(segment_sizes[0]); ++i) {
+		sieve_type sieve(segment_sizes[i]);
+		check_range(sieve, checker, 1, 1, true);
+		check_range(sieve, checker, 1, 1024*16, true);
+		check_range(sieve, checker, 1000, 1100, true);
+		check_range(sieve, checker, UINT32_MAX - 1024*4, (uint_fast64_t)UINT32_MAX + 1024*4, false);
+		check_range(sieve, checker, 1000000000000ULL - 64, 1000000000000ULL + 64, false);
+	}
+}
+
+void test_count() {
+	sieve_type sieve(1024);
+	uint_fast64_t my_count = 0;
+	for (uint_fast64_t n=1; n<=100000; ++n) {
+		if (my_is_sum_of_two_squares(n)) ++my_count;
+		if (n % 1000 == 0) assert(sieve.count(1, n) == my_count);
+	}
+
+	const uint_fast64_t count = sieve.count(1, 10000000);
+	const size_t threads_counts[] = {1, 2, 5};
+	for (size_t i=0; i<sizeof(threads_counts)/sizeof(threads_counts[0]); ++i) {
+		WorkStealingPool pool(threads_counts[i]);
+		assert(sieve.count(1, 10000000, &pool) == count);
+		assert(sieve.count(1000000, 1000000 + 1000, &pool) == sieve.count(1000000, 1000000 + 1000));
+		assert(sieve.count(5, 5, &pool) == 1);
+		assert(sieve.count(3, 3, &pool) == 0);
+	}
+}
+
+void test_interrupt() {
+	sieve_type sieve(64);
+	uint_fast64_t segments = 0;
+	assert(sieve.for_each_segment(1, 1000, [&segments] (uint_fast64_t low, uint_fast64_t high, const sieve_type::word_type bits[]) -> bool {
+		(void)low;
+		(void)high;
+		(void)bits;
+		return ++segments == 3;
+	}));
+	assert(segments == 3);
+}
+
+void tests_suite() {
+	test_for_each_segment();
+	test_count();
+	test_interrupt();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -0,0 +1,151 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+// Fixed set of threads running tasks [0, tasks_count) of one job at a time.
+// Tasks are split evenly between workers at start, a worker which ran out of tasks
+// steals upper half of remaining tasks of another worker.
+// Thread calling run is worker 0, so pool of 1 thread runs tasks in calling thread.
+class WorkStealingPool {
+public:
+	typedef std::function<void(size_t worker_idx, size_t task_idx)> job_type;
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+private:
+	// owner takes tasks from begin, thieves take them from end
+	struct TaskRange {
+		std::mutex mutex;
+		size_t begin;
+		size_t end;
+		// no false sharing between workers
+		char padding[CACHE_LINE_SIZE];
+
+		TaskRange() : begin(0), end(0) {}
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<TaskRange> ranges;
+	job_type job;
+	std::mutex mutex;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+	// incremented by every run
+	size_t generation;
+	size_t running_count;
+	bool is_stopping;
+
+	WorkStealingPool(const WorkStealingPool &b) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool &b) = delete;
+
+public:
+	// threads_count == 0 - one thread per hardware thread
+	WorkStealingPool(size_t threads_count = 0) :
+		ranges(threads_count > 0 ? threads_count : default_threads_count()),
+		generation(0), running_count(0), is_stopping(false) {
+		for (size_t i=1; i<ranges.size(); ++i) {
+			threads.push_back(std::thread(&WorkStealingPool::worker_main, this, i));
+		}
+	}
+
+	~WorkStealingPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopping = true;
+		}
+		start_cv.notify_all();
+		for (size_t i=0; i<threads.size(); ++i) threads[i].join();
+	}
+
+	static size_t default_threads_count() {
+		const size_t count = std::thread::hardware_concurrency();
+		return (count > 0 ? count : 1);
+	}
+
+	size_t get_threads_count() const {
+		return ranges.size();
+	}
+
+	// calls fn(worker_idx, task_idx) for every task_idx in [0, tasks_count) once,
+	// returns when all of them are done
+	// FN - callable as void(size_t worker_idx, size_t task_idx), worker_idx < get_threads_count()
+	template <typename FN>
+	void run(size_t tasks_count, FN &&fn) {
+		const size_t workers_count = ranges.size();
+		for (size_t i=0; i<workers_count; ++i) {
+			ranges[i].begin = tasks_count * i / workers_count;
+			ranges[i].end = tasks_count * (i + 1) / workers_count;
+		}
+		job = fn;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running_count = workers_count - 1;
+			++generation;
+		}
+		start_cv.notify_all();
+		work(0);
+		std::unique_lock<std::mutex> lock(mutex);
+		done_cv.wait(lock, [this] { return running_count == 0; });
+		job = nullptr;
+	}
+
+private:
+	void worker_main(size_t worker_idx) {
+		size_t seen_generation = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				start_cv.wait(lock, [this, seen_generation] { return is_stopping || generation != seen_generation; });
+				if (is_stopping) return;
+				seen_generation = generation;
+			}
+			work(worker_idx);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--running_count == 0) done_cv.notify_one();
+		}
+	}
+
+	void work(size_t worker_idx) {
+		size_t task_idx;
+		while (pop(worker_idx, task_idx) || steal(worker_idx, task_idx)) job(worker_idx, task_idx);
+	}
+
+	bool pop(size_t worker_idx, size_t &task_idx) {
+		TaskRange &range = ranges[worker_idx];
+		std::lock_guard<std::mutex> lock(range.mutex);
+		if (range.begin == range.end) return false;
+		task_idx = range.begin++;
+		return true;
+	}
+
+	// own range is empty here, other workers don't add tasks to it
+	bool steal(size_t worker_idx, size_t &task_idx) {
+		const size_t workers_count = ranges.size();
+		for (size_t i=1; i<workers_count; ++i) {
+			TaskRange &victim = ranges[(worker_idx + i) % workers_count];
+			size_t begin, end;
+			{
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (victim.begin == victim.end) continue;
+				begin = victim.begin + (victim.end - victim.begin) / 2;
+				end = victim.end;
+				victim.end = begin;
+			}
+			task_idx = begin;
+			TaskRange &range = ranges[worker_idx];
+			std::lock_guard<std::mutex> lock(range.mutex);
+			range.begin = begin + 1;
+			range.end = end;
+			return true;
+		}
+		return false;
+	}
+};
+
+#endif/*THREAD_POOL_H*/
@@ -0,0 +1,60 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "thread_pool.h"
+
+void test_run() {
+	const size_t threads_counts[] = {1, 2, 3, 8};
+	const size_t tasks_counts[] = {0, 1, 2, 7, 1000};
+	for (size_t i=0; i<sizeof(threads_counts)/sizeof(threads_counts[0]); ++i) {
+		WorkStealingPool pool(threads_counts[i]);
+		assert(pool.get_threads_count() == threads_counts[i]);
+		// the same pool runs many jobs
+		for (size_t j=0; j<sizeof(tasks_counts)/sizeof(tasks_counts[0]); ++j) {
+			std::vector< std::atomic<uint_fast32_t> > runs(tasks_counts[j]);
+			for (size_t k=0; k<runs.size(); ++k) runs[k] = 0;
+			pool.run(tasks_counts[j], [&] (size_t worker_idx, size_t task_idx) {
+				assert(worker_idx < threads_counts[i]);
+				assert(task_idx < tasks_counts[j]);
+				++runs[task_idx];
+			});
+			for (size_t k=0; k<runs.size(); ++k) assert(runs[k] == 1);
+		}
+	}
+}
+
+void test_steal() {
+	// tasks of worker 0 are long, others steal them
+	WorkStealingPool pool(4);
+	std::vector< std::atomic<uint_fast32_t> > runs(64);
+	for (size_t k=0; k<runs.size(); ++k) runs[k] = 0;
+	std::atomic<uint_fast64_t> sum(0);
+	pool.run(runs.size(), [&] (size_t worker_idx, size_t task_idx) {
+		(void)worker_idx;
+		uint_fast64_t s = 0;
+		const uint_fast64_t steps = (task_idx < runs.size() / 4 ? 1000000 : 1000);
+		for (uint_fast64_t i=0; i<steps; ++i) s += i ^ task_idx;
+		sum += s & 1;
+		++runs[task_idx];
+	});
+	for (size_t k=0; k<runs.size(); ++k) assert(runs[k] == 1);
+}
+
+void test_default_threads_count() {
+	WorkStealingPool pool;
+	assert(pool.get_threads_count() == WorkStealingPool::default_threads_count());
+	assert(pool.get_threads_count() > 0);
+}
+
+void tests_suite() {
+	test_run();
+	test_steal();
+	test_default_threads_count();
+}
+
+int main() {
+	tests_suite();
+	return 0;
+}
@@ -0,0 +1,132 @@
+#ifndef UINT128_H
+#define UINT128_H
+
+#include <assert.h>
+#include <stddef.h>		// size_t
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+__extension__ typedef unsigned __int128 uint128_t;
+__extension__ typedef __int128 int128_t;
+
+// Operations of generic code which work for every unsigned num_type up to uint128_t
+template <typename NUM_TYPE>
+struct UnsignedOps {
+	typedef NUM_TYPE num_type;
+	static_assert(sizeof(num_type) <= 16, "Too big num_type");
+	static constexpr uint_fast8_t BITS = sizeof(num_type) * 8;
+	// enough for decimal digits of any num_type value
+	static constexpr size_t MAX_DIGITS = 39;
+
+	// bits above 64 of num_type wider than 64 bits, 0 for other types
+	static constexpr uint64_t high64(num_type n) {
+		return (BITS > 64 ? (uint64_t)(n >> (BITS > 64 ? 64 : 0)) : 0);
+	}
+
+	// n > 0
+	static constexpr uint_fast8_t ctz(num_type n) {
+		return (BITS <= 64 || (uint64_t)n != 0 ? __builtin_ctzll((uint64_t)n) : 64 + __builtin_ctzll(high64(n)));
+	}
+
+	// n > 0
+	static constexpr uint_fast8_t clz(num_type n) {
+		return (BITS <= 64 ? __builtin_clzll((uint64_t)n) + BITS - 64 :
+			high64(n) != 0 ? __builtin_clzll(high64(n)) : 64 + __builtin_clzll((uint64_t)n));
+	}
+
+	// floor(sqrt(n)), exact for every n:
+	// sqrt of double is off by at most 1 for n < 2^64, so n >= 2^64 takes one Newton's step
+	static num_type isqrt(num_type n) {
+		if (BITS > 64 && high64(n) == 0) return (num_type)UnsignedOps<uint64_t>::isqrt((uint64_t)n);
+		num_type r = (num_type)sqrt((double)n);
+		if (BITS > 64) r = (r + n / r) >> 1;
+		while (r > 0 && r > n / r) --r;
+		while (r + 1 <= n / (r + 1)) ++r;
+		return r;
+	}
+
+	// decimal digits of n with terminating zero, buf - at least MAX_DIGITS + 1 chars
+	// returns count of digits
+	static size_t to_chars(num_type n, char buf[]) {
+		size_t count = 0;
+		do {
+			buf[count++] = '0' + (char)(n % 10);
+			n /= 10;
+		} while (n != 0);
+		std::reverse(buf, buf + count);
+		buf[count] = 0;
+		return count;
+	}
+};
+
+// a * b mod p for 128-bit numbers without 256-bit type:
+// product of 64-bit halves is 256-bit number of four 64-bit digits,
+// it is reduced by Knuth's division by normalized 2-digit divisor (top bit is set).
+// Every step divides 3 digits by 2 digits, quotient digit estimated by 128/64 division is exact
+// after correction by low digit of divisor. Moduli < 2^64 take one 128-bit division instead.
+struct Uint128MulMod {
+	typedef uint128_t num_type;
+
+	static constexpr uint64_t high(num_type n) {
+		return (uint64_t)(n >> 64);
+	}
+
+	static constexpr uint64_t low(num_type n) {
+		return (uint64_t)n;
+	}
+
+	// a * b == hi * 2^128 + lo
+	static constexpr void mul_wide(num_type a, num_type b, num_type &hi, num_type &lo) {
+		const num_type ll = (num_type)low(a) * low(b);
+		const num_type lh = (num_type)low(a) * high(b);
+		const num_type hl = (num_type)high(a) * low(b);
+		const num_type hh = (num_type)high(a) * high(b);
+		// sum of middle digit fits 128 bits: 3 * (2^64 - 1) < 2^66
+		const num_type mid = (num_type)high(ll) + low(lh) + low(hl);
+		lo = (mid << 64) | low(ll);
+		hi = hh + high(lh) + high(hl) + high(mid);
+	}
+
+	// (u2 * 2^128 + u1 * 2^64 + u0) mod d, d >= 2^127, u2 * 2^64 + u1 < d
+	static constexpr num_type rem_3by2(uint64_t u2, uint64_t u1, uint64_t u0, num_type d) {
+		const uint64_t d1 = high(d), d0 = low(d);
+		const num_type u21 = ((num_type)u2 << 64) | u1;
+		// u2 <= d1, quotient digit < 2^64
+		num_type q = (u2 < d1 ? u21 / d1 : (num_type)UINT64_MAX);
+		num_type r = u21 - q * d1;
+		while (high(r) == 0 && q * d0 > ((r << 64) | u0)) {
+			--q;
+			r += d1;
+		}
+		// remainder < d, so it is exact modulo 2^128
+		return (r << 64) + u0 - q * d0;
+	}
+
+	// (hi * 2^128 + lo) mod p, p > 0
+	static constexpr num_type mod_wide(num_type hi, num_type lo, num_type p) {
+		assert(p > 0);
+		if (hi >= p) hi %= p;
+		const uint_fast8_t s = UnsignedOps<num_type>::clz(p);
+		const num_type d = p << s;
+		// shifted number < d * 2^128
+		const num_type h = (s == 0 ? hi : (hi << s) | (lo >> (128 - s)));
+		const num_type l = lo << s;
+		num_type r = rem_3by2(high(h), low(h), high(l), d);
+		r = rem_3by2(high(r), low(r), low(l), d);
+		return r >> s;
+	}
+
+	static constexpr num_type mul_mod(num_type p, num_type a, num_type b) {
+		if (high(p) == 0) {
+			if (a >= p) a %= p;
+			if (b >= p) b %= p;
+			return (a * b) % p;
+		}
+		num_type hi = 0, lo = 0;
+		mul_wide(a, b, hi, lo);
+		return mod_wide(hi, lo, p);
+	}
+};
+
+#endif/*UINT128_H*/
@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <random>
+#include <vector>
+#include "uint128.h"
+#include "mul_mod.h"
+#include "miller_rabin.h"
+#include "pollard_rho.h"
+#include "factorize.h"
+#include "square_root_mod.h"
+
+typedef MulMod<uint64_t, ((uint64_t)1)<<63, uint128_t> mul_mod64_type;
+typedef MulMod<uint128_t, ((uint128_t)1)<<127, uint128_t> mul_mod128_type;
+typedef MillerRabin<uint64_t, ((uint64_t)1)<<63, uint128_t> mr64_type;
+typedef MillerRabin<uint128_t, ((uint128_t)1)<<127, uint128_t> mr128_type;
+typedef RhoFactorizer<uint64_t, ((uint64_t)1)<<63, uint128_t> rho64_type;
+typedef RhoFactorizer<uint128_t, ((uint128_t)1)<<127, uint128_t> rho128_type;
+
+double get_time() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// prevents optimizing out of results
+volatile uint64_t sink;
+
+void print(const char *name, size_t count, double t64, double t128) {
+	printf("%-40s %10.1f ns  %10.1f ns  %5.2fx\n", name, t64 * 1e9 / count, t128 * 1e9 / count, t128 / t64);
+}
+
+// odd modulus of bits, values < it
+void fill(std::mt19937_64 &rng, uint_fast8_t bits, std::vector<uint128_t> &values, uint128_t &mod) {
+	const uint128_t mask = (bits == 128 ? ~(uint128_t)0 : ((uint128_t)1 << bits) - 1);
+	mod = ((((uint128_t)rng() << 64) | rng()) & mask) | 1 | ((uint128_t)1 << (bits - 1));
+	for (size_t i=0; i<values.size(); ++i) values[i] = ((((uint128_t)rng() << 64) | rng()) & mask) % mod;
+}
+
+// chain of dependent multiplications
+template <typename NUM_TYPE, typename MUL_MOD_TYPE>
+double bench_mul_mod(NUM_TYPE mod, const std::vector<uint128_t> &values, size_t rounds) {
+	double t0 = get_time();
+	NUM_TYPE x = 1;
+	for (size_t r=0; r<rounds; ++r) {
+		for (size_t i=0; i<values.size(); ++i) x = MUL_MOD_TYPE::mul_mod(mod, x, (NUM_TYPE)values[i]);
+	}
+	sink = (uint64_t)x;
+	return get_time() - t0;
+}
+
+template <typename NUM_TYPE, typename MUL_MOD_TYPE>
+double bench_pow_mod(NUM_TYPE mod, const std::vector<uint128_t> &values) {
+	double t0 = get_time();
+	NUM_TYPE x = 0;
+	for (size_t i=0; i<values.size(); ++i) x ^= MUL_MOD_TYPE::pow_mod(mod, (NUM_TYPE)values[i], mod - 1);
+	sink = (uint64_t)x;
+	return get_time() - t0;
+}
+
+template <typename NUM_TYPE>
+double bench_isqrt(const std::vector<uint128_t> &values) {
+	double t0 = get_time();
+	NUM_TYPE x = 0;
+	for (size_t i=0; i<values.size(); ++i) x ^= UnsignedOps<NUM_TYPE>::isqrt((NUM_TYPE)values[i]);
+	sink = (uint64_t)x;
+	return get_time() - t0;
+}
+
+template <typename MR_TYPE>
+double bench_is_prime(const std::vector<uint128_t> &values, size_t &primes_count) {
+	typedef typename MR_TYPE::num_type num_type;
+	primes_count = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<values.size(); ++i) primes_count += MR_TYPE::is_prime((num_type)values[i] | 1);
+	return get_time() - t0;
+}
+
+template <typename FZR_TYPE>
+double bench_factorize(const FZR_TYPE &factorizer, const std::vector<uint128_t> &values) {
+	typedef typename FZR_TYPE::num_type num_type;
+	uint64_t count = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<values.size(); ++i) {
+		factorizer.factorize((num_type)values[i], [&count] (num_type prime, typename FZR_TYPE::exp_type exp) -> bool {
+			count += (uint64_t)prime + exp;
+			return false;
+		});
+	}
+	sink = count;
+	return get_time() - t0;
+}
+
+template <typename NUM_TYPE, uint_fast8_t NUM_TYPE_LEN, typename OPERATION_TYPE>
+double bench_square_root_mod(NUM_TYPE p, const std::vector<uint128_t> &values) {
+	typedef SquareRootMod<NUM_TYPE, NUM_TYPE_LEN, OPERATION_TYPE> srm_type;
+	NUM_TYPE primes[64];
+	const size_t primes_count = PrimesArray<NUM_TYPE>::fill_primes(primes, 64, UINT64_MAX);
+	srm_type square_root_mod(p, primes, primes_count);
+	NUM_TYPE x = 0;
+	double t0 = get_time();
+	for (size_t i=0; i<values.size(); ++i) {
+		x ^= square_root_mod.square_root_mod(srm_type::mul_mod_type::square_mod(p, (NUM_TYPE)values[i] % p));
+	}
+	sink = (uint64_t)x;
+	return get_time() - t0;
+}
+
+int main() {
+	std::mt19937_64 rng(1);
+	printf("%-40s %13s  %13s  %6s\n", "operation", "64-bit", "128-bit", "ratio");
+
+	// the same values < 2^62 by both types: cost of wider type
+	std::vector<uint128_t> values(1024*64);
+	uint128_t mod;
+	fill(rng, 62, values, mod);
+	print("mul_mod, modulus < 2^62", values.size() * 64,
+		bench_mul_mod<uint64_t, mul_mod64_type>((uint64_t)mod, values, 64),
+		bench_mul_mod<uint128_t, mul_mod128_type>(mod, values, 64));
+	print("pow_mod, modulus < 2^62", values.size(),
+		bench_pow_mod<uint64_t, mul_mod64_type>((uint64_t)mod, values),
+		bench_pow_mod<uint128_t, mul_mod128_type>(mod, values));
+	print("isqrt, n < 2^62", values.size(),
+		bench_isqrt<uint64_t>(values),
+		bench_isqrt<uint128_t>(values));
+	size_t count64, count128;
+	const double t_mr64 = bench_is_prime<mr64_type>(values, count64);
+	const double t_mr128 = bench_is_prime<mr128_type>(values, count128);
+	assert(count64 == count128);
+	print("Miller-Rabin, n < 2^62", values.size(), t_mr64, t_mr128);
+
+	// products of two random numbers < 2^24
+	std::vector<uint128_t> products(1024*4);
+	for (size_t i=0; i<products.size(); ++i) products[i] = (uint128_t)((rng() >> 40) | 1) * ((rng() >> 40) | 1);
+	PrimesArray<uint64_t> primes64;
+	PrimesArray<uint128_t> primes128;
+	print("Factorizer, n < 2^48", products.size(),
+		bench_factorize(Factorizer<uint64_t>(primes64), products),
+		bench_factorize(Factorizer<uint128_t>(primes128), products));
+	for (size_t i=0; i<products.size(); ++i) products[i] = (uint128_t)((rng() >> 34) | 1) * ((rng() >> 34) | 1);
+	const double t_rho64 = bench_factorize(rho64_type(primes64), products);
+	print("RhoFactorizer, n < 2^60", products.size(), t_rho64, bench_factorize(rho128_type(primes128), products));
+
+	const uint64_t p61 = ((uint64_t)1 << 61) - 1;
+	print("square_root_mod, 2^61 - 1", values.size(),
+		bench_square_root_mod<uint64_t, 64, uint128_t>(p61, values),
+		bench_square_root_mod<uint128_t, 128, uint128_t>(p61, values));
+
+	// beyond 64 bits: no 64-bit counterpart, ratio to 64-bit rows above
+	printf("\n%-40s %13s  %13s  %6s\n", "operation beyond 64 bits", "64-bit, 2^62", "128-bit", "ratio");
+	const double t_mul64 = bench_mul_mod<uint64_t, mul_mod64_type>((uint64_t)mod, values, 64);
+	const double t_pow64 = bench_pow_mod<uint64_t, mul_mod64_type>((uint64_t)mod, values);
+	const double t_isqrt64 = bench_isqrt<uint64_t>(values);
+	const uint_fast8_t bits[] = {96, 127};
+	for (size_t b=0; b<sizeof(bits)/sizeof(bits[0]); ++b) {
+		std::vector<uint128_t> wide_values(values.size());
+		uint128_t wide_mod;
+		fill(rng, bits[b], wide_values, wide_mod);
+		char name[64];
+		snprintf(name, sizeof(name), "mul_mod, modulus of %u bits", (unsigned int)bits[b]);
+		print(name, values.size() * 64, t_mul64, bench_mul_mod<uint128_t, mul_mod128_type>(wide_mod, wide_values, 64));
+		snprintf(name, sizeof(name), "pow_mod, modulus of %u bits", (unsigned int)bits[b]);
+		print(name, values.size(), t_pow64, bench_pow_mod<uint128_t, mul_mod128_type>(wide_mod, wide_values));
+		snprintf(name, sizeof(name), "isqrt, n of %u bits", (unsigned int)bits[b]);
+		print(name, values.size(), t_isqrt64, bench_isqrt<uint128_t>(wide_values));
+		snprintf(name, sizeof(name), "Miller-Rabin, n of %u bits", (unsigned int)bits[b]);
+		print(name, values.size(), t_mr64, bench_is_prime<mr128_type>(wide_values, count128));
+	}
+	const uint128_t p127 = ~(uint128_t)0 >> 1;
+	print("square_root_mod, 2^127 - 1 (2^61 - 1)", values.size(),
+		bench_square_root_mod<uint64_t, 64, uint128_t>(p61, values),
+		bench_square_root_mod<uint128_t, 128, uint128_t>(p127, values));
+	// three factors < 2^30 instead of two
+	for (size_t i=0; i<products.size(); ++i) products[i] = (uint128_t)((rng() >> 34) | 1) * ((rng() >> 34) | 1) * ((rng() >> 34) | 1);
+	print("RhoFactorizer, n < 2^90 (2^60)", products.size(), t_rho64, bench_factorize(rho128_type(primes128), products));
+	return 0;
+}
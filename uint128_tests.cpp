@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <random>
+#include "uint128.h"
+#include "mul_mod.h"
+
+typedef MulMod<uint128_t, ((uint128_t)1)<<127, uint128_t> mul_mod128_type;
+typedef MulMod<uint64_t, ((uint64_t)1)<<63, uint128_t> mul_mod64_type;
+
+static constexpr uint128_t make_uint128(uint64_t high, uint64_t low) {
+	return ((uint128_t)high << 64) | low;
+}
+
+static constexpr uint128_t MERSENNE_127 = ~(uint128_t)0 >> 1;
+
+// double and add, reference for mul_mod, p < 2^127
+uint128_t slow_mul_mod(uint128_t p, uint128_t a, uint128_t b) {
+	a %= p;
+	b %= p;
+	uint128_t result = 0;
+	for (int i=127; i>=0; --i) {
+		result <<= 1;
+		if (result >= p) result -= p;
+		if ((b >> i) & 1) {
+			result += a;
+			if (result >= p) result -= p;
+		}
+	}
+	return result;
+}
+
+// checks isqrt around squares of [max_sqrt - 1024, max_sqrt], max_sqrt^2 - 1 == max value of num_type
+template <typename NUM_TYPE>
+void check_isqrt_near_max(NUM_TYPE max_sqrt) {
+	typedef NUM_TYPE num_type;
+	typedef UnsignedOps<num_type> ops_type;
+	const num_type max_delta = 1024;
+	for (num_type i=max_sqrt-1024; i<max_sqrt; ++i) {
+		const num_type s = i * i;
+		for (num_type j=1; j<=max_delta; ++j) {
+			assert(ops_type::isqrt(s - j) == i - 1);
+			assert(ops_type::isqrt(s + j - 1) == i);
+		}
+	}
+	const num_type max = (num_type)~(num_type)0;
+	for (num_type j=0; j<=max_delta; ++j) assert(ops_type::isqrt(max - j) == max_sqrt - 1);
+}
+
+void test_isqrt() {
+	for (uint32_t n=0; n<1024*1024; ++n) {
+		const uint32_t r = UnsignedOps<uint32_t>::isqrt(n);
+		assert(r * r <= n && (r + 1) * (r + 1) > n);
+		assert(UnsignedOps<uint64_t>::isqrt(n) == r);
+		assert(UnsignedOps<uint128_t>::isqrt(n) == r);
+	}
+	check_isqrt_near_max<uint32_t>((uint32_t)1 << 16);
+	check_isqrt_near_max<uint64_t>((uint64_t)1 << 32);
+	check_isqrt_near_max<uint128_t>((uint128_t)1 << 64);
+
+	std::mt19937_64 rng(1);
+	for (int i=0; i<100000; ++i) {
+		// random number of random bits count
+		const uint128_t n = make_uint128(rng(), rng()) >> (rng() % 128);
+		const uint128_t r = UnsignedOps<uint128_t>::isqrt(n);
+		assert(r <= n / (r == 0 ? 1 : r) && r + 1 > n / (r + 1));
+	}
+}
+
+void test_bits() {
+	static_assert(UnsignedOps<uint32_t>::clz(1) == 31, "clz");
+	static_assert(UnsignedOps<uint64_t>::clz(1) == 63, "clz");
+	static_assert(UnsignedOps<uint128_t>::clz(1) == 127, "clz");
+	static_assert(UnsignedOps<uint128_t>::clz(MERSENNE_127) == 1, "clz");
+	static_assert(UnsignedOps<uint128_t>::ctz((uint128_t)1 << 100) == 100, "ctz");
+	for (uint_fast8_t i=0; i<128; ++i) {
+		const uint128_t n = (uint128_t)1 << i;
+		assert(UnsignedOps<uint128_t>::ctz(n) == i);
+		assert(UnsignedOps<uint128_t>::clz(n) == 127 - i);
+		assert(UnsignedOps<uint128_t>::ctz(~(uint128_t)0 << i) == i);
+		assert(UnsignedOps<uint128_t>::clz(~(uint128_t)0 >> i) == i);
+	}
+}
+
+void test_to_chars() {
+	char buf[UnsignedOps<uint128_t>::MAX_DIGITS + 1];
+	assert(UnsignedOps<uint128_t>::to_chars(0, buf) == 1 && strcmp(buf, "0") == 0);
+	assert(UnsignedOps<uint8_t>::to_chars(255, buf) == 3 && strcmp(buf, "255") == 0);
+	assert(UnsignedOps<uint64_t>::to_chars(UINT64_MAX, buf) == 20 && strcmp(buf, "18446744073709551615") == 0);
+	assert(UnsignedOps<uint128_t>::to_chars(~(uint128_t)0, buf) == 39);
+	assert(strcmp(buf, "340282366920938463463374607431768211455") == 0);
+}
+
+void test_mul_mod() {
+	// compile time
+	static_assert(mul_mod128_type::mul_mod(MERSENNE_127, MERSENNE_127 - 1, MERSENNE_127 - 1) == 1, "mul_mod");
+	static_assert(mul_mod128_type::pow_mod(MERSENNE_127, 3, MERSENNE_127 - 1) == 1, "pow_mod");
+
+	std::mt19937_64 rng(2);
+	for (int i=0; i<200000; ++i) {
+		uint128_t p = (make_uint128(rng(), rng()) >> (rng() % 128)) & MERSENNE_127;
+		if (p == 0) p = 1;
+		const uint128_t a = make_uint128(rng(), rng()) % p;
+		const uint128_t b = make_uint128(rng(), rng()) % p;
+		assert(mul_mod128_type::mul_mod(p, a, b) == slow_mul_mod(p, a, b));
+		if (p <= UINT64_MAX) {
+			assert(mul_mod128_type::mul_mod(p, a, b) == mul_mod64_type::mul_mod((uint64_t)p, (uint64_t)a, (uint64_t)b));
+		}
+	}
+
+	// moduli of full 128 bits and arguments not reduced
+	for (int i=0; i<100000; ++i) {
+		const uint128_t p = make_uint128(rng() | ((uint64_t)1 << 63), rng());
+		const uint128_t a = make_uint128(rng(), rng()), b = make_uint128(rng(), rng());
+		uint128_t hi, lo;
+		Uint128MulMod::mul_wide(a, b, hi, lo);
+		const uint128_t r = Uint128MulMod::mod_wide(hi, lo, p);
+		assert(r < p);
+		assert(r == Uint128MulMod::mul_mod(p, a, b));
+		// the same by 2^128 == 2^128 - p (mod p), p >= 2^127
+		const uint128_t x = Uint128MulMod::mul_mod(p, hi, -p), y = lo % p;
+		assert(r == (y >= p - x ? y - (p - x) : y + x));
+	}
+
+	// the worst cases of quotient estimation: digits of divisor and dividend are near 2^64
+	const uint128_t p = make_uint128(UINT64_MAX, UINT64_MAX - 1);
+	for (uint64_t j=0; j<1024; ++j) {
+		const uint128_t a = p - 1 - j, b = p - 1 - 7 * j;
+		// (p - x) * (p - y) == x * y (mod p)
+		assert(Uint128MulMod::mul_mod(p, a, b) == Uint128MulMod::mul_mod(p, 1 + j, 1 + 7 * j));
+		assert(Uint128MulMod::mul_mod(p, a, b) == (uint128_t)(1 + j) * (1 + 7 * j) % p);
+	}
+
+	// Fermat's little theorem for Mersenne primes
+	const uint_fast8_t exps[] = {61, 89, 107, 127};
+	for (size_t i=0; i<sizeof(exps)/sizeof(exps[0]); ++i) {
+		const uint128_t m = ((uint128_t)1 << exps[i]) - 1;
+		for (uint128_t a=2; a<100; ++a) assert(mul_mod128_type::pow_mod(m, a, m - 1) == 1);
+		// 2^exp == 1 (mod 2^exp - 1)
+		assert(mul_mod128_type::pow_mod(m, 2, exps[i]) == 1);
+	}
+}
+
+// modulus known at compile time: the same results as of MulMod
+void test_fixed_mul_mod() {
+	typedef FixedMulMod<uint32_t, 4294967291U, ((uint32_t)1)<<31, uint64_t> fixed32_type;
+	typedef FixedMulMod<uint64_t, 0xffffffffffffffc5ULL, ((uint64_t)1)<<63, uint128_t> fixed64_type;
+	typedef FixedMulMod<uint128_t, MERSENNE_127, ((uint128_t)1)<<127, uint128_t> fixed128_type;
+	typedef FixedMulMod<uint64_t, 1000000000000ULL, ((uint64_t)1)<<63, uint128_t> fixed_even_type;
+	typedef MulMod<uint32_t, ((uint32_t)1)<<31, uint64_t> mul_mod32_type;
+	static_assert(fixed32_type::pow_mod(3, 4294967290U) == 1, "Fermat's little theorem");
+	static_assert(fixed64_type::pow_mod(3, 0xffffffffffffffc4ULL) == 1, "Fermat's little theorem");
+	static_assert(fixed128_type::pow_mod(3, MERSENNE_127 - 1) == 1, "Fermat's little theorem");
+	static_assert(fixed_even_type::pow_mod(10, 12) == 0 && fixed_even_type::pow_mod(0, 0) == 1, "10^12 == 0");
+
+	std::mt19937_64 rng(3);
+	for (int i=0; i<100000; ++i) {
+		const uint32_t a32 = (uint32_t)rng() % fixed32_type::MODULUS, b32 = (uint32_t)rng();
+		assert(fixed32_type::mul_mod(a32, b32) == mul_mod32_type::mul_mod(fixed32_type::MODULUS, a32, b32));
+		assert(fixed32_type::pow_mod(a32, b32) == mul_mod32_type::pow_mod(fixed32_type::MODULUS, a32, b32));
+		const uint64_t a = rng(), b = rng();
+		assert(fixed64_type::mul_mod(a, b) == mul_mod64_type::mul_mod(fixed64_type::MODULUS, a, b));
+		assert(fixed_even_type::square_mod(a) == mul_mod64_type::square_mod(fixed_even_type::MODULUS, a));
+		const uint128_t x = make_uint128(rng(), rng()) & MERSENNE_127, y = make_uint128(rng(), rng()) & MERSENNE_127;
+		assert(fixed128_type::mul_mod(x, y) == mul_mod128_type::mul_mod(MERSENNE_127, x, y));
+	}
+	for (uint64_t a=0; a<1024; ++a) assert(fixed64_type::pow_mod(a, a * a) == mul_mod64_type::pow_mod(fixed64_type::MODULUS, a, a * a));
+}
+
+int main() {
+	test_isqrt();
+	test_bits();
+	test_to_chars();
+	test_mul_mod();
+	test_fixed_mul_mod();
+	return 0;
+}